@@ -163,6 +163,7 @@ void Physics_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now) {
 }
 
 static void Physics_TickRandomBlocks(void) {
+	struct WorldChunkCounts* counts;
 	int lo, hi, index;
 	BlockID block;
 	PhysicsHandler tick;
@@ -175,6 +176,10 @@ static void Physics_TickRandomBlocks(void) {
 			for (x = 0; x < World.Width; x += CHUNK_SIZE) {
 				x2 = min(x + CHUNK_MAX, World.MaxX);
 
+				/* Skip chunks which have no blocks that can be randomly ticked */
+				counts = World_GetChunkCounts(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+				if (counts && !counts->tickable) continue;
+
 				/* Inlined 3 random ticks for this chunk */
 				lo = World_Pack( x,  y,  z);
 				hi = World_Pack(x2, y2, z2);
@@ -487,14 +492,19 @@ static cc_bool BlocksTNT(BlockID b) {
 
 #define TNT_POWER 4
 #define TNT_POWER_SQUARED (TNT_POWER * TNT_POWER)
+#define TNT_MAX_BLOCKS ((TNT_POWER * 2 + 1) * (TNT_POWER * 2 + 1) * (TNT_POWER * 2 + 1))
 static void Physics_HandleTnt(int index, BlockID block) {
-	int x, y, z;
+	static IVec3 coords[TNT_MAX_BLOCKS];
+	static BlockID blocks[TNT_MAX_BLOCKS];
+	static BlockID oldBlocks[TNT_MAX_BLOCKS];
+	int x, y, z, i, count = 0;
 	int dx, dy, dz, xx, yy, zz;
 
 	World_Unpack(index, x, y, z);
 	Game_UpdateBlock(x, y, z, BLOCK_AIR);
 	Physics_ActivateNeighbours(x, y, z, index);
 	
+	/* Blow up all of the blocks at once, so the world only has to be updated once */
 	for (dy = -TNT_POWER; dy <= TNT_POWER; dy++) {
 		for (dz = -TNT_POWER; dz <= TNT_POWER; dz++) {
 			for (dx = -TNT_POWER; dx <= TNT_POWER; dx++) {
@@ -507,11 +517,19 @@ static void Physics_HandleTnt(int index, BlockID block) {
 				block = World.Blocks[index];
 				if (BlocksTNT(block)) continue;
 
-				Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
-				Physics_ActivateNeighbours(xx, yy, zz, index);
+				coords[count].x = xx; coords[count].y = yy; coords[count].z = zz;
+				blocks[count]   = BLOCK_AIR;
+				count++;
 			}
 		}
 	}
+	Game_UpdateBlocks(coords, blocks, oldBlocks, count);
+
+	for (i = 0; i < count; i++) 
+	{
+		xx = coords[i].x; yy = coords[i].y; zz = coords[i].z;
+		Physics_ActivateNeighbours(xx, yy, zz, World_Pack(xx, yy, zz));
+	}
 }
 
 void Physics_Init(void) {
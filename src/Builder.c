@@ -20,22 +20,14 @@ int Builder_SidesLevel, Builder_EdgeLevel;
 /* Packs an index into the 18x18x18 chunk array. Coordinates range from -1 to 16. */
 #define Builder_PackChunk(xx, yy, zz) (((yy) + 1) * EXTCHUNK_SIZE_2 + ((zz) + 1) * EXTCHUNK_SIZE + ((xx) + 1))
 
-static BlockID* Builder_Chunk;
-static cc_uint8* Builder_Counts;
-static int* Builder_BitFlags;
-static int Builder_X, Builder_Y, Builder_Z;
-static BlockID Builder_Block;
-static int Builder_ChunkIndex;
-static cc_bool Builder_FullBright;
-static int Builder_ChunkEndX, Builder_ChunkEndZ;
 static int Builder_Offsets[FACE_COUNT] = { -1,1, -EXTCHUNK_SIZE,EXTCHUNK_SIZE, -EXTCHUNK_SIZE_2,EXTCHUNK_SIZE_2 };
 
-static int (*Builder_StretchXLiquid)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
-static int (*Builder_StretchX)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static int (*Builder_StretchZ)(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
-static void (*Builder_RenderBlock)(int countsIndex, int x, int y, int z);
-static void (*Builder_PrePrepareChunk)(void);
-static void (*Builder_PostPrepareChunk)(void);
+/* Max number of cells along each axis of a chunk in a lower detail mesh (i.e. at LOD level 1) */
+#define LOD_MAX_CELLS (CHUNK_SIZE >> 1)
+/* Same as LOD_MAX_CELLS, but also including the cells just outside the chunk */
+#define LOD_EXTCELLS (LOD_MAX_CELLS + 2)
+/* Packs an index into the 10x10x10 cells array. Coordinates range from -1 to 8. */
+#define Lod_PackCell(cx, cy, cz) (((cy) + 1) * LOD_EXTCELLS * LOD_EXTCELLS + ((cz) + 1) * LOD_EXTCELLS + ((cx) + 1))
 
 /* Contains state for vertices for a portion of a chunk mesh (vertices that are in a 1D atlas) */
 struct Builder1DPart {
@@ -47,10 +39,61 @@ struct Builder1DPart {
 	int sCount, sOffset;
 };
 
-/* Part builder data, for both normal and translucent parts.
-The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
-static CC_BIG_VAR struct Builder1DPart Builder_Parts[ATLAS1D_MAX_ATLASES * 2];
-static struct VertexTextured* Builder_Vertices;
+/* Vertices of each part are stored as sprites (in 4 sections), then each face */
+#define MESH_STREAMS   (FACE_COUNT + 1)
+#define STREAM_SPRITES FACE_COUNT
+/* Number of vertices output for each y slice of the chunk, for each face of a part */
+/*  (for sprites, the number of vertices in each of the 4 sprite sections) */
+struct MeshSlices {
+	cc_uint16 counts[MESH_STREAMS][CHUNK_SIZE];
+};
+
+/* Contains all the state used while building the mesh of a chunk */
+/*  (each chunk builder thread has its own context, so multiple chunks can be built at once) */
+struct BuilderContext {
+	BlockID* chunk;
+	cc_uint8* counts;
+	int* bitFlags;
+	/* Coordinates of the block that a face is being stretched from */
+	int baseX, baseY, baseZ;
+	BlockID block;
+	int chunkIndex;
+	cc_bool fullBright;
+	int chunkEndX, chunkEndY, chunkEndZ;
+	struct VertexTextured* vertices;
+	/* If not NULL, the number of vertices output for each y slice is recorded into this */
+	/*  (one entry per part, ordered the same as parts are in the chunk's vertex buffer) */
+	struct MeshSlices* slices;
+	int* slicePos;
+	/* Temp state for flood filling through the blocks of the chunk */
+	cc_uint8 visSeen[CHUNK_SIZE_3];
+	cc_uint16 visStack[CHUNK_SIZE_3];
+	RNGState spriteRng;
+	struct _DrawerData drawer;
+	/* Block that represents each cell of a lower detail mesh (BLOCK_AIR if mostly empty) */
+	BlockID lodCells[LOD_EXTCELLS * LOD_EXTCELLS * LOD_EXTCELLS];
+	/* Bit flags of which faces of each cell of a lower detail mesh are visible */
+	cc_uint8 lodFaces[LOD_EXTCELLS * LOD_EXTCELLS * LOD_EXTCELLS];
+#ifdef CC_BUILD_ADVLIGHTING
+	Vec3 minBB, maxBB;
+	int initBitFlags, baseOffset;
+	float x1, y1, z1, x2, y2, z2;
+	PackedCol lerp[5], lerpX[5], lerpZ[5], lerpY[5];
+	cc_bool tinted;
+#endif
+	/* Part builder data, for both normal and translucent parts.
+	The first ATLAS1D_MAX_ATLASES parts are for normal parts, remainder are for translucent parts. */
+	struct Builder1DPart parts[ATLAS1D_MAX_ATLASES * 2];
+};
+
+static int (*Builder_StretchXLiquid)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block);
+static int (*Builder_StretchX)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static int (*Builder_StretchZ)(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face);
+static void (*Builder_RenderBlock)(struct BuilderContext* ctx, int countsIndex, int x, int y, int z);
+static void (*Builder_PrePrepareChunk)(struct BuilderContext* ctx);
+static void (*Builder_PostPrepareChunk)(struct BuilderContext* ctx);
+static void Lod_StretchChunk(struct BuilderContext* ctx, int x1, int y1, int z1, int level);
+static void Lod_RenderChunk(struct BuilderContext* ctx, int x1, int y1, int z1, int level);
 
 static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	int i, count = part->sCount;
@@ -58,7 +101,7 @@ static int Builder1DPart_VerticesCount(struct Builder1DPart* part) {
 	return count;
 }
 
-static int Builder1DPart_CalcOffsets(struct Builder1DPart* part, int offset) {
+static int Builder1DPart_CalcOffsets(struct BuilderContext* ctx, struct Builder1DPart* part, int offset) {
 	int i, counts[FACE_COUNT];
 	part->sOffset = offset;
 
@@ -71,46 +114,80 @@ static int Builder1DPart_CalcOffsets(struct Builder1DPart* part, int offset) {
 	offset += part->sCount;
 	for (i = 0; i < FACE_COUNT; i++) 
 	{
-		part->faces.vertices[i] = &Builder_Vertices[offset];
+		part->faces.vertices[i] = &ctx->vertices[offset];
 		offset += counts[i];
 	}
 	return offset;
 }
 
-static int Builder_TotalVerticesCount(void) {
+static int Builder_TotalVerticesCount(struct BuilderContext* ctx) {
 	int i, count = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES * 2; i++) {
-		count += Builder1DPart_VerticesCount(&Builder_Parts[i]);
+		count += Builder1DPart_VerticesCount(&ctx->parts[i]);
 	}
 	return count;
 }
 
+/* Parts are stored in the vertex buffer as the normal then translucent part for each 1D atlas */
+#define Builder_SlicesPart(ctx, i) (&(ctx)->parts[((i) >> 1) + ((i) & 1) * ATLAS1D_MAX_ATLASES])
+
+static void GetSlicePositions(struct BuilderContext* ctx, int* pos) {
+	struct Builder1DPart* part;
+	int i, face, count = MapRenderer_1DUsedCount * 2;
+
+	for (i = 0; i < count; i++, pos += MESH_STREAMS) 
+	{
+		part = Builder_SlicesPart(ctx, i);
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			pos[face] = (int)(part->faces.vertices[face] - ctx->vertices);
+		}
+		pos[STREAM_SPRITES] = part->sOffset;
+	}
+}
+
+static void BeginSlice(struct BuilderContext* ctx) {
+	GetSlicePositions(ctx, ctx->slicePos);
+}
+
+static void EndSlice(struct BuilderContext* ctx, int yy) {
+	int i, count = MapRenderer_1DUsedCount * 2 * MESH_STREAMS;
+	int* beg = ctx->slicePos;
+	int* end = ctx->slicePos + count;
+	GetSlicePositions(ctx, end);
+
+	for (i = 0; i < count; i++) 
+	{
+		ctx->slices[i / MESH_STREAMS].counts[i % MESH_STREAMS][yy] = (cc_uint16)(end[i] - beg[i]);
+	}
+}
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Base mesh builder----------------------------------------------------*
 *#########################################################################################################################*/
-static void AddSpriteVertices(BlockID block) {
+static void AddSpriteVertices(struct BuilderContext* ctx, BlockID block) {
 	int i = Atlas1D_Index(Block_Tex(block, FACE_XMAX));
-	struct Builder1DPart* part = &Builder_Parts[i];
+	struct Builder1DPart* part = &ctx->parts[i];
 	part->sCount += 4 * 4;
 }
 
-static void AddVertices(BlockID block, Face face) {
+static void AddVertices(struct BuilderContext* ctx, BlockID block, Face face) {
 	int baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
 	int i = Atlas1D_Index(Block_Tex(block, face));
-	struct Builder1DPart* part = &Builder_Parts[baseOffset + i];
+	struct Builder1DPart* part = &ctx->parts[baseOffset + i];
 	part->faces.count[face] += 4;
 }
 
 #ifdef CC_BUILD_GL11
-static void BuildPartVbs(struct ChunkPartInfo* info) {
+static void BuildPartVbs(struct VertexTextured* vertices, struct ChunkPartInfo* info) {
 	/* Sprites vertices are stored before chunk face sides */
 	int i, count, offset = info->offset + info->spriteCount;
 	for (i = 0; i < FACE_COUNT; i++) {
 		count = info->counts[i];
 
 		if (count) {
-			info->vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+			info->vbs[i] = Gfx_CreateVb2(&vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 			offset += count;
 		} else {
 			info->vbs[i] = 0;
@@ -120,7 +197,7 @@ static void BuildPartVbs(struct ChunkPartInfo* info) {
 	count  = info->spriteCount;
 	offset = info->offset;
 	if (count) {
-		info->vbs[i] = Gfx_CreateVb2(&Builder_Vertices[offset], VERTEX_FORMAT_TEXTURED, count);
+		info->vbs[i] = Gfx_CreateVb2(&vertices[offset], VERTEX_FORMAT_TEXTURED, count);
 	} else {
 		info->vbs[i] = 0;
 	}
@@ -146,98 +223,85 @@ static cc_bool SetPartInfo(struct Builder1DPart* part, int* offset, struct Chunk
 }
 
 
-static void PrepareChunk(int x1, int y1, int z1) {
+/* Calculates face counts for the blocks in the y slices from minYY to maxYY of the chunk */
+static void PrepareChunk(struct BuilderContext* ctx, int x1, int y1, int z1, int minYY, int maxYY) {
 	int xMax = min(World.Width,  x1 + CHUNK_SIZE);
-	int yMax = min(World.Height, y1 + CHUNK_SIZE);
+	int yMax = y1 + maxYY + 1;
 	int zMax = min(World.Length, z1 + CHUNK_SIZE);
 
 	int cIndex, index, tileIdx;
 	BlockID b;
 	int x, y, z, xx, yy, zz;
-
-#ifdef OCCLUSION
-	int flags = ComputeOcclusion();
-#endif
-#ifdef DEBUG_OCCLUSION
-	FastColour col = new FastColour(60, 60, 60, 255);
-	if (flags & 1) col.R = 255; /* x */
-	if (flags & 4) col.G = 255; /* y */
-	if (flags & 2) col.B = 255; /* z */
-	map.Sunlight = map.Shadowlight = col;
-	map.SunlightXSide = map.ShadowlightXSide = col;
-	map.SunlightZSide = map.ShadowlightZSide = col;
-	map.SunlightYBottom = map.ShadowlightYBottom = col;
-#endif
 	
-	for (y = y1, yy = 0; y < yMax; y++, yy++) {
+	for (y = y1 + minYY, yy = minYY; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
 			cIndex = Builder_PackChunk(0, yy, zz);
 
 			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				b = Builder_Chunk[cIndex];
+				b = ctx->chunk[cIndex];
 				if (Blocks.Draw[b] == DRAW_GAS) continue;
 				index = Builder_PackCount(xx, yy, zz);
 
 				/* Sprites can't be stretched, nor can then be they hidden by other blocks. */
 				/* Note sprites are drawn using DrawSprite and not with any of the DrawXFace. */
-				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(b); continue; }
+				if (Blocks.Draw[b] == DRAW_SPRITE) { AddSpriteVertices(ctx, b); continue; }
 
-				Builder_X = x; Builder_Y = y; Builder_Z = z;
-				Builder_FullBright = Blocks.Brightness[b];
+				ctx->baseX = x; ctx->baseY = y; ctx->baseZ = z;
+				ctx->fullBright = Blocks.Brightness[b];
 				tileIdx = b * BLOCK_COUNT;
 				/* All of these function calls are inlined as they can be called tens of millions to hundreds of millions of times. */
 
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(x == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - 1]] & FACE_BIT_XMIN) != 0)) {
-					Builder_Counts[index] = 0;
+					(x != 0 && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex - 1]] & FACE_BIT_XMIN) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMIN);
+					ctx->counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(x == World.MaxX && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(x != World.MaxX && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + 1]] & FACE_BIT_XMAX) != 0)) {
-					Builder_Counts[index] = 0;
+					(x != World.MaxX && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex + 1]] & FACE_BIT_XMAX) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchZ(index, x, y, z, cIndex, b, FACE_XMAX);
+					ctx->counts[index] = Builder_StretchZ(ctx, index, x, y, z, cIndex, b, FACE_XMAX);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(z == 0 && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != 0 && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE]] & FACE_BIT_ZMIN) != 0)) {
-					Builder_Counts[index] = 0;
+					(z != 0 && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex - EXTCHUNK_SIZE]] & FACE_BIT_ZMIN) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMIN);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
+				if (ctx->counts[index] == 0 ||
 					(z == World.MaxZ && (y < Builder_SidesLevel || (b >= BLOCK_WATER && b <= BLOCK_STILL_LAVA && y < Builder_EdgeLevel))) ||
-					(z != World.MaxZ && (Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE]] & FACE_BIT_ZMAX) != 0)) {
-					Builder_Counts[index] = 0;
+					(z != World.MaxZ && (Blocks.Hidden[tileIdx + ctx->chunk[cIndex + EXTCHUNK_SIZE]] & FACE_BIT_ZMAX) != 0)) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_ZMAX);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_ZMAX);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 || y == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex - EXTCHUNK_SIZE_2]] & FACE_BIT_YMIN) != 0) {
-					Builder_Counts[index] = 0;
+				if (ctx->counts[index] == 0 || y == 0 ||
+					(Blocks.Hidden[tileIdx + ctx->chunk[cIndex - EXTCHUNK_SIZE_2]] & FACE_BIT_YMIN) != 0) {
+					ctx->counts[index] = 0;
 				} else {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMIN);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMIN);
 				}
 
 				index++;
-				if (Builder_Counts[index] == 0 ||
-					(Blocks.Hidden[tileIdx + Builder_Chunk[cIndex + EXTCHUNK_SIZE_2]] & FACE_BIT_YMAX) != 0) {
-					Builder_Counts[index] = 0;
+				if (ctx->counts[index] == 0 ||
+					(Blocks.Hidden[tileIdx + ctx->chunk[cIndex + EXTCHUNK_SIZE_2]] & FACE_BIT_YMAX) != 0) {
+					ctx->counts[index] = 0;
 				} else if (b < BLOCK_WATER || b > BLOCK_STILL_LAVA) {
-					Builder_Counts[index] = Builder_StretchX(index, x, y, z, cIndex, b, FACE_YMAX);
+					ctx->counts[index] = Builder_StretchX(ctx, index, x, y, z, cIndex, b, FACE_YMAX);
 				} else {
-					Builder_Counts[index] = Builder_StretchXLiquid(index, x, y, z, cIndex, b);
+					ctx->counts[index] = Builder_StretchXLiquid(ctx, index, x, y, z, cIndex, b);
 				}
 			}
 		}
@@ -256,12 +320,12 @@ for (yy = -1; yy < 17; ++yy) {\
 			block    = get_block;\
 			allAir   = allAir   && Blocks.Draw[block] == DRAW_GAS;\
 			allSolid = allSolid && Blocks.FullOpaque[block];\
-			Builder_Chunk[cIndex] = block;\
+			ctx->chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static cc_bool ReadChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+static cc_bool ReadChunkData(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* outAllAir) {
 	BlockRaw* blocks = World.Blocks;
 	BlockRaw* blocks2;
 	cc_bool allAir = true, allSolid = true;
@@ -305,12 +369,12 @@ for (yy = -1; yy < 17; ++yy) {\
 \
 			block  = get_block;\
 			allAir = allAir && Blocks.Draw[block] == DRAW_GAS;\
-			Builder_Chunk[cIndex] = block;\
+			ctx->chunk[cIndex] = block;\
 		}\
 	}\
 }
 
-static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
+static cc_bool ReadBorderChunkData(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* outAllAir) {
 	BlockRaw* blocks = World.Blocks;
 	BlockRaw* blocks2;
 	cc_bool allAir = true;
@@ -333,7 +397,7 @@ static cc_bool ReadBorderChunkData(int x1, int y1, int z1, cc_bool* outAllAir) {
 	return false;
 }
 
-static void OutputChunkPartsMeta(int x, int y, int z, struct ChunkInfo* info) {
+static void OutputChunkPartsMeta(struct BuilderContext* ctx, int x, int y, int z, struct ChunkInfo* info) {
 	cc_bool hasNorm, hasTran;
 	int partsIndex;
 	int i, j, curIdx, offset;
@@ -347,8 +411,8 @@ static void OutputChunkPartsMeta(int x, int y, int z, struct ChunkInfo* info) {
 		j = i + ATLAS1D_MAX_ATLASES;
 		curIdx = partsIndex + i * World.ChunksCount;
 
-		hasNorm |= SetPartInfo(&Builder_Parts[i], &offset, &MapRenderer_PartsNormal[curIdx]);
-		hasTran |= SetPartInfo(&Builder_Parts[j], &offset, &MapRenderer_PartsTranslucent[curIdx]);
+		hasNorm |= SetPartInfo(&ctx->parts[i], &offset, &MapRenderer_PartsNormal[curIdx]);
+		hasTran |= SetPartInfo(&ctx->parts[j], &offset, &MapRenderer_PartsTranslucent[curIdx]);
 	}
 
 	if (hasNorm) {
@@ -359,134 +423,312 @@ static void OutputChunkPartsMeta(int x, int y, int z, struct ChunkInfo* info) {
 	}
 }
 
-void Builder_MakeChunk(struct ChunkInfo* info) {
-#ifdef CC_BUILD_TINYSTACK
-	BlockID* chunk   = (cc_uint8*)temp_mem;
-	cc_uint8* counts = (cc_uint8*)temp_mem + EXTCHUNK_SIZE_3;
-#else
-	BlockID chunk[EXTCHUNK_SIZE_3]; 
-	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT]; 
-#endif
 
-#ifdef CC_BUILD_ADVLIGHTING
-	int bitFlags[EXTCHUNK_SIZE_3];
-#else
-	int bitFlags[1];
-#endif
+/*########################################################################################################################*
+*-------------------------------------------------Chunk visibility graph--------------------------------------------------*
+*#########################################################################################################################*/
+/* Packs an index into the 16x16x16 visited array. Coordinates range from 0 to 15. */
+#define Vis_Pack(xx, yy, zz) (((yy) << 8) | ((zz) << 4) | (xx))
 
-	cc_bool allAir, allSolid, onBorder;
-	int xMax, yMax, zMax, totalVerts;
-	int cIndex, index;
-	int x, y, z, xx, yy, zz;
-	int x1 = info->centreX - 8, y1 = info->centreY - 8, z1 = info->centreZ - 8;
+#define Vis_Push(xx, yy, zz) \
+	cIndex = Builder_PackChunk(xx, yy, zz); \
+	index  = Vis_Pack(xx, yy, zz); \
+	if (!seen[index] && !Blocks.FullOpaque[ctx->chunk[cIndex]]) { seen[index] = true; stack[count++] = index; }
 
-	Builder_Chunk  = chunk;
-	Builder_Counts = counts;
-	Builder_BitFlags = bitFlags;
-	Builder_PrePrepareChunk();
-	
-	onBorder = 
+/* Returns the pairs of faces that are connected by the set of faces reached by one flood fill */
+static cc_uint16 Vis_ConnectFaces(int faces) {
+	cc_uint16 flags = 0;
+	int a, b;
+
+	for (a = 0; a < FACE_COUNT; a++) 
+	{
+		if (!(faces & (1 << a))) continue;
+		for (b = a + 1; b < FACE_COUNT; b++)
+		{
+			if (faces & (1 << b)) flags |= CHUNK_VIS_BIT(a, b);
+		}
+	}
+	return flags;
+}
+
+/* Calculates which faces of the chunk can be seen from which other faces of the chunk, */
+/*  by flood filling through all the blocks in the chunk which aren't fully opaque */
+static cc_uint16 ComputeVisibility(struct BuilderContext* ctx) {
+	cc_uint8* seen   = ctx->visSeen;
+	cc_uint16* stack = ctx->visStack;
+	cc_uint16 flags  = 0;
+	int i, cur, count, faces, index, cIndex;
+	int xx, yy, zz;
+	Mem_Set(seen, 0, CHUNK_SIZE_3);
+
+	for (i = 0; i < CHUNK_SIZE_3; i++) 
+	{
+		count = 0;
+		xx = i & CHUNK_MASK; zz = (i >> 4) & CHUNK_MASK; yy = i >> 8;
+		Vis_Push(xx, yy, zz);
+		faces = 0;
+
+		while (count) {
+			cur = stack[--count];
+			xx  = cur & CHUNK_MASK; zz = (cur >> 4) & CHUNK_MASK; yy = cur >> 8;
+
+			if (xx == 0) { faces |= 1 << FACE_XMIN; } else { Vis_Push(xx - 1, yy, zz); }
+			if (xx == CHUNK_MAX) { faces |= 1 << FACE_XMAX; } else { Vis_Push(xx + 1, yy, zz); }
+			if (zz == 0) { faces |= 1 << FACE_ZMIN; } else { Vis_Push(xx, yy, zz - 1); }
+			if (zz == CHUNK_MAX) { faces |= 1 << FACE_ZMAX; } else { Vis_Push(xx, yy, zz + 1); }
+			if (yy == 0) { faces |= 1 << FACE_YMIN; } else { Vis_Push(xx, yy - 1, zz); }
+			if (yy == CHUNK_MAX) { faces |= 1 << FACE_YMAX; } else { Vis_Push(xx, yy + 1, zz); }
+		}
+		flags |= Vis_ConnectFaces(faces);
+		if (flags == CHUNK_VIS_ALL) break;
+	}
+	return flags;
+}
+
+static void UpdateVisibility(struct BuilderContext* ctx, struct ChunkInfo* info, cc_bool allAir, cc_bool allSolid) {
+	if (allAir) {
+		info->visFlags = CHUNK_VIS_ALL;
+	} else if (allSolid) {
+		info->visFlags = 0;
+	} else {
+		info->visFlags = ComputeVisibility(ctx);
+	}
+}
+
+/* Contains the state for building the mesh of a chunk in a batch of chunks */
+struct BuilderJob {
+	struct ChunkInfo* info;
+	/* Whether Lighting.LightHint has already been called for this chunk */
+	cc_bool lightHinted;
+	/* Whether the mesh couldn't be built, and so needs to be rebuilt on the main thread */
+	cc_bool failed;
+	/* Vertices built on a worker thread, which still need to be uploaded to the GPU */
+	struct VertexTextured* vertices;
+	int verticesCount;
+};
+
+#ifdef CC_BUILD_GL11
+static void BuildChunkPartVbs(struct VertexTextured* vertices, int x1, int y1, int z1) {
+	int i, curIdx, cIndex = World_ChunkPack(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT);
+
+	for (i = 0; i < MapRenderer_1DUsedCount; i++) {
+		curIdx = cIndex + i * World.ChunksCount;
+
+		BuildPartVbs(vertices, &MapRenderer_PartsNormal[curIdx]);
+		BuildPartVbs(vertices, &MapRenderer_PartsTranslucent[curIdx]);
+	}
+}
+#endif
+
+/* Reads the blocks of the chunk (and the blocks just outside the chunk) into the context */
+/* Returns whether all the blocks in the chunk are solid */
+static cc_bool ReadChunk(struct BuilderContext* ctx, int x1, int y1, int z1, cc_bool* allAir) {
+	cc_bool onBorder = 
 		x1 == 0 || y1 == 0 || z1 == 0   || x1 + CHUNK_SIZE >= World.Width ||
 		y1 + CHUNK_SIZE >= World.Height || z1 + CHUNK_SIZE >= World.Length;
 
 	if (onBorder) {
 		/* less optimal case here */
-		Mem_Set(chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
-		allSolid = ReadBorderChunkData(x1, y1, z1, &allAir);
+		Mem_Set(ctx->chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
+		return ReadBorderChunkData(ctx, x1, y1, z1, allAir);
 	} else {
-		allSolid = ReadChunkData(x1, y1, z1, &allAir);
+		return ReadChunkData(ctx, x1, y1, z1, allAir);
 	}
+}
 
-	info->allAir = allAir;
-	if (allAir || allSolid) return;
-	Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
+/* Calculates how many vertices are needed for each face in the chunk */
+static void StretchChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	Mem_Set(ctx->counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
+	ctx->chunkEndX = min(World.Width,  x1 + CHUNK_SIZE);
+	ctx->chunkEndY = min(World.Height, y1 + CHUNK_SIZE);
+	ctx->chunkEndZ = min(World.Length, z1 + CHUNK_SIZE);
+	PrepareChunk(ctx, x1, y1, z1, 0, ctx->chunkEndY - y1 - 1);
+}
+
+/* Outputs the vertices of every block in the y slices from minYY to maxYY of the chunk into ctx->vertices */
+static void RenderSlices(struct BuilderContext* ctx, int x1, int y1, int z1, int minYY, int maxYY) {
+	int cIndex, index;
+	int x, y, z, xx, yy, zz;
+	Builder_PostPrepareChunk(ctx);
 
-	Mem_Set(counts, 1, CHUNK_SIZE_3 * FACE_COUNT);
-	xMax = min(World.Width,  x1 + CHUNK_SIZE);
-	yMax = min(World.Height, y1 + CHUNK_SIZE);
-	zMax = min(World.Length, z1 + CHUNK_SIZE);
+	for (y = y1 + minYY, yy = minYY; yy <= maxYY; y++, yy++) {
+		if (ctx->slices) BeginSlice(ctx);
 
-	Builder_ChunkEndX = xMax; Builder_ChunkEndZ = zMax;
-	PrepareChunk(x1, y1, z1);
+		for (z = z1, zz = 0; z < ctx->chunkEndZ; z++, zz++) {
+			cIndex = Builder_PackChunk(0, yy, zz);
 
-	totalVerts = Builder_TotalVerticesCount();
-	if (!totalVerts) return;
-	
-	OutputChunkPartsMeta(x1, y1, z1, info);
-#ifdef OCCLUSION
-	if (info.NormalParts != null || info.TranslucentParts != null)
-		info.occlusionFlags = (cc_uint8)ComputeOcclusion();
-#endif
+			for (x = x1, xx = 0; x < ctx->chunkEndX; x++, xx++, cIndex++) {
+				ctx->block = ctx->chunk[cIndex];
+				if (Blocks.Draw[ctx->block] == DRAW_GAS) continue;
 
+				index = Builder_PackCount(xx, yy, zz);
+				ctx->chunkIndex = cIndex;
+				Builder_RenderBlock(ctx, index, x, y, z);
+			}
+		}
+		if (ctx->slices) EndSlice(ctx, yy);
+	}
+}
+
+/* Outputs the vertices of every block in the chunk into ctx->vertices */
+static void RenderChunk(struct BuilderContext* ctx, int x1, int y1, int z1) {
+	RenderSlices(ctx, x1, y1, z1, 0, ctx->chunkEndY - y1 - 1);
+}
+
+cc_bool Builder_UseTileWrap(void) {
+	/* Greedy meshed faces rely on the backend wrapping texture V within the tile */
+	return Builder_GreedyMeshing && !Builder_SmoothLighting && Gfx.SupportsTileWrap;
+}
+
+cc_bool Builder_UseChunkVertices(void) {
+	/* Encoded tile wrapped texture V coords can't be stored in 16 bits */
+	return Gfx.SupportsChunkVertices && !Builder_UseTileWrap();
+}
+
+static cc_uint16 PackChunkTexCoord(float value) {
+	if (value <= 0.0f)     return 0;
+	if (value >= 65535.0f) return 65535;
+	/* Rounds down, so texture coordinates never move into the adjacent tile in the atlas */
+	return (cc_uint16)value;
+}
+
+/* Converts vertices relative to the given chunk origin into the compact VERTEX_FORMAT_CHUNK layout */
+static void PackChunkVertices(struct VertexChunk* dst, const struct VertexTextured* src, int count, 
+							int x1, int y1, int z1) {
+	int i, r, g, b;
+
+	for (i = 0; i < count; i++, src++, dst++)
+	{
+		dst->x = (cc_int16)Math_Floor((src->x - x1) * VERTEX_CHUNK_POS_SCALE + 0.5f);
+		dst->y = (cc_int16)Math_Floor((src->y - y1) * VERTEX_CHUNK_POS_SCALE + 0.5f);
+		dst->z = (cc_int16)Math_Floor((src->z - z1) * VERTEX_CHUNK_POS_SCALE + 0.5f);
+
+		/* Chunk vertices are always fully opaque, so alpha can be discarded */
+		r = PackedCol_R(src->Col); g = PackedCol_G(src->Col); b = PackedCol_B(src->Col);
+		dst->Col = (cc_uint16)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+
+		dst->U = PackChunkTexCoord(src->U * VERTEX_CHUNK_U_SCALE);
+		dst->V = PackChunkTexCoord(src->V * VERTEX_CHUNK_V_SCALE);
+	}
+}
+
+/* Uploads the vertices of a chunk mesh that was built into a temp buffer to the GPU */
+static void UploadVertices(struct ChunkInfo* info, struct VertexTextured* vertices, int count) {
 #ifndef CC_BUILD_GL11
 	/* add an extra element to fix crashing on some GPUs */
-	info->vb = Gfx_CreateVb(VERTEX_FORMAT_TEXTURED, totalVerts + 1);
-	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(info->vb,
-													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+	void* data = MapRenderer_LockChunkVb(info, count + 1);
+
+	if (Builder_UseChunkVertices()) {
+		PackChunkVertices((struct VertexChunk*)data, vertices, count,
+						info->centreX - 8, info->centreY - 8, info->centreZ - 8);
+	} else {
+		Mem_Copy(data, vertices, count * sizeof(struct VertexTextured));
+	}
+	MapRenderer_UnlockChunkVb(info);
 #else
-	/* NOTE: Relies on assumption vb is ignored by GL11 Gfx_LockVb implementation */
-	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(0, 
-													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+	BuildChunkPartVbs(vertices, info->centreX - 8, info->centreY - 8, info->centreZ - 8);
 #endif
-	Builder_PostPrepareChunk();
-	/* now render the chunk */
+}
 
-	for (y = y1, yy = 0; y < yMax; y++, yy++) {
-		for (z = z1, zz = 0; z < zMax; z++, zz++) {
-			cIndex = Builder_PackChunk(0, yy, zz);
+static void UploadChunk(struct BuilderJob* job) {
+	UploadVertices(job->info, job->vertices, job->verticesCount);
+	Mem_Free(job->vertices);
+	job->vertices = NULL;
+}
 
-			for (x = x1, xx = 0; x < xMax; x++, xx++, cIndex++) {
-				Builder_Block = chunk[cIndex];
-				if (Blocks.Draw[Builder_Block] == DRAW_GAS) continue;
+/* Builds the mesh of a chunk, using the given context */
+/* NOTE: When not on the main thread, or when using compact vertices, */
+/*  vertices are built into a temp buffer that must be uploaded later */
+static void BuildChunk(struct BuilderContext* ctx, struct BuilderJob* job, cc_bool mainThread) {
+	struct ChunkInfo* info = job->info;
+	cc_bool allAir, allSolid, compact;
+	int totalVerts;
+	int x1 = info->centreX - 8, y1 = info->centreY - 8, z1 = info->centreZ - 8;
+	Builder_PrePrepareChunk(ctx);
+	
+	allSolid     = ReadChunk(ctx, x1, y1, z1, &allAir);
+	info->allAir = allAir;
+	UpdateVisibility(ctx, info, allAir, allSolid);
+	if (allAir || allSolid) return;
+	if (!job->lightHinted) Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
 
-				index = Builder_PackCount(xx, yy, zz);
-				Builder_ChunkIndex = cIndex;
-				Builder_RenderBlock(index, x, y, z);
-			}
-		}
+	if (info->lod) {
+		Lod_StretchChunk(ctx, x1, y1, z1, info->lod);
+	} else {
+		StretchChunk(ctx, x1, y1, z1);
 	}
 
-#ifdef CC_BUILD_GL11
-	cIndex = World_ChunkPack(x1 >> CHUNK_SHIFT, y1 >> CHUNK_SHIFT, z1 >> CHUNK_SHIFT);
+	totalVerts = Builder_TotalVerticesCount(ctx);
+	if (!totalVerts) return;
 
-	for (index = 0; index < MapRenderer_1DUsedCount; index++) {
-		int curIdx = cIndex + index * World.ChunksCount;
+	compact = Builder_UseChunkVertices();
+	if (!mainThread || compact) {
+		/* add an extra element to fix crashing on some GPUs */
+		ctx->vertices = (struct VertexTextured*)Mem_TryAlloc(totalVerts + 1, sizeof(struct VertexTextured));
+		/* Jobs that fail on worker threads are retried on the main thread, but if that */
+		/*  also fails then the chunk is just left without a mesh */
+		if (!ctx->vertices) { job->failed = true; return; }
+	}
+	
+	OutputChunkPartsMeta(ctx, x1, y1, z1, info);
 
-		BuildPartVbs(&MapRenderer_PartsNormal[curIdx]);
-		BuildPartVbs(&MapRenderer_PartsTranslucent[curIdx]);
+	if (mainThread && !compact) {
+#ifndef CC_BUILD_GL11
+		/* add an extra element to fix crashing on some GPUs */
+		ctx->vertices = (struct VertexTextured*)MapRenderer_LockChunkVb(info, totalVerts + 1);
+#else
+		/* NOTE: Relies on assumption vb is ignored by GL11 Gfx_LockVb implementation */
+		ctx->vertices = (struct VertexTextured*)Gfx_LockVb(0, 
+													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+#endif
+	}
+
+	if (info->lod) {
+		Lod_RenderChunk(ctx, x1, y1, z1, info->lod);
+	} else {
+		RenderChunk(ctx, x1, y1, z1);
+	}
+
+	if (!mainThread || compact) {
+		job->vertices      = ctx->vertices;
+		job->verticesCount = totalVerts;
+		if (mainThread) UploadChunk(job);
+		return;
 	}
+
+#ifdef CC_BUILD_GL11
+	BuildChunkPartVbs(ctx->vertices, x1, y1, z1);
 #else
-	Gfx_UnlockVb(info->vb);
+	MapRenderer_UnlockChunkVb(info);
 #endif
 }
 
-static cc_bool Builder_OccludedLiquid(int chunkIndex) {
+static cc_bool Builder_OccludedLiquid(struct BuilderContext* ctx, int chunkIndex) {
 	chunkIndex += EXTCHUNK_SIZE_2; /* Checking y above */
 	return
-		Blocks.FullOpaque[Builder_Chunk[chunkIndex]]
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex - 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + 1]] != DRAW_GAS
-		&& Blocks.Draw[Builder_Chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
+		Blocks.FullOpaque[ctx->chunk[chunkIndex]]
+		&& Blocks.Draw[ctx->chunk[chunkIndex - EXTCHUNK_SIZE]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex - 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + 1]] != DRAW_GAS
+		&& Blocks.Draw[ctx->chunk[chunkIndex + EXTCHUNK_SIZE]] != DRAW_GAS;
 }
 
-static void DefaultPrePrepateChunk(void) {
-	Mem_Set(Builder_Parts, 0, sizeof(Builder_Parts));
+static void DefaultPrePrepateChunk(struct BuilderContext* ctx) {
+	Mem_Set(ctx->parts, 0, sizeof(ctx->parts));
 }
 
-static void DefaultPostStretchChunk(void) {
+static void DefaultPostStretchChunk(struct BuilderContext* ctx) {
 	int i, j, offset;
 	offset = 0;
 	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
 		j = i + ATLAS1D_MAX_ATLASES;
 
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[i], offset);
-		offset = Builder1DPart_CalcOffsets(&Builder_Parts[j], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[i], offset);
+		offset = Builder1DPart_CalcOffsets(ctx, &ctx->parts[j], offset);
 	}
 }
 
-static RNGState spriteRng;
-static void Builder_DrawSprite(int x, int y, int z) {
+static void Builder_DrawSprite(struct BuilderContext* ctx, int x, int y, int z) {
 	struct Builder1DPart* part;
 	struct VertexTextured* v;
 	cc_uint8 offsetType;
@@ -505,29 +747,29 @@ static void Builder_DrawSprite(int x, int y, int z) {
 
 #define s_u1 0.0f
 #define s_u2 UV2_Scale
-	loc = Block_Tex(Builder_Block, FACE_XMAX);
+	loc = Block_Tex(ctx->block, FACE_XMAX);
 	v1  = Atlas1D_RowId(loc) * Atlas1D.InvTileSize;
 	v2  = v1 + Atlas1D.InvTileSize * UV2_Scale;
 
-	offsetType = Blocks.SpriteOffset[Builder_Block];
+	offsetType = Blocks.SpriteOffset[ctx->block];
 	if (offsetType >= 6 && offsetType <= 7) {
-		Random_Seed(&spriteRng, (x + 1217 * z) & 0x7fffffff);
-		valX = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
-		valY = Random_Range(&spriteRng, 0,  3 + 1) / 16.0f;
-		valZ = Random_Range(&spriteRng, -3, 3 + 1) / 16.0f;
+		Random_Seed(&ctx->spriteRng, (x + 1217 * z) & 0x7fffffff);
+		valX = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
+		valY = Random_Range(&ctx->spriteRng, 0,  3 + 1) / 16.0f;
+		valZ = Random_Range(&ctx->spriteRng, -3, 3 + 1) / 16.0f;
 
 		x1 += valX - 1.7f/16.0f; x2 += valX + 1.7f/16.0f;
 		z1 += valZ - 1.7f/16.0f; z2 += valZ + 1.7f/16.0f;
 		if (offsetType == 7) { y1 -= valY; y2 -= valY; }
 	}
 	
-	bright = Blocks.Brightness[Builder_Block];
-	part   = &Builder_Parts[Atlas1D_Index(loc)];
+	bright = Blocks.Brightness[ctx->block];
+	part   = &ctx->parts[Atlas1D_Index(loc)];
 	color  = bright ? PACKEDCOL_WHITE : Lighting.Color_Sprite_Fast(x, y, z);
-	Block_Tint(color, Builder_Block);
+	Block_Tint(color, ctx->block);
 
 	/* Draw Z axis */
-	v = &Builder_Vertices[part->sOffset];
+	v = &ctx->vertices[part->sOffset];
 	v->x = x1; v->y = y1; v->z = z1; v->Col = color; v->U = s_u2; v->V = v2; v++;
 	v->x = x1; v->y = y2; v->z = z1; v->Col = color; v->U = s_u2; v->V = v1; v++;
 	v->x = x2; v->y = y2; v->z = z2; v->Col = color; v->U = s_u1; v->V = v1; v++;
@@ -582,72 +824,108 @@ static PackedCol Normal_LightColor(int x, int y, int z, Face face, BlockID block
 	return 0; /* should never happen */
 }
 
-static cc_bool Normal_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
+static cc_bool Normal_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
 
-	if (cur != initial || Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
-	if (Builder_FullBright) return true;
+	if (cur != initial || Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)) return false;
+	if (ctx->fullBright) return true;
 
-	return Normal_LightColor(Builder_X, Builder_Y, Builder_Z, face, initial) == Normal_LightColor(x, y, z, face, cur);
+	return Normal_LightColor(ctx->baseX, ctx->baseY, ctx->baseZ, face, initial) == Normal_LightColor(x, y, z, face, cur);
 }
 
-static int NormalBuilder_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int NormalBuilder_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int NormalBuilder_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int NormalBuilder_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int NormalBuilder_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Normal_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Normal_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {	
+/* The greedy mesh builder also merges stretched faces with the rows above/behind them. */
+/* The number of extra rows merged is stored in the upper bits of the face count. */
+/*  (the normal mesh builder never merges rows, so its counts are always <= GREEDY_MAX_COUNT) */
+#define GREEDY_ROWS_SHIFT 5
+#define GREEDY_MAX_COUNT ((1 << GREEDY_ROWS_SHIFT) - 1)
+#define GREEDY_MAX_ROWS  (1 << (8 - GREEDY_ROWS_SHIFT))
+#define Greedy_Count(value) ((value) & GREEDY_MAX_COUNT)
+#define Greedy_Rows(value)  (((value) >> GREEDY_ROWS_SHIFT) + 1)
+
+/* Extends the face that was just drawn by the Drawer to also cover the given number of rows */
+/* Texture V then spans several tiles, so is encoded for the backend to wrap within the tile */
+/*  (see GFX_TILE_WRAP_SCALE), as the tiles above/below this one in the 1D atlas are different */
+static void Greedy_ExtendRows(struct BuilderContext* ctx, struct VertexTextured* v, Face face, int rows, TextureLoc loc) {
+	int row = Atlas1D_RowId(loc);
+	float base = (float)((row + 1) * GFX_TILE_WRAP_SCALE - row);
+	float extraV = (float)(rows - 1);
+	int i;
+
+	for (i = 0; i < 4; i++, v++) 
+	{
+		/* Converts V to be in tiles, then offsets it by the encoded row */
+		v->V = v->V * Atlas1D.TilesPerAtlas + base;
+
+		if (face >= FACE_YMIN) {
+			/* Rows are merged along Z axis (towards Z2, i.e. towards V2) */
+			if (v->z != ctx->drawer.Z2) continue;
+			v->z += rows - 1; v->V += extraV;
+		} else if (v->y == ctx->drawer.Y2) {
+			/* Rows are merged along Y axis (Y2 is V1, Y1 is V2) */
+			v->y += rows - 1;
+		} else {
+			v->V += extraV;
+		}
+	}
+}
+
+static void NormalBuilder_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {	
 	/* counters */
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
@@ -659,94 +937,107 @@ static void NormalBuilder_RenderBlock(int index, int x, int y, int z) {
 
 	/* per-face state */
 	struct Builder1DPart* part;
+	struct VertexTextured* v;
 	TextureLoc loc;
 	PackedCol col;
 	int offset;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	fullBright = Blocks.Brightness[Builder_Block];
-	baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	lightFlags = Blocks.LightOffset[Builder_Block];
+	fullBright = Blocks.Brightness[ctx->block];
+	baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	lightFlags = Blocks.LightOffset[ctx->block];
 
-	Drawer.MinBB = Blocks.MinBB[Builder_Block]; Drawer.MinBB.y = 1.0f - Drawer.MinBB.y;
-	Drawer.MaxBB = Blocks.MaxBB[Builder_Block]; Drawer.MaxBB.y = 1.0f - Drawer.MaxBB.y;
+	ctx->drawer.MinBB = Blocks.MinBB[ctx->block]; ctx->drawer.MinBB.y = 1.0f - ctx->drawer.MinBB.y;
+	ctx->drawer.MaxBB = Blocks.MaxBB[ctx->block]; ctx->drawer.MaxBB.y = 1.0f - ctx->drawer.MaxBB.y;
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	Drawer.X1 = x + min.x; Drawer.Y1 = y + min.y; Drawer.Z1 = z + min.z;
-	Drawer.X2 = x + max.x; Drawer.Y2 = y + max.y; Drawer.Z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->drawer.X1 = x + min.x; ctx->drawer.Y1 = y + min.y; ctx->drawer.Z1 = z + min.z;
+	ctx->drawer.X2 = x + max.x; ctx->drawer.Y2 = y + max.y; ctx->drawer.Z2 = z + max.z;
 
-	Drawer.Tinted  = Blocks.Tinted[Builder_Block];
-	Drawer.TintCol = Blocks.FogCol[Builder_Block];
+	ctx->drawer.Tinted  = Blocks.Tinted[ctx->block];
+	ctx->drawer.TintCol = Blocks.FogCol[ctx->block];
 
 	if (count_XMin) {
-		loc    = Block_Tex(Builder_Block, FACE_XMIN);
+		loc    = Block_Tex(ctx->block, FACE_XMIN);
 		offset = (lightFlags >> FACE_XMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			x >= offset ? Lighting.Color_XSide_Fast(x - offset, y, z) : Env.SunXSide;
-		Drawer_XMin(count_XMin, col, loc, &part->faces.vertices[FACE_XMIN]);
+		v   = part->faces.vertices[FACE_XMIN];
+		DrawerData_XMin(&ctx->drawer, Greedy_Count(count_XMin), col, loc, &part->faces.vertices[FACE_XMIN]);
+		if (count_XMin > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_XMIN, Greedy_Rows(count_XMin), loc);
 	}
 
 	if (count_XMax) {
-		loc    = Block_Tex(Builder_Block, FACE_XMAX);
+		loc    = Block_Tex(ctx->block, FACE_XMAX);
 		offset = (lightFlags >> FACE_XMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			x <= (World.MaxX - offset) ? Lighting.Color_XSide_Fast(x + offset, y, z) : Env.SunXSide;
-		Drawer_XMax(count_XMax, col, loc, &part->faces.vertices[FACE_XMAX]);
+		v   = part->faces.vertices[FACE_XMAX];
+		DrawerData_XMax(&ctx->drawer, Greedy_Count(count_XMax), col, loc, &part->faces.vertices[FACE_XMAX]);
+		if (count_XMax > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_XMAX, Greedy_Rows(count_XMax), loc);
 	}
 
 	if (count_ZMin) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMIN);
+		loc    = Block_Tex(ctx->block, FACE_ZMIN);
 		offset = (lightFlags >> FACE_ZMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			z >= offset ? Lighting.Color_ZSide_Fast(x, y, z - offset) : Env.SunZSide;
-		Drawer_ZMin(count_ZMin, col, loc, &part->faces.vertices[FACE_ZMIN]);
+		v   = part->faces.vertices[FACE_ZMIN];
+		DrawerData_ZMin(&ctx->drawer, Greedy_Count(count_ZMin), col, loc, &part->faces.vertices[FACE_ZMIN]);
+		if (count_ZMin > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_ZMIN, Greedy_Rows(count_ZMin), loc);
 	}
 
 	if (count_ZMax) {
-		loc    = Block_Tex(Builder_Block, FACE_ZMAX);
+		loc    = Block_Tex(ctx->block, FACE_ZMAX);
 		offset = (lightFlags >> FACE_ZMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE :
 			z <= (World.MaxZ - offset) ? Lighting.Color_ZSide_Fast(x, y, z + offset) : Env.SunZSide;
-		Drawer_ZMax(count_ZMax, col, loc, &part->faces.vertices[FACE_ZMAX]);
+		v   = part->faces.vertices[FACE_ZMAX];
+		DrawerData_ZMax(&ctx->drawer, Greedy_Count(count_ZMax), col, loc, &part->faces.vertices[FACE_ZMAX]);
+		if (count_ZMax > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_ZMAX, Greedy_Rows(count_ZMax), loc);
 	}
 
 	if (count_YMin) {
-		loc    = Block_Tex(Builder_Block, FACE_YMIN);
+		loc    = Block_Tex(ctx->block, FACE_YMIN);
 		offset = (lightFlags >> FACE_YMIN) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE : Lighting.Color_YMin_Fast(x, y - offset, z);
-		Drawer_YMin(count_YMin, col, loc, &part->faces.vertices[FACE_YMIN]);
+		v   = part->faces.vertices[FACE_YMIN];
+		DrawerData_YMin(&ctx->drawer, Greedy_Count(count_YMin), col, loc, &part->faces.vertices[FACE_YMIN]);
+		if (count_YMin > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_YMIN, Greedy_Rows(count_YMin), loc);
 	}
 
 	if (count_YMax) {
-		loc    = Block_Tex(Builder_Block, FACE_YMAX);
+		loc    = Block_Tex(ctx->block, FACE_YMAX);
 		offset = (lightFlags >> FACE_YMAX) & 1;
-		part   = &Builder_Parts[baseOffset + Atlas1D_Index(loc)];
+		part   = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
 
 		col = fullBright ? PACKEDCOL_WHITE : Lighting.Color_YMax_Fast(x, y + offset, z);
-		Drawer_YMax(count_YMax, col, loc, &part->faces.vertices[FACE_YMAX]);
+		v   = part->faces.vertices[FACE_YMAX];
+		DrawerData_YMax(&ctx->drawer, Greedy_Count(count_YMax), col, loc, &part->faces.vertices[FACE_YMAX]);
+		if (count_YMax > GREEDY_MAX_COUNT) Greedy_ExtendRows(ctx, v, FACE_YMAX, Greedy_Rows(count_YMax), loc);
 	}
 }
 
@@ -769,17 +1060,95 @@ static void NormalBuilder_SetActive(void) {
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------Greedy mesh builder----------------------------------------------------*
+*#########################################################################################################################*/
+cc_bool Builder_GreedyMeshing;
+
+/* Attempts to merge the rows after the given stretched face into a single rectangle. */
+/* Returns the number of extra rows merged, shifted to the upper bits of the face count. */
+static int Greedy_MergeRows(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face, int count) {
+	int uCountStep, uChunkStep, vCountStep, vChunkStep, maxRows;
+	int rows, i, cIndex, index;
+	int xx, yy, zz, dx, dz;
+	cc_bool onBorder;
+
+	/* Only fully opaque blocks are merged, since they always fill the entire row */
+	if (!Blocks.FullOpaque[block]) return 0;
+	if (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA)       return 0;
+	if (!(Blocks.CanStretch[block] & (1 << face))) return 0;
+
+	if (face == FACE_XMIN || face == FACE_XMAX) {
+		/* U axis is Z axis */
+		uCountStep = CHUNK_SIZE * FACE_COUNT; uChunkStep = EXTCHUNK_SIZE; dx = 0; dz = 1;
+	} else {
+		/* U axis is X axis */
+		uCountStep = FACE_COUNT;              uChunkStep = 1;             dx = 1; dz = 0;
+	}
+
+	if (face >= FACE_YMIN) {
+		/* V axis is Z axis */
+		vCountStep = CHUNK_SIZE * FACE_COUNT; vChunkStep = EXTCHUNK_SIZE;
+		maxRows    = ctx->chunkEndZ - z;
+	} else {
+		/* V axis is Y axis */
+		vCountStep = CHUNK_SIZE_2 * FACE_COUNT; vChunkStep = EXTCHUNK_SIZE_2;
+		maxRows    = ctx->chunkEndY - y;
+	}
+	maxRows = min(maxRows, GREEDY_MAX_ROWS);
+
+	/* Side faces on the edges of the map are also hidden below sides level */
+	onBorder = 
+		(face == FACE_XMIN && x == 0) || (face == FACE_XMAX && x == World.MaxX) ||
+		(face == FACE_ZMIN && z == 0) || (face == FACE_ZMAX && z == World.MaxZ);
+
+	for (rows = 1; rows < maxRows; rows++) 
+	{
+		yy = face >= FACE_YMIN ? y : y + rows;
+		zz = face >= FACE_YMIN ? z + rows : z;
+		if (onBorder && yy < Builder_SidesLevel) break;
+
+		for (i = 0; i < count; i++) 
+		{
+			index  = countIndex + rows * vCountStep + i * uCountStep;
+			cIndex = chunkIndex + rows * vChunkStep + i * uChunkStep;
+			xx     = x + i * dx;
+
+			/* Face is hidden or already part of another face */
+			if (ctx->counts[index] != 1) break;
+			if (!Normal_CanStretch(ctx, block, cIndex, xx, yy, zz + i * dz, face)) break;
+		}
+		if (i < count) break;
+
+		for (i = 0; i < count; i++) 
+		{
+			ctx->counts[countIndex + rows * vCountStep + i * uCountStep] = 0;
+		}
+	}
+	return (rows - 1) << GREEDY_ROWS_SHIFT;
+}
+
+static int GreedyBuilder_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+	int count = NormalBuilder_StretchX(ctx, countIndex, x, y, z, chunkIndex, block, face);
+	return count | Greedy_MergeRows(ctx, countIndex, x, y, z, chunkIndex, block, face, count);
+}
+
+static int GreedyBuilder_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+	int count = NormalBuilder_StretchZ(ctx, countIndex, x, y, z, chunkIndex, block, face);
+	return count | Greedy_MergeRows(ctx, countIndex, x, y, z, chunkIndex, block, face, count);
+}
+
+static void GreedyBuilder_SetActive(void) {
+	NormalBuilder_SetActive();
+	Builder_StretchX = GreedyBuilder_StretchX;
+	Builder_StretchZ = GreedyBuilder_StretchZ;
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------Advanced mesh builder---------------------------------------------------*
 *#########################################################################################################################*/
 #ifdef CC_BUILD_ADVLIGHTING
-static Vec3 adv_minBB, adv_maxBB;
-static int adv_initBitFlags, adv_baseOffset;
-static int* adv_bitFlags;
-static float adv_x1, adv_y1, adv_z1, adv_x2, adv_y2, adv_z2;
-static PackedCol adv_lerp[5], adv_lerpX[5], adv_lerpZ[5], adv_lerpY[5];
-static cc_bool adv_tinted;
-
 enum ADV_MASK {
 	/* z-1 cube points */
 	xM1_yM1_zM1, xM1_yCC_zM1, xM1_yP1_zM1,
@@ -803,7 +1172,7 @@ enum ADV_MASK {
 /* - bit 0 set: Y-1 is in light */
 /* - bit 1 set: Y   is in light */
 /* - bit 2 set: Y+1 is in light */
-static int Adv_Lit(int x, int y, int z, int cIndex) {
+static int Adv_Lit(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
 	int flags, offset, lightFlags;
 	BlockID block;
 	if (y < 0 || y >= World.Height) return LIT_M1 | LIT_CC | LIT_P1; /* all faces lit */
@@ -814,7 +1183,7 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	}
 
 	flags = 0;
-	block = Builder_Chunk[cIndex];
+	block = ctx->chunk[cIndex];
 	lightFlags = Blocks.LightOffset[block];
 
 	/* TODO using LIGHT_FLAG_SHADES_FROM_BELOW is wrong here, */
@@ -832,26 +1201,26 @@ static int Adv_Lit(int x, int y, int z, int cIndex) {
 	flags |= Lighting.IsLit_Fast(x, (y + 1) - offset, z) ? LIT_P1 : 0;
 
 	/* If a block is fullbright, it should also look as if that spot is lit */
-	if (Blocks.Brightness[Builder_Chunk[cIndex - 324]]) flags |= LIT_M1;
+	if (Blocks.Brightness[ctx->chunk[cIndex - 324]]) flags |= LIT_M1;
 	if (Blocks.Brightness[block])                       flags |= LIT_CC;
-	if (Blocks.Brightness[Builder_Chunk[cIndex + 324]]) flags |= LIT_P1;
+	if (Blocks.Brightness[ctx->chunk[cIndex + 324]]) flags |= LIT_P1;
 	
 	return flags;
 }
 
-static int Adv_ComputeLightFlags(int x, int y, int z, int cIndex) {
-	if (Builder_FullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
+static int Adv_ComputeLightFlags(struct BuilderContext* ctx, int x, int y, int z, int cIndex) {
+	if (ctx->fullBright) return (1 << xP1_yP1_zP1) - 1; /* all faces fully bright */
 
 	return
-		Adv_Lit(x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
-		Adv_Lit(x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
-		Adv_Lit(x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
-		Adv_Lit(x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
-		Adv_Lit(x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
-		Adv_Lit(x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
-		Adv_Lit(x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
-		Adv_Lit(x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
-		Adv_Lit(x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
+		Adv_Lit(ctx, x - 1, y, z - 1, cIndex - 1 - 18) << xM1_yM1_zM1 |
+		Adv_Lit(ctx, x - 1, y, z,     cIndex - 1)      << xM1_yM1_zCC |
+		Adv_Lit(ctx, x - 1, y, z + 1, cIndex - 1 + 18) << xM1_yM1_zP1 |
+		Adv_Lit(ctx, x,     y, z - 1, cIndex + 0 - 18) << xCC_yM1_zM1 |
+		Adv_Lit(ctx, x,     y, z,     cIndex + 0)      << xCC_yM1_zCC |
+		Adv_Lit(ctx, x,     y, z + 1, cIndex + 0 + 18) << xCC_yM1_zP1 |
+		Adv_Lit(ctx, x + 1, y, z - 1, cIndex + 1 - 18) << xP1_yM1_zM1 |
+		Adv_Lit(ctx, x + 1, y, z,     cIndex + 1)      << xP1_yM1_zCC |
+		Adv_Lit(ctx, x + 1, y, z + 1, cIndex + 1 + 18) << xP1_yM1_zP1;
 }
 
 static int adv_masks[FACE_COUNT] = {
@@ -882,384 +1251,383 @@ static int adv_masks[FACE_COUNT] = {
 };
 
 
-static cc_bool Adv_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
-	BlockID cur = Builder_Chunk[chunkIndex];
-	adv_bitFlags[chunkIndex] = Adv_ComputeLightFlags(x, y, z, chunkIndex);
+static cc_bool Adv_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+	BlockID cur = ctx->chunk[chunkIndex];
+	ctx->bitFlags[chunkIndex] = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
 
 	return cur == initial
-		&& !Block_IsFaceHidden(cur, Builder_Chunk[chunkIndex + Builder_Offsets[face]], face)
-		&& (adv_initBitFlags == adv_bitFlags[chunkIndex]
+		&& !Block_IsFaceHidden(cur, ctx->chunk[chunkIndex + Builder_Offsets[face]], face)
+		&& (ctx->initBitFlags == ctx->bitFlags[chunkIndex]
 		/* Check that this face is either fully bright or fully in shadow */
-		&& (adv_initBitFlags == 0 || (adv_initBitFlags & adv_masks[face]) == adv_masks[face]));
+		&& (ctx->initBitFlags == 0 || (ctx->initBitFlags & adv_masks[face]) == adv_masks[face]));
 }
 
-static int Adv_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Adv_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1; cc_bool stretchTile;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << FACE_YMAX)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(chunkIndex)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, FACE_YMAX) && !Builder_OccludedLiquid(ctx, chunkIndex)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, FACE_YMAX);
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int Adv_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 	
 	x++;
 	chunkIndex++;
 	countIndex += FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (x < Builder_ChunkEndX && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (x < ctx->chunkEndX && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		x++;
 		chunkIndex++;
 		countIndex += FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int Adv_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Adv_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1; cc_bool stretchTile;
-	adv_initBitFlags = Adv_ComputeLightFlags(x, y, z, chunkIndex);
-	adv_bitFlags[chunkIndex] = adv_initBitFlags;
+	ctx->initBitFlags = Adv_ComputeLightFlags(ctx, x, y, z, chunkIndex);
+	ctx->bitFlags[chunkIndex] = ctx->initBitFlags;
 
 	z++;
 	chunkIndex += EXTCHUNK_SIZE;
 	countIndex += CHUNK_SIZE * FACE_COUNT;
 	stretchTile = (Blocks.CanStretch[block] & (1 << face)) != 0;
 
-	while (z < Builder_ChunkEndZ && stretchTile && Adv_CanStretch(block, chunkIndex, x, y, z, face)) {
-		Builder_Counts[countIndex] = 0;
+	while (z < ctx->chunkEndZ && stretchTile && Adv_CanStretch(ctx, block, chunkIndex, x, y, z, face)) {
+		ctx->counts[countIndex] = 0;
 		count++;
 		z++;
 		chunkIndex += EXTCHUNK_SIZE;
 		countIndex += CHUNK_SIZE * FACE_COUNT;
 	}
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
 
 #define Adv_CountBits(F, a, b, c, d) (((F >> a) & 1) + ((F >> b) & 1) + ((F >> c) & 1) + ((F >> d) & 1))
 
-static void Adv_DrawXMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Adv_DrawXMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.z, u2 = (count - 1) + adv_maxBB.z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.z, u2 = (count - 1) + ctx->maxBB.z * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aY0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xM1_yM1_zCC, xM1_yCC_zCC);
 	int aY0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xM1_yM1_zCC, xM1_yCC_zCC);
 	int aY1_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xM1_yP1_zCC, xM1_yCC_zCC);
 	int aY1_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xM1_yP1_zCC, xM1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMIN];
-	v.x = adv_x1;
+	v.x = ctx->x1;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.y = adv_y2; v.z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->y2; v.z = ctx->z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.y = ctx->y2;                                       v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+		v.y = ctx->y2; v.z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.z = ctx->z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_XMIN] = vertices;
 }
 
-static void Adv_DrawXMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Adv_DrawXMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.z), u2 = (1 - adv_maxBB.z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.z), u2 = (1 - ctx->maxBB.z) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aY0_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xP1_yM1_zCC, xP1_yCC_zCC);
 	int aY0_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xP1_yM1_zCC, xP1_yCC_zCC);
 	int aY1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xP1_yP1_zCC, xP1_yCC_zCC);
 	int aY1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xP1_yP1_zCC, xP1_yCC_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpX[aY0_Z0], col1_0 = Builder_FullBright ? white : adv_lerpX[aY1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpX[aY1_Z1], col0_1 = Builder_FullBright ? white : adv_lerpX[aY0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpX[aY0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerpX[aY1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpX[aY1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerpX[aY0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMAX];
-	v.x = adv_x2;
+	v.x = ctx->x2;
 	if (aY0_Z0 + aY1_Z1 > aY0_Z1 + aY1_Z0) {
-		v.y = adv_y2; v.z = adv_z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->y2; v.z = ctx->z1;               v.U = u1; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		              v.z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
 	} else {
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->y2; v.z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_XMAX] = vertices;
 }
 
-static void Adv_DrawZMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Adv_DrawZMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.x), u2 = (1 - adv_maxBB.x) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.x), u2 = (1 - ctx->maxBB.x) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
 	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yCC_zM1, xCC_yM1_zM1, xCC_yCC_zM1);
 	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yCC_zM1, xCC_yP1_zM1, xCC_yCC_zM1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMIN];
-	v.z = adv_z1;
+	v.z = ctx->z1;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.x = adv_x2 + (count - 1); v.y = adv_y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1); v.y = ctx->y1; v.U = u2; v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x1;               v.y = ctx->y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.y = ctx->y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_ZMIN] = vertices;
 }
 
-static void Adv_DrawZMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Adv_DrawZMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Y0 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
 	int aX1_Y0 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yCC_zP1, xCC_yM1_zP1, xCC_yCC_zP1);
 	int aX0_Y1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 	int aX1_Y1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yCC_zP1, xCC_yP1_zP1, xCC_yCC_zP1);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerpZ[aX1_Y1], col1_0 = Builder_FullBright ? white : adv_lerpZ[aX1_Y0];
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerpZ[aX0_Y0], col0_1 = Builder_FullBright ? white : adv_lerpZ[aX0_Y1];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y1], col1_0 = ctx->fullBright ? white : ctx->lerpZ[aX1_Y0];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y0], col0_1 = ctx->fullBright ? white : ctx->lerpZ[aX0_Y1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMAX];
-	v.z = adv_z2;
+	v.z = ctx->z2;
 	if (aX1_Y1 + aX0_Y0 > aX0_Y1 + aX1_Y0) {
-		v.x = adv_x1;               v.y = adv_y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x1;               v.y = ctx->y2; v.U = u1; v.V = v1; v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.y = ctx->y2;           v.V = v1; v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x2 + (count - 1); v.y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1); v.y = ctx->y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_ZMAX] = vertices;
 }
 
-static void Adv_DrawYMin(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Adv_DrawYMin(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Z0 = Adv_CountBits(F, xM1_yM1_zM1, xM1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
 	int aX1_Z0 = Adv_CountBits(F, xP1_yM1_zM1, xP1_yM1_zCC, xCC_yM1_zM1, xCC_yM1_zCC);
 	int aX0_Z1 = Adv_CountBits(F, xM1_yM1_zP1, xM1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 	int aX1_Z1 = Adv_CountBits(F, xP1_yM1_zP1, xP1_yM1_zCC, xCC_yM1_zP1, xCC_yM1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_1 = Builder_FullBright ? white : adv_lerpY[aX0_Z1], col1_1 = Builder_FullBright ? white : adv_lerpY[aX1_Z1];
-	PackedCol col1_0 = Builder_FullBright ? white : adv_lerpY[aX1_Z0], col0_0 = Builder_FullBright ? white : adv_lerpY[aX0_Z0];
+	PackedCol col0_1 = ctx->fullBright ? white : ctx->lerpY[aX0_Z1], col1_1 = ctx->fullBright ? white : ctx->lerpY[aX1_Z1];
+	PackedCol col1_0 = ctx->fullBright ? white : ctx->lerpY[aX1_Z0], col0_0 = ctx->fullBright ? white : ctx->lerpY[aX0_Z0];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMIN];
-	v.y = adv_y1;
+	v.y = ctx->y1;
 	if (aX0_Z1 + aX1_Z0 > aX0_Z0 + aX1_Z1) {
-		v.x = adv_x2 + (count - 1); v.z = adv_z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1); v.z = ctx->z2; v.U = u2; v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x1;               v.z = ctx->z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.z = ctx->z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_YMIN] = vertices;
 }
 
-static void Adv_DrawYMax(int count) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Adv_DrawYMax(struct BuilderContext* ctx, int count) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
-	int F = adv_bitFlags[Builder_ChunkIndex];
+	int F = ctx->bitFlags[ctx->chunkIndex];
 	int aX0_Z0 = Adv_CountBits(F, xM1_yP1_zM1, xM1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
 	int aX1_Z0 = Adv_CountBits(F, xP1_yP1_zM1, xP1_yP1_zCC, xCC_yP1_zM1, xCC_yP1_zCC);
 	int aX0_Z1 = Adv_CountBits(F, xM1_yP1_zP1, xM1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 	int aX1_Z1 = Adv_CountBits(F, xP1_yP1_zP1, xP1_yP1_zCC, xCC_yP1_zP1, xCC_yP1_zCC);
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	PackedCol col0_0 = Builder_FullBright ? white : adv_lerp[aX0_Z0], col1_0 = Builder_FullBright ? white : adv_lerp[aX1_Z0];
-	PackedCol col1_1 = Builder_FullBright ? white : adv_lerp[aX1_Z1], col0_1 = Builder_FullBright ? white : adv_lerp[aX0_Z1];
+	PackedCol col0_0 = ctx->fullBright ? white : ctx->lerp[aX0_Z0], col1_0 = ctx->fullBright ? white : ctx->lerp[aX1_Z0];
+	PackedCol col1_1 = ctx->fullBright ? white : ctx->lerp[aX1_Z1], col0_1 = ctx->fullBright ? white : ctx->lerp[aX0_Z1];
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMAX];
-	v.y = adv_y2;
+	v.y = ctx->y2;
 	if (aX0_Z0 + aX1_Z1 > aX0_Z1 + aX1_Z0) {
-		v.x = adv_x2 + (count - 1); v.z = adv_z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1); v.z = ctx->z1; v.U = u2; v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x1;                             v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
 	} else {
-		v.x = adv_x1;               v.z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+		v.x = ctx->x1;               v.z = ctx->z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.z = ctx->z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	}
 	part->faces.vertices[FACE_YMAX] = vertices;
 }
 
-static void Adv_RenderBlock(int index, int x, int y, int z) {
+static void Adv_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
 	Vec3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.Brightness[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_tinted     = Blocks.Tinted[Builder_Block];
+	ctx->fullBright = Blocks.Brightness[ctx->block];
+	ctx->baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	ctx->tinted     = Blocks.Tinted[ctx->block];
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = x + min.x; adv_y1 = y + min.y; adv_z1 = z + min.z;
-	adv_x2 = x + max.x; adv_y2 = y + max.y; adv_z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->x1 = x + min.x; ctx->y1 = y + min.y; ctx->z1 = z + min.z;
+	ctx->x2 = x + max.x; ctx->y2 = y + max.y; ctx->z2 = z + max.z;
 
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.y = 1.0f - adv_minBB.y; adv_maxBB.y = 1.0f - adv_maxBB.y;
+	ctx->minBB = Blocks.MinBB[ctx->block]; ctx->maxBB = Blocks.MaxBB[ctx->block];
+	ctx->minBB.y = 1.0f - ctx->minBB.y; ctx->maxBB.y = 1.0f - ctx->maxBB.y;
 
-	if (count_XMin) Adv_DrawXMin(count_XMin);
-	if (count_XMax) Adv_DrawXMax(count_XMax);
-	if (count_ZMin) Adv_DrawZMin(count_ZMin);
-	if (count_ZMax) Adv_DrawZMax(count_ZMax);
-	if (count_YMin) Adv_DrawYMin(count_YMin);
-	if (count_YMax) Adv_DrawYMax(count_YMax);
+	if (count_XMin) Adv_DrawXMin(ctx, count_XMin);
+	if (count_XMax) Adv_DrawXMax(ctx, count_XMax);
+	if (count_ZMin) Adv_DrawZMin(ctx, count_ZMin);
+	if (count_ZMax) Adv_DrawZMax(ctx, count_ZMax);
+	if (count_YMin) Adv_DrawYMin(ctx, count_YMin);
+	if (count_YMax) Adv_DrawYMax(ctx, count_YMax);
 }
 
-static void Adv_PrePrepareChunk(void) {
+static void Adv_PrePrepareChunk(struct BuilderContext* ctx) {
 	int i;
-	DefaultPrePrepateChunk();
-	adv_bitFlags = Builder_BitFlags;
+	DefaultPrePrepateChunk(ctx);
 
 	for (i = 0; i <= 4; i++) {
-		adv_lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
-		adv_lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
-		adv_lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
-		adv_lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
+		ctx->lerp[i]  = PackedCol_Lerp(Env.ShadowCol,   Env.SunCol,   i / 4.0f);
+		ctx->lerpX[i] = PackedCol_Lerp(Env.ShadowXSide, Env.SunXSide, i / 4.0f);
+		ctx->lerpZ[i] = PackedCol_Lerp(Env.ShadowZSide, Env.SunZSide, i / 4.0f);
+		ctx->lerpY[i] = PackedCol_Lerp(Env.ShadowYMin,  Env.SunYMin,  i / 4.0f);
 	}
 }
 
@@ -1294,26 +1662,26 @@ static cc_bool Modern_IsOccluded(int x, int y, int z) {
 	return false;
 }
 
-static cc_bool Modern_CanStretch(BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
+static cc_bool Modern_CanStretch(struct BuilderContext* ctx, BlockID initial, int chunkIndex, int x, int y, int z, Face face) {
 	return false;
 }
 
-static int Modern_StretchXLiquid(int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
+static int Modern_StretchXLiquid(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block) {
 	int count = 1;
-	if (Builder_OccludedLiquid(chunkIndex)) return 0;
-	AddVertices(block, FACE_YMAX);
+	if (Builder_OccludedLiquid(ctx, chunkIndex)) return 0;
+	AddVertices(ctx, block, FACE_YMAX);
 	return count;
 }
 
-static int Modern_StretchX(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Modern_StretchX(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1;
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
-static int Modern_StretchZ(int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
+static int Modern_StretchZ(struct BuilderContext* ctx, int countIndex, int x, int y, int z, int chunkIndex, BlockID block, Face face) {
 	int count = 1;
-	AddVertices(block, face);
+	AddVertices(ctx, block, face);
 	return count;
 }
 
@@ -1330,69 +1698,69 @@ static PackedCol Modern_GetColorX(PackedCol orig, int x, int y, int z, int oY, i
 	PackedCol cd = AVERAGE(CoXoZ, orig);
 	return AVERAGE(ab, cd);
 }
-static void Modern_DrawXMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMIN);
+static void Modern_DrawXMin(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.z, u2 = (count - 1) + adv_maxBB.z * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.z, u2 = (count - 1) + ctx->maxBB.z * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_XMIN) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_XMIN) & 1;
 	PackedCol orig = Lighting.Color_XSide_Fast(x-offset, y, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, 1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorX(orig, x-offset, y, z, 1, 1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorX(orig, x-offset, y, z, -1, 1);
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMIN];
-	v.x = adv_x1;
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
-		              v.z = adv_z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
+	v.x = ctx->x1;
+		v.y = ctx->y2; v.z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		              v.z = ctx->z1;               v.U = u1;           v.Col = col1_0; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_0; *vertices++ = v;
+		              v.z = ctx->z2 + (count - 1); v.U = u2;           v.Col = col0_1; *vertices++ = v;
 	part->faces.vertices[FACE_XMIN] = vertices;
 }
 
-static void Modern_DrawXMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_XMAX);
+static void Modern_DrawXMax(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_XMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.z), u2 = (1 - adv_maxBB.z) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.z), u2 = (1 - ctx->maxBB.z) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_XMAX) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_XMAX) & 1;
 	PackedCol orig = Lighting.Color_XSide_Fast(x+offset, y, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, 1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorX(orig, x+offset, y, z, 1, 1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorX(orig, x+offset, y, z, -1, 1);
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_XMAX];
-	v.x = adv_x2;
-		v.y = adv_y2; v.z = adv_z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.y = adv_y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
-		              v.z = adv_z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
-		v.y = adv_y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
+	v.x = ctx->x2;
+		v.y = ctx->y2; v.z = ctx->z2 + (count - 1); v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.y = ctx->y1;                                       v.V = v2; v.Col = col0_1; *vertices++ = v;
+		              v.z = ctx->z1;               v.U = u1;           v.Col = col0_0; *vertices++ = v;
+		v.y = ctx->y2;                                       v.V = v1; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_XMAX] = vertices;
 }
 
@@ -1409,69 +1777,69 @@ static PackedCol Modern_GetColorZ(PackedCol orig, int x, int y, int z, int oX, i
 	PackedCol cd = AVERAGE(CoXoZ, orig);
 	return AVERAGE(ab, cd);
 }
-static void Modern_DrawZMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMIN);
+static void Modern_DrawZMin(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = (count - adv_minBB.x), u2 = (1 - adv_maxBB.x) * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = (count - ctx->minBB.x), u2 = (1 - ctx->maxBB.x) * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_ZMIN) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_ZMIN) & 1;
 	PackedCol orig = Lighting.Color_ZSide_Fast(x, y, z-offset);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, 1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, 1, 1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z-offset, -1, 1);
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMIN];
-	v.z = adv_z1;
-		v.x = adv_x1;               v.y = adv_y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
-		                            v.y = adv_y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
+	v.z = ctx->z1;
+		v.x = ctx->x1;               v.y = ctx->y1; v.U = u1; v.V = v2; v.Col = col0_0; *vertices++ = v;
+		                            v.y = ctx->y2;           v.V = v1; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.y = ctx->y1;           v.V = v2; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_ZMIN] = vertices;
 }
 
-static void Modern_DrawZMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_ZMAX);
+static void Modern_DrawZMax(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_ZMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_maxBB.y * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_minBB.y * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->maxBB.y * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->minBB.y * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_ZMAX) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_ZMAX) & 1;
 	PackedCol orig = Lighting.Color_ZSide_Fast(x, y, z+offset);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, 1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, 1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, 1, 1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorZ(orig, x, y, z+offset, -1, 1);
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_ZMAX];
-	v.z = adv_z2;
-		v.x = adv_x2 + (count - 1); v.y = adv_y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
-		v.x = adv_x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
-		                            v.y = adv_y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+	v.z = ctx->z2;
+		v.x = ctx->x2 + (count - 1); v.y = ctx->y2; v.U = u2; v.V = v1; v.Col = col1_1; *vertices++ = v;
+		v.x = ctx->x1;                             v.U = u1;           v.Col = col0_1; *vertices++ = v;
+		                            v.y = ctx->y1;           v.V = v2; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_ZMAX] = vertices;
 }
 
@@ -1488,36 +1856,36 @@ static PackedCol Modern_GetColorYMin(PackedCol orig, int x, int y, int z, int oX
 	PackedCol cd = AVERAGE(CoXoZ, orig);
 	return AVERAGE(ab, cd);
 }
-static void Modern_DrawYMin(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMIN);
+static void Modern_DrawYMin(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMIN);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_YMIN) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_YMIN) & 1;
 	PackedCol orig = Lighting.Color_YMin_Fast(x, y-offset, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1,  1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1,  1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z,  1,  1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorYMin(orig, x, y-offset, z, -1,  1);
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMIN];
-	v.y = adv_y1;
-		v.x = adv_x1;               v.z = adv_z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
+	v.y = ctx->y1;
+		v.x = ctx->x1;               v.z = ctx->z2; v.U = u1; v.V = v2; v.Col = col0_1; *vertices++ = v;
+		                            v.z = ctx->z1;           v.V = v1; v.Col = col0_0; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_0; *vertices++ = v;
+		                            v.z = ctx->z2;           v.V = v2; v.Col = col1_1; *vertices++ = v;
 	part->faces.vertices[FACE_YMIN] = vertices;
 }
 
@@ -1534,81 +1902,76 @@ static PackedCol Modern_GetColorYMax(PackedCol orig, int x, int y, int z, int oX
 	PackedCol cd = AVERAGE(CoXoZ, orig);
 	return AVERAGE(ab, cd);
 }
-static void Modern_DrawYMax(int count, int x, int y, int z) {
-	TextureLoc texLoc = Block_Tex(Builder_Block, FACE_YMAX);
+static void Modern_DrawYMax(struct BuilderContext* ctx, int count, int x, int y, int z) {
+	TextureLoc texLoc = Block_Tex(ctx->block, FACE_YMAX);
 	float vOrigin = Atlas1D_RowId(texLoc) * Atlas1D.InvTileSize;
 
-	float u1 = adv_minBB.x, u2 = (count - 1) + adv_maxBB.x * UV2_Scale;
-	float v1 = vOrigin + adv_minBB.z * Atlas1D.InvTileSize;
-	float v2 = vOrigin + adv_maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
-	struct Builder1DPart* part = &Builder_Parts[adv_baseOffset + Atlas1D_Index(texLoc)];
+	float u1 = ctx->minBB.x, u2 = (count - 1) + ctx->maxBB.x * UV2_Scale;
+	float v1 = vOrigin + ctx->minBB.z * Atlas1D.InvTileSize;
+	float v2 = vOrigin + ctx->maxBB.z * Atlas1D.InvTileSize * UV2_Scale;
+	struct Builder1DPart* part = &ctx->parts[ctx->baseOffset + Atlas1D_Index(texLoc)];
 
 	PackedCol tint, white = PACKEDCOL_WHITE;
-	int offset = 1;// (Blocks.LightOffset[Builder_Block] >> FACE_YMAX) & 1;
+	int offset = 1;// (Blocks.LightOffset[ctx->block] >> FACE_YMAX) & 1;
 	PackedCol orig = Lighting.Color(x, y+offset, z);
-	PackedCol col0_0 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1, -1);
-	PackedCol col1_0 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1, -1);
-	PackedCol col1_1 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1,  1);
-	PackedCol col0_1 = Builder_FullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1,  1);
+	PackedCol col0_0 = ctx->fullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1, -1);
+	PackedCol col1_0 = ctx->fullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1, -1);
+	PackedCol col1_1 = ctx->fullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z,  1,  1);
+	PackedCol col0_1 = ctx->fullBright ? white : Modern_GetColorYMax(orig, x, y+offset, z, -1,  1);
 
 	struct VertexTextured* vertices, v;
 
-	if (adv_tinted) {
-		tint   = Blocks.FogCol[Builder_Block];
+	if (ctx->tinted) {
+		tint   = Blocks.FogCol[ctx->block];
 		col0_0 = PackedCol_Tint(col0_0, tint); col1_0 = PackedCol_Tint(col1_0, tint);
 		col1_1 = PackedCol_Tint(col1_1, tint); col0_1 = PackedCol_Tint(col0_1, tint);
 	}
 
 	vertices = part->faces.vertices[FACE_YMAX];
-	v.y = adv_y2;
-		v.x = adv_x1;               v.z = adv_z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
-		                            v.z = adv_z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
-		v.x = adv_x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
-		                            v.z = adv_z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
+	v.y = ctx->y2;
+		v.x = ctx->x1;               v.z = ctx->z1; v.U = u1; v.V = v1; v.Col = col0_0; *vertices++ = v;
+		                            v.z = ctx->z2;           v.V = v2; v.Col = col0_1; *vertices++ = v;
+		v.x = ctx->x2 + (count - 1);               v.U = u2;           v.Col = col1_1; *vertices++ = v;
+		                            v.z = ctx->z1;           v.V = v1; v.Col = col1_0; *vertices++ = v;
 	part->faces.vertices[FACE_YMAX] = vertices;
 }
 
-static void Modern_RenderBlock(int index, int x, int y, int z) {
+static void Modern_RenderBlock(struct BuilderContext* ctx, int index, int x, int y, int z) {
 	Vec3 min, max;
 	int count_XMin, count_XMax, count_ZMin;
 	int count_ZMax, count_YMin, count_YMax;
 
-	if (Blocks.Draw[Builder_Block] == DRAW_SPRITE) {
-		Builder_DrawSprite(x, y, z); return;
+	if (Blocks.Draw[ctx->block] == DRAW_SPRITE) {
+		Builder_DrawSprite(ctx, x, y, z); return;
 	}
 
-	count_XMin = Builder_Counts[index + FACE_XMIN];
-	count_XMax = Builder_Counts[index + FACE_XMAX];
-	count_ZMin = Builder_Counts[index + FACE_ZMIN];
-	count_ZMax = Builder_Counts[index + FACE_ZMAX];
-	count_YMin = Builder_Counts[index + FACE_YMIN];
-	count_YMax = Builder_Counts[index + FACE_YMAX];
+	count_XMin = ctx->counts[index + FACE_XMIN];
+	count_XMax = ctx->counts[index + FACE_XMAX];
+	count_ZMin = ctx->counts[index + FACE_ZMIN];
+	count_ZMax = ctx->counts[index + FACE_ZMAX];
+	count_YMin = ctx->counts[index + FACE_YMIN];
+	count_YMax = ctx->counts[index + FACE_YMAX];
 
 	if (!count_XMin && !count_XMax && !count_ZMin &&
 		!count_ZMax && !count_YMin && !count_YMax) return;
 
-	Builder_FullBright = Blocks.Brightness[Builder_Block];
-	adv_baseOffset = (Blocks.Draw[Builder_Block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
-	adv_tinted = Blocks.Tinted[Builder_Block];
+	ctx->fullBright = Blocks.Brightness[ctx->block];
+	ctx->baseOffset = (Blocks.Draw[ctx->block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+	ctx->tinted = Blocks.Tinted[ctx->block];
 
-	min = Blocks.RenderMinBB[Builder_Block]; max = Blocks.RenderMaxBB[Builder_Block];
-	adv_x1 = x + min.x; adv_y1 = y + min.y; adv_z1 = z + min.z;
-	adv_x2 = x + max.x; adv_y2 = y + max.y; adv_z2 = z + max.z;
+	min = Blocks.RenderMinBB[ctx->block]; max = Blocks.RenderMaxBB[ctx->block];
+	ctx->x1 = x + min.x; ctx->y1 = y + min.y; ctx->z1 = z + min.z;
+	ctx->x2 = x + max.x; ctx->y2 = y + max.y; ctx->z2 = z + max.z;
 
-	adv_minBB = Blocks.MinBB[Builder_Block]; adv_maxBB = Blocks.MaxBB[Builder_Block];
-	adv_minBB.y = 1.0f - adv_minBB.y; adv_maxBB.y = 1.0f - adv_maxBB.y;
-
-	if (count_XMin) Modern_DrawXMin(count_XMin, x, y, z);
-	if (count_XMax) Modern_DrawXMax(count_XMax, x, y, z);
-	if (count_ZMin) Modern_DrawZMin(count_ZMin, x, y, z);
-	if (count_ZMax) Modern_DrawZMax(count_ZMax, x, y, z);
-	if (count_YMin) Modern_DrawYMin(count_YMin, x, y, z);
-	if (count_YMax) Modern_DrawYMax(count_YMax, x, y, z);
-}
+	ctx->minBB = Blocks.MinBB[ctx->block]; ctx->maxBB = Blocks.MaxBB[ctx->block];
+	ctx->minBB.y = 1.0f - ctx->minBB.y; ctx->maxBB.y = 1.0f - ctx->maxBB.y;
 
-static void Modern_PrePrepareChunk(void) {
-	DefaultPrePrepateChunk();
-	adv_bitFlags = Builder_BitFlags;
+	if (count_XMin) Modern_DrawXMin(ctx, count_XMin, x, y, z);
+	if (count_XMax) Modern_DrawXMax(ctx, count_XMax, x, y, z);
+	if (count_ZMin) Modern_DrawZMin(ctx, count_ZMin, x, y, z);
+	if (count_ZMax) Modern_DrawZMax(ctx, count_ZMax, x, y, z);
+	if (count_YMin) Modern_DrawYMin(ctx, count_YMin, x, y, z);
+	if (count_YMax) Modern_DrawYMax(ctx, count_YMax, x, y, z);
 }
 
 static void ModernBuilder_SetActive(void) {
@@ -1617,12 +1980,863 @@ static void ModernBuilder_SetActive(void) {
 	Builder_StretchX =        Modern_StretchX;
 	Builder_StretchZ =        Modern_StretchZ;
 	Builder_RenderBlock =     Modern_RenderBlock;
-	Builder_PrePrepareChunk = Modern_PrePrepareChunk;
 }
 #else
 static void ModernBuilder_SetActive(void) { NormalBuilder_SetActive(); }
 #endif
 
+/*########################################################################################################################*
+*------------------------------------------------Distant terrain mesh builder---------------------------------------------*
+*#########################################################################################################################*/
+/* Far away chunks are instead built from cells of 2x2x2 (LOD level 1) or 4x4x4 (LOD level 2) blocks, */
+/*  with each cell drawn as a single cuboid using the topmost block in the cell. */
+/* NOTE: Cells just outside the chunk are only 1 block thick, since that's all the context has read */
+#define Lod_CellStart(c, size) ((c) < 0 ? -1 : (c) * (size))
+#define Lod_CellEnd(c, size, cells) ((c) < 0 ? -1 : ((c) >= (cells) ? CHUNK_SIZE : (c) * (size) + (size) - 1))
+
+/* Returns the topmost block in the given region of the chunk, or BLOCK_AIR if the region is mostly empty */
+static BlockID Lod_CellBlock(struct BuilderContext* ctx, int x1, int y1, int z1, int x2, int y2, int z2) {
+	int x, y, z, filled = 0, total = 0;
+	BlockID block, top = BLOCK_AIR;
+
+	for (y = y2; y >= y1; y--)
+		for (z = z1; z <= z2; z++)
+			for (x = x1; x <= x2; x++)
+	{
+		block = ctx->chunk[Builder_PackChunk(x, y, z)];
+		total++;
+		/* Sprites are far too small to be seen from far away */
+		if (Blocks.Draw[block] == DRAW_GAS || Blocks.Draw[block] == DRAW_SPRITE) continue;
+
+		if (!filled) top = block;
+		filled++;
+	}
+	return filled * 2 >= total ? top : BLOCK_AIR;
+}
+
+/* Whether the given face of a cell is hidden by the neighbouring cell (or by the map sides) */
+static cc_bool Lod_FaceHidden(struct BuilderContext* ctx, BlockID block, int index, int wx, int wy, int wz, int size, Face face) {
+	BlockID other = ctx->lodCells[index];
+
+	switch (face) {
+	case FACE_XMIN:
+		if (wx == 0) return wy < Builder_SidesLevel;
+		break;
+	case FACE_XMAX:
+		if (wx + size > World.MaxX) return wy < Builder_SidesLevel;
+		break;
+	case FACE_ZMIN:
+		if (wz == 0) return wy < Builder_SidesLevel;
+		break;
+	case FACE_ZMAX:
+		if (wz + size > World.MaxZ) return wy < Builder_SidesLevel;
+		break;
+	case FACE_YMIN:
+		if (wy == 0) return true;
+		break;
+	}
+	return Block_IsFaceHidden(block, other, face);
+}
+
+/* Calculates which faces of each cell are visible, and how many vertices are needed for them */
+static void Lod_StretchChunk(struct BuilderContext* ctx, int x1, int y1, int z1, int level) {
+	int size  = 1 << level;
+	int cells = CHUNK_SIZE >> level;
+	int cx, cy, cz, wx, wy, wz, index;
+	int offsets[FACE_COUNT];
+	BlockID block;
+	Face face;
+	int flags;
+
+	offsets[FACE_XMIN] = -1; offsets[FACE_XMAX] = 1;
+	offsets[FACE_ZMIN] = -LOD_EXTCELLS; offsets[FACE_ZMAX] = LOD_EXTCELLS;
+	offsets[FACE_YMIN] = -LOD_EXTCELLS * LOD_EXTCELLS; offsets[FACE_YMAX] = LOD_EXTCELLS * LOD_EXTCELLS;
+
+	for (cy = -1; cy <= cells; cy++)
+		for (cz = -1; cz <= cells; cz++)
+			for (cx = -1; cx <= cells; cx++)
+	{
+		ctx->lodCells[Lod_PackCell(cx, cy, cz)] = Lod_CellBlock(ctx,
+			Lod_CellStart(cx, size), Lod_CellStart(cy, size), Lod_CellStart(cz, size),
+			Lod_CellEnd(cx, size, cells), Lod_CellEnd(cy, size, cells), Lod_CellEnd(cz, size, cells));
+	}
+
+	for (cy = 0; cy < cells; cy++)
+		for (cz = 0; cz < cells; cz++)
+			for (cx = 0; cx < cells; cx++)
+	{
+		index = Lod_PackCell(cx, cy, cz);
+		block = ctx->lodCells[index];
+		ctx->lodFaces[index] = 0;
+		if (Blocks.Draw[block] == DRAW_GAS) continue;
+
+		wx = x1 + cx * size; wy = y1 + cy * size; wz = z1 + cz * size;
+		flags = 0;
+
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			if (Lod_FaceHidden(ctx, block, index + offsets[face], wx, wy, wz, size, face)) continue;
+			flags |= 1 << face;
+			AddVertices(ctx, block, face);
+		}
+		ctx->lodFaces[index] = flags;
+	}
+}
+
+static PackedCol Lod_LightColor(int wx, int wy, int wz, int size, Face face) {
+	/* Sides are lit by the top blocks of the cell, since that's what's usually in sunlight */
+	int top = wy + size - 1;
+
+	switch (face) {
+	case FACE_XMIN:
+		return wx <= 0                   ? Env.SunXSide : Lighting.Color_XSide_Fast(wx - 1, top, wz);
+	case FACE_XMAX:
+		return wx + size > World.MaxX    ? Env.SunXSide : Lighting.Color_XSide_Fast(wx + size, top, wz);
+	case FACE_ZMIN:
+		return wz <= 0                   ? Env.SunZSide : Lighting.Color_ZSide_Fast(wx, top, wz - 1);
+	case FACE_ZMAX:
+		return wz + size > World.MaxZ    ? Env.SunZSide : Lighting.Color_ZSide_Fast(wx, top, wz + size);
+
+	case FACE_YMIN:
+		return Lighting.Color_YMin_Fast(wx, wy - 1, wz);
+	case FACE_YMAX:
+		return Lighting.Color_YMax_Fast(wx, wy + size, wz);
+	}
+	return 0; /* should never happen */
+}
+
+/* Outputs the vertices of the visible faces of every cell into ctx->vertices */
+static void Lod_RenderChunk(struct BuilderContext* ctx, int x1, int y1, int z1, int level) {
+	int size  = 1 << level;
+	int cells = CHUNK_SIZE >> level;
+	int cx, cy, cz, wx, wy, wz, index, flags, baseOffset;
+	struct Builder1DPart* part;
+	TextureLoc loc;
+	PackedCol col;
+	BlockID block;
+	Face face;
+	DefaultPostStretchChunk(ctx);
+
+	/* The texture of the block is stretched over the entire face of the cell */
+	ctx->drawer.MinBB.x = 0.0f; ctx->drawer.MinBB.y = 1.0f; ctx->drawer.MinBB.z = 0.0f;
+	ctx->drawer.MaxBB.x = 1.0f; ctx->drawer.MaxBB.y = 0.0f; ctx->drawer.MaxBB.z = 1.0f;
+
+	for (cy = 0; cy < cells; cy++)
+		for (cz = 0; cz < cells; cz++)
+			for (cx = 0; cx < cells; cx++)
+	{
+		index = Lod_PackCell(cx, cy, cz);
+		flags = ctx->lodFaces[index];
+		if (!flags) continue;
+
+		block = ctx->lodCells[index];
+		baseOffset = (Blocks.Draw[block] == DRAW_TRANSLUCENT) * ATLAS1D_MAX_ATLASES;
+		wx = x1 + cx * size; wy = y1 + cy * size; wz = z1 + cz * size;
+
+		ctx->drawer.X1 = (float)wx; ctx->drawer.X2 = (float)(wx + size);
+		ctx->drawer.Y1 = (float)wy; ctx->drawer.Y2 = (float)(wy + size);
+		ctx->drawer.Z1 = (float)wz; ctx->drawer.Z2 = (float)(wz + size);
+		ctx->drawer.Tinted  = Blocks.Tinted[block];
+		ctx->drawer.TintCol = Blocks.FogCol[block];
+
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			if (!(flags & (1 << face))) continue;
+			loc  = Block_Tex(block, face);
+			part = &ctx->parts[baseOffset + Atlas1D_Index(loc)];
+			col  = Blocks.Brightness[block] ? PACKEDCOL_WHITE : Lod_LightColor(wx, wy, wz, size, face);
+
+			switch (face) {
+			case FACE_XMIN:
+				DrawerData_XMin(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			case FACE_XMAX:
+				DrawerData_XMax(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			case FACE_ZMIN:
+				DrawerData_ZMin(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			case FACE_ZMAX:
+				DrawerData_ZMax(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			case FACE_YMIN:
+				DrawerData_YMin(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			case FACE_YMAX:
+				DrawerData_YMax(&ctx->drawer, 1, col, loc, &part->faces.vertices[face]); break;
+			}
+		}
+	}
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Incremental remeshing---------------------------------------------------*
+*#########################################################################################################################*/
+/* Max number of recently changed chunks whose meshes are kept in memory */
+#define BUILDER_MAX_RETAINED 8
+
+/* Copy of the mesh of a chunk, so that only the y slices which changed need to be rebuilt */
+/*  (the vertex buffer on the GPU can't be read back, so a copy must be kept in memory) */
+struct RetainedMesh {
+	struct ChunkInfo* info;
+	struct VertexTextured* vertices;
+	int verticesCount, partsCount;
+	cc_uint32 lastUsed;
+	struct MeshSlices* slices;
+};
+static struct RetainedMesh retainedMeshes[BUILDER_MAX_RETAINED];
+static cc_uint32 retainedTicks;
+
+static void RetainedMesh_Free(struct RetainedMesh* mesh) {
+	Mem_Free(mesh->vertices);
+	Mem_Free(mesh->slices);
+	Mem_Set(mesh, 0, sizeof(struct RetainedMesh));
+}
+
+static struct RetainedMesh* FindRetainedMesh(struct ChunkInfo* info) {
+	int i;
+	for (i = 0; i < BUILDER_MAX_RETAINED; i++) 
+	{
+		if (retainedMeshes[i].info == info) return &retainedMeshes[i];
+	}
+	return NULL;
+}
+
+static void ForgetRetainedMesh(struct ChunkInfo* info) {
+	struct RetainedMesh* mesh = FindRetainedMesh(info);
+	if (mesh) RetainedMesh_Free(mesh);
+}
+
+static void FreeRetainedMeshes(void) {
+	int i;
+	for (i = 0; i < BUILDER_MAX_RETAINED; i++) 
+	{
+		RetainedMesh_Free(&retainedMeshes[i]);
+	}
+}
+
+/* Returns an unused entry, or otherwise frees the least recently used entry */
+static struct RetainedMesh* AllocRetainedMesh(void) {
+	struct RetainedMesh* mesh = &retainedMeshes[0];
+	int i;
+
+	for (i = 0; i < BUILDER_MAX_RETAINED; i++) 
+	{
+		if (!retainedMeshes[i].info) { mesh = &retainedMeshes[i]; break; }
+		if (retainedMeshes[i].lastUsed < mesh->lastUsed) mesh = &retainedMeshes[i];
+	}
+	RetainedMesh_Free(mesh);
+	return mesh;
+}
+
+/* Whether a change to blocks only affects the faces of blocks in the adjacent y slices */
+static cc_bool CanRebuildSlices(void) {
+	/* Fancy lighting can change the light of blocks far away from the changed block */
+	/*  and greedy meshing merges faces from different y slices together */
+	return Lighting_Mode == LIGHTING_MODE_CLASSIC && !Builder_UseTileWrap();
+}
+
+/* Sums the number of vertices in the y slices from 'beg' up to (but excluding) 'end' */
+static int SumSlices(const cc_uint16* counts, int beg, int end) {
+	int yy, sum = 0;
+	for (yy = beg; yy < end; yy++) sum += counts[yy];
+	return sum;
+}
+
+/* Sets the vertex counts of each part from the slice counts of the retained mesh */
+static void SetPartCounts(struct BuilderContext* ctx, struct RetainedMesh* mesh) {
+	struct Builder1DPart* part;
+	int i, face;
+	Mem_Set(ctx->parts, 0, sizeof(ctx->parts));
+
+	for (i = 0; i < mesh->partsCount; i++) 
+	{
+		part = Builder_SlicesPart(ctx, i);
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			part->faces.count[face] = SumSlices(mesh->slices[i].counts[face], 0, CHUNK_SIZE);
+		}
+		part->sCount = 4 * SumSlices(mesh->slices[i].counts[STREAM_SPRITES], 0, CHUNK_SIZE);
+	}
+}
+
+/* Fully builds the mesh of a chunk, while also keeping a copy of the mesh in memory */
+/* Returns false if there wasn't enough memory to keep a copy of the mesh */
+static cc_bool RetainChunk(struct BuilderContext* ctx, struct RetainedMesh* mesh, struct ChunkInfo* info) {
+	cc_bool allAir, allSolid;
+	int totalVerts, partsCount = MapRenderer_1DUsedCount * 2;
+	int x1 = info->centreX - 8, y1 = info->centreY - 8, z1 = info->centreZ - 8;
+	int* slicePos;
+	Builder_PrePrepareChunk(ctx);
+
+	allSolid     = ReadChunk(ctx, x1, y1, z1, &allAir);
+	info->allAir = allAir;
+	UpdateVisibility(ctx, info, allAir, allSolid);
+	if (allAir || allSolid) return true;
+	Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
+
+	StretchChunk(ctx, x1, y1, z1);
+	totalVerts = Builder_TotalVerticesCount(ctx);
+	if (!totalVerts) return true;
+
+	mesh->vertices = (struct VertexTextured*)Mem_TryAlloc(totalVerts, sizeof(struct VertexTextured));
+	mesh->slices   = (struct MeshSlices*)Mem_TryAllocCleared(partsCount, sizeof(struct MeshSlices));
+	slicePos       = (int*)Mem_TryAlloc(partsCount * MESH_STREAMS * 2, sizeof(int));
+
+	if (!mesh->vertices || !mesh->slices || !slicePos) {
+		RetainedMesh_Free(mesh);
+		Mem_Free(slicePos);
+		return false;
+	}
+
+	mesh->info          = info;
+	mesh->verticesCount = totalVerts;
+	mesh->partsCount    = partsCount;
+	mesh->lastUsed      = ++retainedTicks;
+	OutputChunkPartsMeta(ctx, x1, y1, z1, info);
+
+	ctx->vertices = mesh->vertices;
+	ctx->slices   = mesh->slices;
+	ctx->slicePos = slicePos;
+	RenderChunk(ctx, x1, y1, z1);
+
+	ctx->slices   = NULL;
+	ctx->slicePos = NULL;
+	Mem_Free(slicePos);
+
+	UploadVertices(info, mesh->vertices, totalVerts);
+	return true;
+}
+
+/* Copies the vertices of one face (or sprite section) of a part into the patched mesh */
+/*  (old vertices for unchanged slices, and the freshly built vertices for changed slices) */
+static struct VertexTextured* SpliceStream(struct VertexTextured* dst, const cc_uint16* oldCounts, const cc_uint16* newCounts,
+									struct VertexTextured** src, struct VertexTextured** fresh, int minYY, int maxYY) {
+	int before = SumSlices(oldCounts, 0, minYY);
+	int oldMid = SumSlices(oldCounts, minYY,     maxYY + 1);
+	int after  = SumSlices(oldCounts, maxYY + 1, CHUNK_SIZE);
+	int newMid = SumSlices(newCounts, minYY,     maxYY + 1);
+
+	Mem_Copy(dst, *src,                   before * sizeof(struct VertexTextured)); dst += before;
+	Mem_Copy(dst, *fresh,                 newMid * sizeof(struct VertexTextured)); dst += newMid;
+	Mem_Copy(dst, *src + before + oldMid, after  * sizeof(struct VertexTextured)); dst += after;
+
+	*src   += before + oldMid + after;
+	*fresh += newMid;
+	return dst;
+}
+
+static void SpliceSlices(struct RetainedMesh* mesh, struct MeshSlices* slices, struct VertexTextured* dst, 
+						struct VertexTextured* fresh, int minYY, int maxYY) {
+	struct VertexTextured* src = mesh->vertices;
+	cc_uint16* oldCounts;
+	cc_uint16* newCounts;
+	int i, j;
+
+	for (i = 0; i < mesh->partsCount; i++) 
+	{
+		/* Sprites are stored first, as 4 sections which each have the same number of vertices */
+		oldCounts = mesh->slices[i].counts[STREAM_SPRITES];
+		newCounts = slices[i].counts[STREAM_SPRITES];
+		for (j = 0; j < 4; j++) 
+		{
+			dst = SpliceStream(dst, oldCounts, newCounts, &src, &fresh, minYY, maxYY);
+		}
+
+		for (j = 0; j < FACE_COUNT; j++) 
+		{
+			oldCounts = mesh->slices[i].counts[j];
+			newCounts = slices[i].counts[j];
+			dst = SpliceStream(dst, oldCounts, newCounts, &src, &fresh, minYY, maxYY);
+		}
+	}
+}
+
+/* Rebuilds only the dirty y slices of the chunk, then patches them into the retained mesh */
+/* Returns false if the mesh couldn't be patched (in which case the mesh is unchanged) */
+static cc_bool PatchSlices(struct BuilderContext* ctx, struct RetainedMesh* mesh, struct ChunkInfo* info) {
+	cc_bool allAir, allSolid;
+	int freshVerts, totalVerts, i, j, yy;
+	int x1 = info->centreX - 8, y1 = info->centreY - 8, z1 = info->centreZ - 8;
+	int minYY, maxYY, partsCount = mesh->partsCount;
+	struct VertexTextured* fresh;
+	struct VertexTextured* patched;
+	struct MeshSlices* slices;
+	int* slicePos;
+	Builder_PrePrepareChunk(ctx);
+
+	allSolid = ReadChunk(ctx, x1, y1, z1, &allAir);
+	if (allAir || allSolid) return false;
+	UpdateVisibility(ctx, info, allAir, allSolid);
+	Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
+
+	ctx->chunkEndX = min(World.Width,  x1 + CHUNK_SIZE);
+	ctx->chunkEndY = min(World.Height, y1 + CHUNK_SIZE);
+	ctx->chunkEndZ = min(World.Length, z1 + CHUNK_SIZE);
+
+	minYY = info->dirtyMinY;
+	maxYY = min(info->dirtyMaxY, ctx->chunkEndY - y1 - 1);
+	minYY = min(minYY, maxYY + 1);
+
+	Mem_Set(ctx->counts + Builder_PackCount(0, minYY, 0), 1, (maxYY - minYY + 1) * CHUNK_SIZE_2 * FACE_COUNT);
+	PrepareChunk(ctx, x1, y1, z1, minYY, maxYY);
+	freshVerts = Builder_TotalVerticesCount(ctx);
+
+	/* add an extra element, since freshVerts may be 0 */
+	fresh    = (struct VertexTextured*)Mem_TryAlloc(freshVerts + 1, sizeof(struct VertexTextured));
+	slices   = (struct MeshSlices*)Mem_TryAllocCleared(partsCount, sizeof(struct MeshSlices));
+	slicePos = (int*)Mem_TryAlloc(partsCount * MESH_STREAMS * 2, sizeof(int));
+	patched  = NULL;
+
+	if (fresh && slices && slicePos) {
+		ctx->vertices = fresh;
+		ctx->slices   = slices;
+		ctx->slicePos = slicePos;
+		RenderSlices(ctx, x1, y1, z1, minYY, maxYY);
+
+		ctx->slices   = NULL;
+		ctx->slicePos = NULL;
+
+		totalVerts = mesh->verticesCount + freshVerts;
+		for (i = 0; i < partsCount; i++) 
+		{
+			for (j = 0; j < MESH_STREAMS; j++)
+			{
+				totalVerts -= SumSlices(mesh->slices[i].counts[j], minYY, maxYY + 1) * (j == STREAM_SPRITES ? 4 : 1);
+			}
+		}
+		patched = (struct VertexTextured*)Mem_TryAlloc(totalVerts + 1, sizeof(struct VertexTextured));
+	}
+
+	if (!patched) {
+		Mem_Free(fresh);
+		Mem_Free(slices);
+		Mem_Free(slicePos);
+		return false;
+	}
+	SpliceSlices(mesh, slices, patched, fresh, minYY, maxYY);
+
+	for (i = 0; i < partsCount; i++) 
+	{
+		for (j = 0; j < MESH_STREAMS; j++)
+		{
+			for (yy = minYY; yy <= maxYY; yy++) mesh->slices[i].counts[j][yy] = slices[i].counts[j][yy];
+		}
+	}
+	Mem_Free(fresh);
+	Mem_Free(slices);
+	Mem_Free(slicePos);
+
+	Mem_Free(mesh->vertices);
+	mesh->vertices      = patched;
+	mesh->verticesCount = totalVerts;
+	mesh->lastUsed      = ++retainedTicks;
+	info->allAir        = false;
+	if (!totalVerts) return true;
+
+	SetPartCounts(ctx, mesh);
+	OutputChunkPartsMeta(ctx, x1, y1, z1, info);
+	UploadVertices(info, patched, totalVerts);
+	return true;
+}
+
+/* Rebuilds the mesh of a chunk which only had some of its y slices change */
+static void RemeshChunk(struct BuilderContext* ctx, struct ChunkInfo* info) {
+	struct RetainedMesh* mesh = FindRetainedMesh(info);
+	struct BuilderJob job;
+
+	if (mesh && mesh->partsCount == MapRenderer_1DUsedCount * 2 && PatchSlices(ctx, mesh, info)) return;
+	if (mesh) RetainedMesh_Free(mesh);
+
+	/* The first time a chunk is changed, it must be fully built anyways */
+	mesh = AllocRetainedMesh();
+	if (RetainChunk(ctx, mesh, info)) return;
+
+	Mem_Set(&job, 0, sizeof(struct BuilderJob));
+	job.info = info;
+	BuildChunk(ctx, &job, true);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Builder worker threads------------------------------------------------*
+*#########################################################################################################################*/
+/* Max number of chunks that are built together in one batch */
+#define BUILDER_MAX_JOBS 64
+static struct BuilderJob builder_jobs[BUILDER_MAX_JOBS];
+
+/* Context and temp arrays for building chunk meshes separately from the main builder context */
+struct BuilderState {
+	struct BuilderContext ctx;
+	BlockID chunk[EXTCHUNK_SIZE_3];
+	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT];
+#ifdef CC_BUILD_ADVLIGHTING
+	int bitFlags[EXTCHUNK_SIZE_3];
+#else
+	int bitFlags[1];
+#endif
+};
+
+static void BuilderState_Init(struct BuilderState* state) {
+	state->ctx.chunk    = state->chunk;
+	state->ctx.counts   = state->counts;
+	state->ctx.bitFlags = state->bitFlags;
+}
+
+#ifndef CC_BUILD_COOPTHREADED
+struct BuilderWorker {
+	void* thread;
+	void* waitable;
+	int id;
+	struct BuilderState state;
+};
+
+static struct BuilderWorker* workers[BUILDER_MAX_WORKERS];
+int Builder_WorkersCount;
+static int workersStarted;
+static void* jobsMutex;
+static void* jobsDone;
+static volatile cc_bool workersStopping;
+/* State of the current batch of jobs (only accessed while jobsMutex is locked) */
+static Builder_JobFunc jobsFunc;
+static int jobsCount, jobsNext, jobsLeft;
+static cc_bool jobsLastByWorker;
+
+/* Runs unclaimed jobs in the current batch, until there are no unclaimed jobs left */
+static void RunJobs(int thread) {
+	Builder_JobFunc func;
+	int job;
+	cc_bool last;
+
+	for (;;) {
+		Mutex_Lock(jobsMutex);
+		job  = jobsNext < jobsCount ? jobsNext++ : -1;
+		func = jobsFunc;
+		Mutex_Unlock(jobsMutex);
+		if (job < 0) return;
+
+		func(job, thread);
+
+		Mutex_Lock(jobsMutex);
+		last = --jobsLeft == 0;
+		if (last) jobsLastByWorker = thread != 0;
+		Mutex_Unlock(jobsMutex);
+		if (last && thread != 0) Waitable_Signal(jobsDone);
+	}
+}
+
+static void WorkerLoop(void) {
+	struct BuilderWorker* worker;
+
+	Mutex_Lock(jobsMutex);
+	worker = workers[workersStarted++];
+	Mutex_Unlock(jobsMutex);
+
+	for (;;) {
+		Waitable_Wait(worker->waitable);
+		if (workersStopping) return;
+		RunJobs(worker->id);
+	}
+}
+
+static void StartWorkers(int count) {
+	struct BuilderWorker* worker;
+	int i;
+	jobsMutex = Mutex_Create("Builder jobs");
+	jobsDone  = Waitable_Create("Builder done");
+
+	for (i = 0; i < count; i++) 
+	{
+		worker = (struct BuilderWorker*)Mem_TryAllocCleared(1, sizeof(struct BuilderWorker));
+		if (!worker) break;
+
+		BuilderState_Init(&worker->state);
+		worker->waitable = Waitable_Create("Builder worker");
+		worker->id       = i + 1;
+		workers[i] = worker;
+	}
+	Builder_WorkersCount = i;
+
+	for (i = 0; i < Builder_WorkersCount; i++) 
+	{
+		Thread_Run(&workers[i]->thread, WorkerLoop, 64 * 1024, "Chunk builder");
+	}
+}
+
+static void StopWorkers(void) {
+	int i;
+	if (!jobsMutex) return;
+	workersStopping = true;
+
+	for (i = 0; i < Builder_WorkersCount; i++) 
+	{
+		Waitable_Signal(workers[i]->waitable);
+		Thread_Join(workers[i]->thread);
+		Waitable_Free(workers[i]->waitable);
+		Mem_Free(workers[i]);
+		workers[i] = NULL;
+	}
+
+	Mutex_Free(jobsMutex);
+	Waitable_Free(jobsDone);
+	jobsMutex = NULL;
+	Builder_WorkersCount = 0;
+}
+
+void Builder_RunJobs(int count, Builder_JobFunc func) {
+	cc_bool wait;
+	int i;
+
+	if (!Builder_WorkersCount || count <= 1) {
+		for (i = 0; i < count; i++) func(i, 0);
+		return;
+	}
+
+	Mutex_Lock(jobsMutex);
+	jobsFunc  = func;
+	jobsCount = count; jobsNext = 0; jobsLeft = count;
+	jobsLastByWorker = false;
+	Mutex_Unlock(jobsMutex);
+
+	for (i = 0; i < Builder_WorkersCount; i++) 
+	{
+		Waitable_Signal(workers[i]->waitable);
+	}
+	RunJobs(0);
+
+	/* Wait for worker threads to finish their last jobs */
+	Mutex_Lock(jobsMutex);
+	wait = jobsLeft > 0 || jobsLastByWorker;
+	jobsCount = 0;
+	Mutex_Unlock(jobsMutex);
+	if (wait) Waitable_Wait(jobsDone);
+}
+
+/* Context that jobs run on the main thread build chunks with */
+static struct BuilderContext* jobsMainCtx;
+
+static void BuildJob(int job, int thread) {
+	struct BuilderContext* ctx = thread ? &workers[thread - 1]->state.ctx : jobsMainCtx;
+	BuildChunk(ctx, &builder_jobs[job], thread == 0);
+}
+
+/* Builds the given jobs using the worker threads and the main thread */
+static void BuildJobsThreaded(struct BuilderContext* ctx, int count) {
+	IVec3 starts[BUILDER_MAX_JOBS];
+	int i;
+
+	/* Lighting state isn't thread safe, so needs to be calculated beforehand */
+	for (i = 0; i < count; i++) 
+	{
+		struct ChunkInfo* info = builder_jobs[i].info;
+		starts[i].x = info->centreX - 9; starts[i].y = info->centreY - 9; starts[i].z = info->centreZ - 9;
+		builder_jobs[i].lightHinted = true;
+	}
+	Lighting.LightHints(starts, count);
+
+	jobsMainCtx = ctx;
+	Builder_RunJobs(count, BuildJob);
+}
+#else
+static void StartWorkers(int count) { }
+static void StopWorkers(void) { }
+int Builder_WorkersCount;
+
+void Builder_RunJobs(int count, Builder_JobFunc func) {
+	int i;
+	for (i = 0; i < count; i++) func(i, 0);
+}
+static void BuildJobsThreaded(struct BuilderContext* ctx, int count) { }
+#endif
+
+static void BuildJobs(struct BuilderContext* ctx, int count) {
+	struct BuilderJob* job;
+	int i;
+
+	if (Builder_WorkersCount && count > 1) {
+		BuildJobsThreaded(ctx, count);
+	} else {
+		for (i = 0; i < count; i++) BuildChunk(ctx, &builder_jobs[i], true);
+		return;
+	}
+
+	for (i = 0; i < count; i++) 
+	{
+		job = &builder_jobs[i];
+		if (job->vertices) UploadChunk(job);
+
+		/* Not enough memory to build on worker thread, so try again on main thread */
+		if (job->failed) BuildChunk(ctx, job, true);
+	}
+}
+
+/* Whether the block counts of the chunk show it can't have any visible faces */
+/*  (so there's no need to read its blocks to build its mesh) */
+static cc_bool CanSkipChunk(struct ChunkInfo* info) {
+	int cx = info->centreX >> CHUNK_SHIFT;
+	int cy = info->centreY >> CHUNK_SHIFT;
+	int cz = info->centreZ >> CHUNK_SHIFT;
+
+	if (World_IsChunkAir(cx, cy, cz)) {
+		info->allAir   = true;
+		info->visFlags = CHUNK_VIS_ALL;
+		return true;
+	}
+
+	/* Faces of blocks on the map edges may still be visible */
+	if (cx == 0 || cy == 0 || cz == 0 || cx == World.ChunksX - 1 || 
+		cy == World.ChunksY - 1 || cz == World.ChunksZ - 1) return false;
+
+	/* A chunk completely filled with fully opaque blocks can't be seen through */
+	if (!World_IsChunkSolid(cx, cy, cz)) return false;
+	info->visFlags = 0;
+
+	/* Every face is hidden when all blocks in the adjacent chunks are also fully opaque */
+	return
+		World_IsChunkSolid(cx - 1, cy,     cz)     && World_IsChunkSolid(cx + 1, cy,     cz)     &&
+		World_IsChunkSolid(cx,     cy - 1, cz)     && World_IsChunkSolid(cx,     cy + 1, cz)     &&
+		World_IsChunkSolid(cx,     cy,     cz - 1) && World_IsChunkSolid(cx,     cy,     cz + 1);
+}
+
+void Builder_MakeChunks(struct ChunkInfo** chunks, int count) {
+#ifdef CC_BUILD_TINYSTACK
+	BlockID* chunk   = (cc_uint8*)temp_mem;
+	cc_uint8* counts = (cc_uint8*)temp_mem + EXTCHUNK_SIZE_3;
+#else
+	BlockID chunk[EXTCHUNK_SIZE_3]; 
+	cc_uint8 counts[CHUNK_SIZE_3 * FACE_COUNT]; 
+#endif
+
+#ifdef CC_BUILD_ADVLIGHTING
+	int bitFlags[EXTCHUNK_SIZE_3];
+#else
+	int bitFlags[1];
+#endif
+	static CC_BIG_VAR struct BuilderContext ctx;
+	struct ChunkInfo* info;
+	int i, jobs = 0;
+
+	ctx.chunk    = chunk;
+	ctx.counts   = counts;
+	ctx.bitFlags = bitFlags;
+
+	for (i = 0; i < count; i++) 
+	{
+		info = chunks[i];
+		if (CanSkipChunk(info)) { ForgetRetainedMesh(info); continue; }
+
+		/* Only some y slices changed, so try to avoid rebuilding the entire mesh */
+		/*  (lower detail meshes are cheap enough to always entirely rebuild) */
+		if (!info->lod && (info->dirtyMinY > 0 || info->dirtyMaxY < CHUNK_MAX) && CanRebuildSlices()) {
+			RemeshChunk(&ctx, info); continue;
+		}
+
+		ForgetRetainedMesh(info);
+		Mem_Set(&builder_jobs[jobs], 0, sizeof(struct BuilderJob));
+		builder_jobs[jobs++].info = info;
+		if (jobs < BUILDER_MAX_JOBS) continue;
+
+		BuildJobs(&ctx, jobs);
+		jobs = 0;
+	}
+	if (jobs) BuildJobs(&ctx, jobs);
+}
+
+void Builder_MakeChunk(struct ChunkInfo* info) {
+	Builder_MakeChunks(&info, 1);
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Builder benchmark----------------------------------------------------*
+*#########################################################################################################################*/
+static const struct BuilderBenchmarkMode {
+	const char* name;
+	void (*SetActive)(void);
+} bench_modes[] = {
+	{ "Normal",   NormalBuilder_SetActive },
+	{ "Greedy",   GreedyBuilder_SetActive },
+#ifdef CC_BUILD_ADVLIGHTING
+	{ "Advanced", AdvBuilder_SetActive    },
+	{ "Modern",   ModernBuilder_SetActive },
+#endif
+};
+
+static cc_uint64 bench_last;
+/* Returns microseconds elapsed since the last call to this function */
+static cc_uint64 Benchmark_Lap(void) {
+	cc_uint64 now = Stopwatch_Measure();
+	cc_uint64 elapsed = Stopwatch_ElapsedMicroseconds(bench_last, now);
+	bench_last = now;
+	return elapsed;
+}
+
+static cc_bool BenchmarkBuilder(struct BuilderContext* ctx, struct BuilderBenchmark* result) {
+	struct VertexTextured* sink = NULL;
+	struct VertexTextured* tmp;
+	int sinkSize = 0, totalVerts;
+	int cx, cy, cz, x1, y1, z1;
+	cc_bool allAir, allSolid;
+
+	Benchmark_Lap();
+	for (cy = 0; cy < World.ChunksY; cy++)
+		for (cz = 0; cz < World.ChunksZ; cz++)
+			for (cx = 0; cx < World.ChunksX; cx++)
+	{
+		x1 = cx * CHUNK_SIZE; y1 = cy * CHUNK_SIZE; z1 = cz * CHUNK_SIZE;
+		result->chunks++;
+		Builder_PrePrepareChunk(ctx);
+
+		allSolid = ReadChunk(ctx, x1, y1, z1, &allAir);
+		result->readTime += Benchmark_Lap();
+		if (allAir || allSolid) continue;
+
+		Lighting.LightHint(x1 - 1, y1 - 1, z1 - 1);
+		result->lightTime += Benchmark_Lap();
+
+		StretchChunk(ctx, x1, y1, z1);
+		totalVerts = Builder_TotalVerticesCount(ctx);
+		result->prepareTime += Benchmark_Lap();
+		if (!totalVerts) continue;
+
+		if (totalVerts > sinkSize) {
+			tmp = (struct VertexTextured*)Mem_TryRealloc(sink, totalVerts, sizeof(struct VertexTextured));
+			if (!tmp) { Mem_Free(sink); return false; }
+
+			sink     = tmp;
+			sinkSize = totalVerts;
+		}
+		ctx->vertices = sink;
+		Benchmark_Lap();
+
+		RenderChunk(ctx, x1, y1, z1);
+		result->renderTime += Benchmark_Lap();
+		result->vertices   += totalVerts;
+	}
+
+	Mem_Free(sink);
+	return true;
+}
+
+int Builder_Benchmark(struct BuilderBenchmark* results) {
+	struct BuilderState* state;
+	int i, count = Array_Elems(bench_modes);
+
+	state = (struct BuilderState*)Mem_TryAllocCleared(1, sizeof(struct BuilderState));
+	if (!state) return 0;
+	BuilderState_Init(state);
+
+	for (i = 0; i < count; i++) 
+	{
+		Mem_Set(&results[i], 0, sizeof(struct BuilderBenchmark));
+		results[i].name = bench_modes[i].name;
+
+		bench_modes[i].SetActive();
+		if (!BenchmarkBuilder(&state->ctx, &results[i])) break;
+	}
+
+	Builder_ApplyActive();
+	Mem_Free(state);
+	return i;
+}
+
+
 /*########################################################################################################################*
 *---------------------------------------------------Builder interface-----------------------------------------------------*
 *#########################################################################################################################*/
@@ -1635,6 +2849,8 @@ void Builder_ApplyActive(void) {
 		else {
 			AdvBuilder_SetActive();
 		}
+	} else if (Builder_UseTileWrap()) {
+		GreedyBuilder_SetActive();
 	} else {
 		NormalBuilder_SetActive();
 	}
@@ -1649,7 +2865,18 @@ static void OnInit(void) {
 	Builder_Offsets[FACE_YMAX] =  EXTCHUNK_SIZE_2;
 
 	if (!Game_ClassicMode) Builder_SmoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
+	Builder_GreedyMeshing = Options_GetBool(OPT_GREEDY_MESHING, false);
 	Builder_ApplyActive();
+	StartWorkers(Options_GetInt(OPT_CHUNK_BUILD_THREADS, 0, BUILDER_MAX_WORKERS, 2));
+}
+
+static void OnFree(void) {
+	StopWorkers();
+	FreeRetainedMeshes();
+}
+
+static void OnReset(void) {
+	FreeRetainedMeshes();
 }
 
 static void OnNewMapLoaded(void) {
@@ -1659,8 +2886,8 @@ static void OnNewMapLoaded(void) {
 
 struct IGameComponent Builder_Component = {
 	OnInit, /* Init */
-	NULL, /* Free */
-	NULL, /* Reset */
-	NULL, /* OnNewMap */
+	OnFree, /* Free */
+	OnReset, /* Reset */
+	OnReset, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
 };
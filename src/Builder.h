@@ -18,11 +18,50 @@ extern struct IGameComponent Builder_Component;
 extern int Builder_SidesLevel, Builder_EdgeLevel;
 /* Whether smooth/advanced lighting mesh builder is used. */
 extern cc_bool Builder_SmoothLighting;
+/* Whether faces of fully opaque blocks are merged into rectangles along both axes. */
+/* NOTE: Only used when smooth lighting is disabled, and the graphics backend supports tile wrapping. */
+extern cc_bool Builder_GreedyMeshing;
+/* Whether chunk meshes contain faces whose texture V coords must be wrapped within their tile. */
+/* NOTE: When true, Gfx_EnableTileWrap must be used when rendering chunk meshes. */
+cc_bool Builder_UseTileWrap(void);
+/* Whether chunk meshes are uploaded in the compact VERTEX_FORMAT_CHUNK layout. */
+/* NOTE: Vertex positions are then relative to the chunk's origin (minimum corner). */
+cc_bool Builder_UseChunkVertices(void);
 
 /* Builds the mesh of vertices for the given chunk. */
 void Builder_MakeChunk(struct ChunkInfo* info);
+/* Builds the meshes of vertices for the given chunks. */
+/* NOTE: Chunks may be built in parallel on worker threads, but are always uploaded on the main thread. */
+void Builder_MakeChunks(struct ChunkInfo** chunks, int count);
+
+/* Max number of worker threads that chunks are built on */
+#define BUILDER_MAX_WORKERS 15
+/* Number of worker threads that chunks are built on (0 when only built on the main thread) */
+extern int Builder_WorkersCount;
+/* Runs the job with the given index, on either the main thread or a chunk builder worker thread. */
+/* thread is 0 for the main thread, or 1 to Builder_WorkersCount for a worker thread */
+/*  (so that each thread can use its own temp state, e.g. by indexing an array with it) */
+typedef void (*Builder_JobFunc)(int job, int thread);
+/* Runs jobs 0 to count - 1 in parallel on the main thread and chunk builder worker threads. */
+/* NOTE: Returns once every job has finished. Must only be called from the main thread. */
+void Builder_RunJobs(int count, Builder_JobFunc func);
 
 void Builder_ApplyActive(void);
 
+/* Time taken by each phase of building the mesh of every chunk in the map with a mesh builder */
+struct BuilderBenchmark {
+	const char* name;    /* Name of the mesh builder */
+	int chunks;          /* Number of chunks built */
+	cc_uint64 vertices;  /* Total number of vertices output */
+	/* Time taken (in microseconds) reading blocks, calculating lighting, */
+	/*  calculating face counts, and outputting vertices */
+	cc_uint64 readTime, lightTime, prepareTime, renderTime;
+};
+#define BUILDER_MAX_BENCHMARKS 4
+/* Builds the mesh of every chunk in the map into a temp memory buffer, once with each mesh builder. */
+/* NOTE: Meshes are never uploaded to the GPU, so only the CPU cost of meshing is measured. */
+/* Returns number of mesh builders benchmarked (at most BUILDER_MAX_BENCHMARKS) */
+int Builder_Benchmark(struct BuilderBenchmark* results);
+
 CC_END_HEADER
 #endif
@@ -17,6 +17,10 @@
 #include "TexturePack.h"
 #include "Options.h"
 #include "Drawer2D.h"
+#include "Builder.h"
+#include "Lighting.h"
+#include "Platform.h"
+#include "Deflate.h"
 
 #define COMMANDS_PREFIX "/client"
 #define COMMANDS_PREFIX_SPACE "/client "
@@ -235,6 +239,217 @@ static struct ChatCommand ResolutionCommand = {
 	}
 };
 
+static void MeshBenchCommand_Execute(const cc_string* args, int argsCount) {
+	struct BuilderBenchmark results[BUILDER_MAX_BENCHMARKS];
+	struct BuilderBenchmark* r;
+	int i, count, totalMS, chunksPerSec, vertsPerSec, sizeKB;
+	int readMS, lightMS, prepareMS, renderMS;
+	cc_uint64 total;
+
+	if (!World.Loaded) {
+		Chat_AddRaw("&e/client: &cThere is no map loaded."); return;
+	}
+	count = Builder_Benchmark(results);
+	if (!count) {
+		Chat_AddRaw("&e/client: &cNot enough memory to benchmark mesh builders."); return;
+	}
+
+	for (i = 0; i < count; i++) 
+	{
+		r     = &results[i];
+		total = r->readTime + r->lightTime + r->prepareTime + r->renderTime;
+		total = max(total, 1);
+
+		totalMS      = (int)(total / 1000);
+		chunksPerSec = (int)(r->chunks   * 1000000 / total);
+		vertsPerSec  = (int)(r->vertices * 1000000 / total);
+		sizeKB       = (int)(r->vertices * sizeof(struct VertexTextured) / 1024);
+
+		Chat_Add3("&e%c: &f%i chunks in %i ms", r->name, &r->chunks, &totalMS);
+		Chat_Add3("   &f%i chunks/s, %i vertices/s, %i KB of mesh data", 
+				&chunksPerSec, &vertsPerSec, &sizeKB);
+
+		readMS    = (int)(r->readTime    / 1000);
+		lightMS   = (int)(r->lightTime   / 1000);
+		prepareMS = (int)(r->prepareTime / 1000);
+		renderMS  = (int)(r->renderTime  / 1000);
+		Chat_Add4("   &fread %i ms, light %i ms, prepare %i ms, render %i ms", 
+				&readMS, &lightMS, &prepareMS, &renderMS);
+	}
+}
+
+static struct ChatCommand MeshBenchCommand = {
+	"MeshBench", MeshBenchCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client meshbench",
+		"&eBuilds the mesh of every chunk in the map with each mesh builder,",
+		"&e  then shows how long each phase of building took.",
+		"&eMeshes are not uploaded to the GPU, so only CPU time is measured.",
+	}
+};
+
+static void LightCheckCommand_Execute(const cc_string* args, int argsCount) {
+	int litCells, mismatches;
+	cc_uint64 beg;
+	int elapsedMS;
+
+	if (!World.Loaded) {
+		Chat_AddRaw("&e/client: &cThere is no map loaded."); return;
+	}
+	beg        = Stopwatch_Measure();
+	mismatches = FancyLighting_CheckBatched(&litCells);
+	elapsedMS  = (int)(Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure()) / 1000);
+
+	if (mismatches < 0) {
+		Chat_AddRaw("&e/client: &cNot enough memory to check lighting."); return;
+	}
+	Chat_Add3("&e/client: &f%i lit cells checked in %i ms, %i mismatches", 
+			&litCells, &elapsedMS, &mismatches);
+}
+
+static struct ChatCommand LightCheckCommand = {
+	"LightCheck", LightCheckCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client lightcheck",
+		"&eCalculates fancy lighting of every chunk in the map from all light",
+		"&e  sources at once, and from each light source one at a time,",
+		"&e  then shows how many cells of light differ between the two.",
+	}
+};
+
+static void NetStatsCommand_Execute(const cc_string* args, int argsCount) {
+	struct ServerSendStats stats;
+	int sentKB, avgWrite;
+
+	if (Server.IsSinglePlayer) {
+		Chat_AddRaw("&e/client: &cYou are not connected to a multiplayer server."); return;
+	}
+	Server_GetSendStats(&stats);
+	sentKB   = (int)(stats.bytesSent / 1024);
+	avgWrite = stats.writes ? (int)(stats.bytesSent / stats.writes) : 0;
+
+	Chat_Add3("&e/client: &f%i KB sent in %i writes (%i bytes per write)", 
+			&sentKB, &stats.writes, &avgWrite);
+	Chat_Add3("   &f%i bytes waiting to be sent (peak %i), socket was full %i times", 
+			&stats.queued, &stats.peakQueued, &stats.stalls);
+}
+
+static struct ChatCommand NetStatsCommand = {
+	"NetStats", NetStatsCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client netstats",
+		"&eShows how much data has been sent to the server since connecting,",
+		"&e  and how much data is waiting to be sent because the server",
+		"&e  isn't receiving data fast enough.",
+	}
+};
+
+static void DeflateBenchCommand_Run(const char* name, const cc_uint8* data, cc_uint32 size) {
+	struct DeflateBenchmark results[DEFLATE_LEVEL_COUNT];
+	struct DeflateBenchmark* r;
+	int i, sizeKB, compressedKB, compressMS, decompressMBs;
+
+	if (!Deflate_Benchmark(data, size, results)) {
+		Chat_AddRaw("&e/client: &cNot enough memory to benchmark compression."); return;
+	}
+	sizeKB = (int)(size / 1024);
+	Chat_Add2("&e%c: &f%i KB of data", name, &sizeKB);
+
+	for (i = 0; i < DEFLATE_LEVEL_COUNT; i++) 
+	{
+		r = &results[i];
+		compressedKB  = (int)(r->compressedSize / 1024);
+		compressMS    = (int)(r->compressTime   / 1000);
+		/* bytes per microsecond is the same as megabytes per second */
+		decompressMBs = (int)(size / max(r->decompressTime, 1));
+
+		Chat_Add4("   &e%c: &f%i KB in %i ms, decompressed at %i MB/s", 
+				r->name, &compressedKB, &compressMS, &decompressMBs);
+		if (!r->verified) Chat_AddRaw("   &cDecompressed data DOES NOT match original");
+	}
+}
+
+static void DeflateBenchCommand_Execute(const cc_string* args, int argsCount) {
+	struct Bitmap* atlas = &Atlas2D.Bmp;
+	cc_uint8 allBytes[1024];
+	int i;
+
+	/* Map blocks are almost all below 128, and small data like this is compressed */
+	/*  using FIXED blocks, so this checks every byte value can be compressed properly */
+	for (i = 0; i < (int)sizeof(allBytes); i++) allBytes[i] = (cc_uint8)i;
+	DeflateBenchCommand_Run("All byte values", allBytes, sizeof(allBytes));
+
+	if (World.Loaded) {
+		DeflateBenchCommand_Run("Map blocks", World.Blocks, World.Volume);
+	}
+	if (atlas->scan0) {
+		DeflateBenchCommand_Run("Terrain atlas", (cc_uint8*)atlas->scan0, 
+								Bitmap_DataSize(atlas->width, atlas->height));
+	}
+}
+
+static struct ChatCommand DeflateBenchCommand = {
+	"DeflateBench", DeflateBenchCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client deflatebench",
+		"&eCompresses every byte value, the blocks of the map and the pixels",
+		"&e  of the terrain atlas at each compression level, then decompresses",
+		"&e  them again and checks they match. Shows compressed sizes and how",
+		"&e  fast each compression level compresses and decompresses.",
+	}
+};
+
+static void ChecksumBenchCommand_Run(const char* name, const cc_uint8* data, cc_uint32 size) {
+	struct ChecksumBenchmark results[CHECKSUM_MAX_IMPLEMENTATIONS];
+	struct ChecksumBenchmark* r;
+	int i, count, sizeKB, speedMBs;
+
+	count = Utils_BenchmarkChecksums(data, size, results);
+	if (!count) {
+		Chat_AddRaw("&e/client: &cNot enough memory to benchmark checksums."); return;
+	}
+	sizeKB = (int)(size / 1024);
+	Chat_Add2("&e%c: &f%i KB of data", name, &sizeKB);
+
+	for (i = 0; i < count; i++) 
+	{
+		r = &results[i];
+		/* bytes per microsecond is the same as megabytes per second */
+		speedMBs = (int)(size / max(r->time, 1));
+
+		Chat_Add2("   &e%c: &f%i MB/s", r->name, &speedMBs);
+		if (!r->verified) Chat_AddRaw("   &cChecksums DO NOT match reference implementation");
+	}
+}
+
+static void ChecksumBenchCommand_Execute(const cc_string* args, int argsCount) {
+	struct Bitmap* atlas = &Atlas2D.Bmp;
+
+	if (World.Loaded) {
+		ChecksumBenchCommand_Run("Map blocks", World.Blocks, World.Volume);
+	}
+	if (atlas->scan0) {
+		ChecksumBenchCommand_Run("Terrain atlas", (cc_uint8*)atlas->scan0, 
+								Bitmap_DataSize(atlas->width, atlas->height));
+	}
+}
+
+static struct ChatCommand ChecksumBenchCommand = {
+	"ChecksumBench", ChecksumBenchCommand_Execute,
+	COMMAND_FLAG_UNSPLIT_ARGS,
+	{
+		"&a/client checksumbench",
+		"&eCalculates the CRC32 and Adler32 checksums of the blocks of the map",
+		"&e  and the pixels of the terrain atlas with each implementation this",
+		"&e  CPU supports, checks they match the simple reference implementations",
+		"&e  and shows how fast each implementation is.",
+	}
+};
+
 static void ModelCommand_Execute(const cc_string* args, int argsCount) {
 	if (argsCount) {
 		Entity_SetModel(&Entities.CurPlayer->Base, args);
@@ -370,6 +585,26 @@ static cc_bool drawOp_persist, drawOp_hooked, drawOp_hasMark1;
 static const char* drawOp_name;
 static void (*drawOp_Func)(IVec3 min, IVec3 max);
 
+/* Blocks changed by draw operations are changed in batches */
+#define DRAWOP_MAX_BLOCKS 1024
+static IVec3 drawOp_coords[DRAWOP_MAX_BLOCKS];
+static BlockID drawOp_blocks[DRAWOP_MAX_BLOCKS];
+static BlockID drawOp_oldBlocks[DRAWOP_MAX_BLOCKS];
+static int drawOp_count;
+
+static void DrawOpCommand_FlushBlocks(void) {
+	Game_ChangeBlocks(drawOp_coords, drawOp_blocks, drawOp_oldBlocks, drawOp_count);
+	drawOp_count = 0;
+}
+
+static void DrawOpCommand_ChangeBlock(int x, int y, int z, BlockID block) {
+	drawOp_coords[drawOp_count].x = x;
+	drawOp_coords[drawOp_count].y = y;
+	drawOp_coords[drawOp_count].z = z;
+	drawOp_blocks[drawOp_count]   = block;
+	if (++drawOp_count == DRAWOP_MAX_BLOCKS) DrawOpCommand_FlushBlocks();
+}
+
 static void DrawOpCommand_BlockChanged(void* obj, IVec3 coords, BlockID old, BlockID now);
 static void DrawOpCommand_ResetState(void) {
 	if (drawOp_hooked) {
@@ -401,6 +636,7 @@ static void DrawOpCommand_Execute(void) {
 	if (!World_Contains(max.x, max.y, max.z)) return;
 
 	drawOp_Func(min, max);
+	DrawOpCommand_FlushBlocks();
 }
 
 static void DrawOpCommand_BlockChanged(void* obj, IVec3 coords, BlockID old, BlockID now) {
@@ -470,7 +706,7 @@ static void CuboidCommand_Draw(IVec3 min, IVec3 max) {
 	for (y = min.y; y <= max.y; y++) {
 		for (z = min.z; z <= max.z; z++) {
 			for (x = min.x; x <= max.x; x++) {
-				Game_ChangeBlock(x, y, z, toPlace);
+				DrawOpCommand_ChangeBlock(x, y, z, toPlace);
 			}
 		}
 	}
@@ -525,7 +761,7 @@ static void ReplaceCommand_Draw(IVec3 min, IVec3 max) {
 			for (x = min.x; x <= max.x; x++) {
 				cur = World_GetBlock(x, y, z);
 				if (cur != source) continue;
-				Game_ChangeBlock(x, y, z, toPlace);
+				DrawOpCommand_ChangeBlock(x, y, z, toPlace);
 			}
 		}
 	}
@@ -797,6 +1033,11 @@ static struct ChatCommand BlockEditCommand = {
 *#########################################################################################################################*/
 static void OnInit(void) {
 	Commands_Register(&GpuInfoCommand);
+	Commands_Register(&MeshBenchCommand);
+	Commands_Register(&LightCheckCommand);
+	Commands_Register(&NetStatsCommand);
+	Commands_Register(&DeflateBenchCommand);
+	Commands_Register(&ChecksumBenchCommand);
 	Commands_Register(&HelpCommand);
 	Commands_Register(&RenderTypeCommand);
 	Commands_Register(&ResolutionCommand);
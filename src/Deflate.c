@@ -152,7 +152,7 @@ enum INFLATE_STATE_ {
 };
 
 /* Insert next byte into the bit buffer */
-#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (cc_uint32)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
+#define Inflate_GetByte(state) state->AvailIn--; state->Bits |= (InflateBits)(*state->NextIn++) << state->NumBits; state->NumBits += 8;
 /* Retrieves bits from the bit buffer */
 #define Inflate_PeekBits(state, bits) (state->Bits & ((1UL << (bits)) - 1UL))
 /* Consumes/eats up bits from the bit buffer */
@@ -161,8 +161,6 @@ enum INFLATE_STATE_ {
 #define Inflate_AlignBits(state) cc_uint32 alignSkip = state->NumBits & 7; Inflate_ConsumeBits(state, alignSkip);
 /* Ensures there are 'bitsCount' bits, or returns if not */
 #define Inflate_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { if (!state->AvailIn) return; Inflate_GetByte(state); }
-/* Ensures there are 'bitsCount' bits */
-#define Inflate_UNSAFE_EnsureBits(state, bitsCount) while (state->NumBits < bitsCount) { Inflate_GetByte(state); }
 /* Peeks then consumes given bits */
 #define Inflate_ReadBits(state, bitsCount) Inflate_PeekBits(state, bitsCount); Inflate_ConsumeBits(state, bitsCount);
 /* Sets to given result and sets state to DONE */
@@ -175,8 +173,60 @@ enum INFLATE_STATE_ {
 /* The maximum amount of bytes that can be output is 258 */
 #define INFLATE_FASTINF_OUT 258
 /* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
+/* (this also covers refilling a 64 bit bit buffer, which reads 8 bytes at once) */
 #define INFLATE_FASTINF_IN 10
 
+static const cc_uint8 fixed_lits[INFLATE_MAX_LITS] = {
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,8,8,8,8,8,8,8,8
+};
+static const cc_uint8 fixed_dists[INFLATE_MAX_DISTS] = {
+	5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
+};
+
+static const cc_uint16 len_base[31] = { 
+	3,4,5,6,7,8,9,10,11,13,
+	15,17,19,23,27,31,35,43,51,59,
+	67,83,99,115,131,163,195,227,258,0,0 
+};
+static const cc_uint8 len_bits[31] = { 
+	0,0,0,0,0,0,0,0,1,1,
+	1,1,2,2,2,2,3,3,3,3,
+	4,4,4,4,5,5,5,5,0,0,0 
+};
+static const cc_uint16 dist_base[32] = {
+	1,2,3,4,5,7,9,13,17,25,
+	33,49,65,97,129,193,257,385,513,769,
+	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
+};
+static const cc_uint8 dist_bits[32] = {
+	0,0,0,0,1,1,2,2,3,3,
+	4,4,5,5,6,6,7,7,8,8,
+	9,9,10,10,11,11,12,12,13,13,0,0 
+};
+static const cc_uint8 codelens_order[INFLATE_MAX_CODELENS] = {
+	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
+};
+
+/* Huffman table entries are packed as: */
+/*   bits 0-3:  length of codeword (0 when codeword isn't in fast table) */
+/*   bits 4-7:  number of extra bits that follow the codeword */
+/*   bits 8-16: symbol the codeword represents */
+/*   bits 17-31: base value of symbol (i.e. literal, length, or distance) */
+#define HUFFMAN_ENTRY_LEN(entry)   ((entry) & 0x0F)
+#define HUFFMAN_ENTRY_EXTRA(entry) (((entry) >> 4) & 0x0F)
+#define HUFFMAN_ENTRY_SYM(entry)   (((entry) >> 8) & 0x1FF)
+#define HUFFMAN_ENTRY_BASE(entry)  ((entry) >> 17)
+/* Set for any literal/length symbol which is not a literal (i.e. symbol >= 256) */
+#define HUFFMAN_ENTRY_NONLIT 0x10000UL
+
 static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
 	n = ((n & 0xCCCC) >> 2) | ((n & 0x3333) << 2);
@@ -186,9 +236,12 @@ static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 }
 
 /* Builds a huffman tree, based on input lengths of each codeword */
-static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLens, int count) {
+/* Symbols from firstBase onwards use the given base values and number of extra bits */
+static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLens, int count,
+								const cc_uint16* bases, const cc_uint8* extraBits, int firstBase) {
 	int bl_count[INFLATE_MAX_BITS], bl_offsets[INFLATE_MAX_BITS];
 	int code, offset, value;
+	cc_uint32 entry;
 	int i, j;
 
 	/* Initialise 'zero bit length' codewords */
@@ -238,28 +291,32 @@ static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLe
 	*  Note that although codewords are ordered, values may not be.
 	*  Some values may also not be assigned to any codeword.
 	*/
-	value = 0;
-	Mem_Set(table->fast, UInt8_MaxValue, sizeof(table->fast));
-	for (i = 0; i < count; i++, value++) {
+	Mem_Set(table->fast, 0, sizeof(table->fast));
+	for (i = 0; i < count; i++) {
 		int len = bitLens[i];
 		if (!len) continue;
-		table->values[bl_offsets[len]] = value;
+
+		/* Store base value and extra bits with symbol, so they don't need to be looked up after decoding */
+		if (i >= firstBase) {
+			value = bases[i - firstBase];
+			entry = (extraBits[i - firstBase] << 4) | (i << 8) | ((cc_uint32)value << 17);
+		} else {
+			entry = (i << 8) | ((cc_uint32)i << 17);
+		}
+		table->values[bl_offsets[len]] = entry;
 
 		/* Compute the accelerated lookup table values for this codeword.
 		* For example, assume len = 4 and codeword = 0100
-		* - Shift it left to be 0100_00000
-		* - Then, for all the indices from 0100_00000 to 0100_11111,
-		*   - bit reverse index, as huffman codes are read backwards
-		*   - set fast value to specify a 'value' value, and to skip 'len' bits
+		* - Bit reverse it to be 0010, as huffman codes are read backwards
+		* - Then, for all the indices from 000000_0010 to 111111_0010,
+		*   - set fast value to specify the symbol, and to skip 'len' bits
 		*/
 		if (len <= INFLATE_FAST_BITS) {
-			cc_int16 packed = (cc_int16)((len << INFLATE_FAST_LEN_SHIFT) | value);
 			int codeword = table->firstCodewords[len] + (bl_offsets[len] - table->firstOffsets[len]);
-			codeword <<= (INFLATE_FAST_BITS - len);
+			codeword = Huffman_ReverseBits(codeword, len);
 
-			for (j = 0; j < 1 << (INFLATE_FAST_BITS - len); j++, codeword++) {
-				int index = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
-				table->fast[index] = packed;
+			for (j = codeword; j < (1 << INFLATE_FAST_BITS); j += (1 << len)) {
+				table->fast[j] = entry | len;
 			}
 		}
 		bl_offsets[len]++;
@@ -270,8 +327,8 @@ static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLe
 /* Attempts to read the next huffman encoded value from the bitstream, using given table */
 /* Returns -1 if there are insufficient bits to read the value */
 static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table) {
-	cc_uint32 i, j, codeword;
-	int packed, bits, offset;
+	cc_uint32 i, j, codeword, entry;
+	int offset;
 
 	/* Buffer as many bits as possible */
 	while (state->NumBits <= INFLATE_MAX_BITS) {
@@ -281,11 +338,10 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 
 	/* Try fast accelerated table lookup */
 	if (state->NumBits >= INFLATE_FAST_BITS) {
-		packed = table->fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];
-		if (packed >= 0) {
-			bits = packed >> INFLATE_FAST_LEN_SHIFT;
-			Inflate_ConsumeBits(state, bits);
-			return packed & INFLATE_FAST_VAL_MASK;
+		entry = table->fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];
+		if (entry) {
+			Inflate_ConsumeBits(state, HUFFMAN_ENTRY_LEN(entry));
+			return HUFFMAN_ENTRY_SYM(entry);
 		}
 	}
 
@@ -298,7 +354,7 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 		if (codeword < table->endCodewords[i]) {
 			offset = table->firstOffsets[i] + (codeword - table->firstCodewords[i]);
 			Inflate_ConsumeBits(state, i);
-			return table->values[offset];
+			return HUFFMAN_ENTRY_SYM(table->values[offset]);
 		}
 	}
 
@@ -306,43 +362,22 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 	return -1;
 }
 
-/* Inline the common <= 9 bits case */
-#define Huffman_UNSAFE_Decode(state, table, result) \
-{\
-	Inflate_UNSAFE_EnsureBits(state, INFLATE_MAX_BITS);\
-	packed = table.fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];\
-	if (packed >= 0) {\
-		consumedBits = packed >> INFLATE_FAST_BITS;\
-		Inflate_ConsumeBits(state, consumedBits);\
-		result = packed & 0x1FF;\
-	} else {\
-		result = Huffman_UNSAFE_Decode_Slow(state, &table);\
-	}\
-}
-
-static int Huffman_UNSAFE_Decode_Slow(struct InflateState* state, struct HuffmanTable* table) {
-	cc_uint32 i, j, codeword;
+/* Decodes a codeword that is longer than INFLATE_FAST_BITS, returning 0 if codeword is invalid */
+static cc_uint32 Huffman_DecodeSlow(struct HuffmanTable* table, cc_uint32 bits) {
+	cc_uint32 i, codeword;
 	int offset;
 
 	/* Slow, bit by bit lookup. Need to reverse order for huffman. */
-	codeword = Inflate_PeekBits(state,       INFLATE_FAST_BITS);
-	codeword = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
+	codeword = Huffman_ReverseBits(bits & INFLATE_FAST_MASK, INFLATE_FAST_BITS);
 
-	for (i = INFLATE_FAST_BITS + 1, j = INFLATE_FAST_BITS; i < INFLATE_MAX_BITS; i++, j++) {
-		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
+	for (i = INFLATE_FAST_BITS + 1; i < INFLATE_MAX_BITS; i++) {
+		codeword = (codeword << 1) | ((bits >> (i - 1)) & 1);
 
 		if (codeword < table->endCodewords[i]) {
 			offset = table->firstOffsets[i] + (codeword - table->firstCodewords[i]);
-			Inflate_ConsumeBits(state, i);
-			return table->values[offset];
+			return table->values[offset] | i;
 		}
 	}
-
-	Inflate_Fail(state, INF_ERR_INVALID_CODE);
-	/* Need to exit the fast decode loop */
-	/* TODO: This means a few garbage bytes can get written */
-	/* to the output, but it probably doesn't matter */
-	state->AvailIn = 0;
 	return 0;
 }
 
@@ -360,106 +395,143 @@ void Inflate_Init2(struct InflateState* state, struct Stream* source) {
 	state->result = 0;
 }
 
-static const cc_uint8 fixed_lits[INFLATE_MAX_LITS] = {
-	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
-	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
-	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
-	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
-	8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-	9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-	7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,8,8,8,8,8,8,8,8
-};
-static const cc_uint8 fixed_dists[INFLATE_MAX_DISTS] = {
-	5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
-};
+#ifdef INFLATE_64BIT_BUFFER
+#define Inflate_Load64LE(p) (\
+	 (InflateBits)(p)[0]        | ((InflateBits)(p)[1] <<  8) | ((InflateBits)(p)[2] << 16) | ((InflateBits)(p)[3] << 24) |\
+	((InflateBits)(p)[4] << 32) | ((InflateBits)(p)[5] << 40) | ((InflateBits)(p)[6] << 48) | ((InflateBits)(p)[7] << 56))
 
-static const cc_uint16 len_base[31] = { 
-	3,4,5,6,7,8,9,10,11,13,
-	15,17,19,23,27,31,35,43,51,59,
-	67,83,99,115,131,163,195,227,258,0,0 
-};
-static const cc_uint8 len_bits[31] = { 
-	0,0,0,0,0,0,0,0,1,1,
-	1,1,2,2,2,2,3,3,3,3,
-	4,4,4,4,5,5,5,5,0,0,0 
-};
-static const cc_uint16 dist_base[32] = {
-	1,2,3,4,5,7,9,13,17,25,
-	33,49,65,97,129,193,257,385,513,769,
-	1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,0,0 
-};
-static const cc_uint8 dist_bits[32] = {
-	0,0,0,0,1,1,2,2,3,3,
-	4,4,5,5,6,6,7,7,8,8,
-	9,9,10,10,11,11,12,12,13,13,0,0 
-};
-static const cc_uint8 codelens_order[INFLATE_MAX_CODELENS] = {
-	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
-};
+/* Refills bit buffer to at least 56 bits by reading 8 bytes at once, then only consuming the whole bytes that fit */
+/* (the extra bits read ahead are the same bits that get ORed in again by the next refill) */
+#define Inflate_FastRefill() bits |= Inflate_Load64LE(in) << numBits; in += (63 - numBits) >> 3; numBits |= 56;
+/* 56 bits is enough for the longest length and distance (15 + 5 + 15 + 13 bits) */
+#define Inflate_FastEnsure(count)
+#else
+#define Inflate_FastRefill() Inflate_FastEnsure(INFLATE_MAX_BITS + 9)
+#define Inflate_FastEnsure(count) while (numBits < (count)) { bits |= (InflateBits)(*in++) << numBits; numBits += 8; }
+#endif
+#define Inflate_FastConsume(count) bits >>= (count); numBits -= (count);
+
+/* Decodes next huffman codeword from the bit buffer, or stops decoding if codeword is invalid */
+#define Inflate_FastDecode(table, entry) \
+	entry = table.fast[bits & INFLATE_FAST_MASK];\
+	if (!entry) {\
+		entry = Huffman_DecodeSlow(&table, (cc_uint32)bits);\
+		if (!entry) { Inflate_Fail(s, INF_ERR_INVALID_CODE); break; }\
+	}
+
+/* Writes literal from huffman table entry into the window */
+#define Inflate_FastLiteral(entry) \
+	Inflate_FastConsume(HUFFMAN_ENTRY_LEN(entry));\
+	window[curIdx] = (cc_uint8)HUFFMAN_ENTRY_BASE(entry);\
+	curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;\
+	availOut--; copyLen++;
 
 static void Inflate_InflateFast(struct InflateState* s) {
+	/* bit buffer variables */
+	/* (copied into locals, as otherwise writes to window force them to be reloaded from memory) */
+	InflateBits bits;
+	cc_uint32 numBits;
+	const cc_uint8* in;
+	const cc_uint8* inEnd;
+
 	/* huffman variables */
-	cc_uint32 lit, len, dist;
-	cc_uint32 bits, lenIdx, distIdx;
-	int packed, consumedBits;
+	cc_uint32 entry, len, dist, extra;
 
 	/* window variables */
 	cc_uint8* window;
-	cc_uint32 i, curIdx, startIdx;
+	cc_uint32 i, curIdx, startIdx, availOut;
 	cc_uint32 copyStart, copyLen, partLen;
 
-	window = s->Window;
-	curIdx = s->WindowIndex;
+	bits    = s->Bits;
+	numBits = s->NumBits;
+	in      = s->NextIn;
+	inEnd   = s->NextIn + s->AvailIn;
+
+	window    = s->Window;
+	curIdx    = s->WindowIndex;
+	availOut  = s->AvailOut;
 	copyStart = s->WindowIndex;
 	copyLen   = 0;
 
 #define INFLATE_FAST_COPY_MAX (INFLATE_WINDOW_SIZE - INFLATE_FASTINF_OUT)
-	while (s->AvailOut >= INFLATE_FASTINF_OUT && s->AvailIn >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
-		Huffman_UNSAFE_Decode(s, s->Table.Lits, lit);
+	while (availOut >= INFLATE_FASTINF_OUT && (inEnd - in) >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
+		Inflate_FastRefill();
+		Inflate_FastDecode(s->Table.Lits, entry);
+
+		if (!(entry & HUFFMAN_ENTRY_NONLIT)) {
+			Inflate_FastLiteral(entry);
+#ifdef INFLATE_64BIT_BUFFER
+			/* Still at least 56 - 15 bits left in the bit buffer, which is enough */
+			/*  to decode another two literals without needing to refill first */
+			entry = s->Table.Lits.fast[bits & INFLATE_FAST_MASK];
+			if (!entry || (entry & HUFFMAN_ENTRY_NONLIT)) continue;
+			Inflate_FastLiteral(entry);
+
+			entry = s->Table.Lits.fast[bits & INFLATE_FAST_MASK];
+			if (!entry || (entry & HUFFMAN_ENTRY_NONLIT)) continue;
+			Inflate_FastLiteral(entry);
+#endif
+			continue;
+		}
 
-		if (lit <= 256) {
-			if (lit < 256) {
-				window[curIdx] = (cc_uint8)lit;
-				s->AvailOut--; copyLen++;
-				curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;
-			} else {
-				s->State = Inflate_NextBlockState(s);
-				break;
-			}
-		} else {
-			lenIdx = lit - 257;
-			bits = len_bits[lenIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			len  = len_base[lenIdx] + Inflate_ReadBits(s, bits);
-
-			Huffman_UNSAFE_Decode(s, s->TableDists, distIdx);
-			bits = dist_bits[distIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			dist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
-	
-			/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
-			/* If start and end don't cross a boundary, can avoid masking index */
-			startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
-			if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
-				cc_uint8* src = &window[startIdx]; 
-				cc_uint8* dst = &window[curIdx];
+		if (HUFFMAN_ENTRY_SYM(entry) == 256) {
+			Inflate_FastConsume(HUFFMAN_ENTRY_LEN(entry));
+			s->State = Inflate_NextBlockState(s);
+			break;
+		}
 
+		/* Length and its extra bits are decoded together */
+		Inflate_FastConsume(HUFFMAN_ENTRY_LEN(entry));
+		extra = HUFFMAN_ENTRY_EXTRA(entry);
+		Inflate_FastEnsure(extra);
+		len = HUFFMAN_ENTRY_BASE(entry) + ((cc_uint32)bits & ((1UL << extra) - 1));
+		Inflate_FastConsume(extra);
+
+		Inflate_FastEnsure(INFLATE_MAX_BITS - 1);
+		Inflate_FastDecode(s->TableDists, entry);
+		Inflate_FastConsume(HUFFMAN_ENTRY_LEN(entry));
+		extra = HUFFMAN_ENTRY_EXTRA(entry);
+		Inflate_FastEnsure(extra);
+		dist = HUFFMAN_ENTRY_BASE(entry) + ((cc_uint32)bits & ((1UL << extra) - 1));
+		Inflate_FastConsume(extra);
+
+		/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
+		/* If start and end don't cross a boundary, can avoid masking index */
+		startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
+		if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
+			cc_uint8* src = &window[startIdx]; 
+			cc_uint8* dst = &window[curIdx];
+
+			/* Long runs of the same byte (e.g. air blocks in maps) are common */
+			if (dist == 1) {
+				Mem_Set(dst, *src, len);
+			} else if (dist >= len) {
+				Mem_Copy(dst, src, len);
+			} else {
 				for (i = 0; i < (len & ~0x3); i += 4) {
 					*dst++ = *src++; *dst++ = *src++; *dst++ = *src++; *dst++ = *src++;
 				}
 				for (; i < len; i++) { *dst++ = *src++; }
-			} else {
-				for (i = 0; i < len; i++) {
-					window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
-				}
 			}
-			curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
-			s->AvailOut -= len; copyLen += len;
+		} else {
+			for (i = 0; i < len; i++) {
+				window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
+			}
 		}
+		curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
+		availOut -= len; copyLen += len;
 	}
 
+#ifdef INFLATE_64BIT_BUFFER
+	/* Remove the bits that were read ahead */
+	bits &= ((InflateBits)1 << numBits) - 1;
+#endif
+	s->Bits     = bits;
+	s->NumBits  = numBits;
+	s->AvailIn -= (cc_uint32)(in - s->NextIn);
+	s->NextIn   = (cc_uint8*)in;
+
+	s->AvailOut    = availOut;
 	s->WindowIndex = curIdx;
 	if (!copyLen) return;
 
@@ -505,8 +577,8 @@ void Inflate_Process(struct InflateState* s) {
 			} break;
 
 			case 1: { /* Fixed/static huffman compressed */
-				(void)Huffman_Build(&s->Table.Lits, fixed_lits,  INFLATE_MAX_LITS);
-				(void)Huffman_Build(&s->TableDists, fixed_dists, INFLATE_MAX_DISTS);
+				(void)Huffman_Build(&s->Table.Lits, fixed_lits,  INFLATE_MAX_LITS,  len_base,  len_bits,  257);
+				(void)Huffman_Build(&s->TableDists, fixed_dists, INFLATE_MAX_DISTS, dist_base, dist_bits, 0);
 				s->State = Inflate_NextCompressState(s);
 			} break;
 
@@ -591,7 +663,7 @@ void Inflate_Process(struct InflateState* s) {
 
 			s->Index = 0;
 			s->State = INFLATE_STATE_DYNAMIC_LITSDISTS;
-			res = Huffman_Build(&s->Table.CodeLens, s->Buffer, INFLATE_MAX_CODELENS);
+			res = Huffman_Build(&s->Table.CodeLens, s->Buffer, INFLATE_MAX_CODELENS, NULL, NULL, INFLATE_MAX_CODELENS);
 			if (res) { Inflate_Fail(s, res); return; }
 		}
 		
@@ -615,9 +687,9 @@ void Inflate_Process(struct InflateState* s) {
 				s->Index = 0;
 				s->State = Inflate_NextCompressState(s);
 
-				res = Huffman_Build(&s->Table.Lits, s->Buffer, s->NumLits);
+				res = Huffman_Build(&s->Table.Lits, s->Buffer, s->NumLits, len_base, len_bits, 257);
 				if (res) { Inflate_Fail(s, res); return; }
-				res = Huffman_Build(&s->TableDists, s->Buffer + s->NumLits, s->NumDists);
+				res = Huffman_Build(&s->TableDists, s->Buffer + s->NumLits, s->NumDists, dist_base, dist_bits, 0);
 				if (res) { Inflate_Fail(s, res); return; }
 			}
 			break;
@@ -806,10 +878,10 @@ static const cc_uint16 deflate_dist[31] = {
 
 /* Pushes given bits, but does not write them */
 #define Deflate_PushBits(state, value, bits) state->Bits |= (value) << state->NumBits; state->NumBits += (bits);
-/* Pushes bits of the huffman codeword bits for the given literal, but does not write them */
+/* Pushes bits of the huffman codeword for the given literal/length, but does not write them */
 #define Deflate_PushLit(state, value) Deflate_PushBits(state, state->LitsCodewords[value], state->LitsLens[value])
-/* Pushes given bits (reversing for huffman code), but does not write them */
-#define Deflate_PushHuff(state, value, bits) Deflate_PushBits(state, Huffman_ReverseBits(value, bits), bits)
+/* Pushes bits of the huffman codeword for the given distance, but does not write them */
+#define Deflate_PushDist(state, value) Deflate_PushBits(state, state->DistsCodewords[value], state->DistsLens[value])
 /* Writes given byte to output */
 #define Deflate_WriteByte(state) *state->NextOut++ = state->Bits; state->AvailOut--; state->Bits >>= 8; state->NumBits -= 8;
 /* Flushes bits in buffer to output buffer */
@@ -817,49 +889,101 @@ static const cc_uint16 deflate_dist[31] = {
 
 #define MIN_MATCH_LEN 3
 #define MAX_MATCH_LEN 258
+#define DEFLATE_NUM_LITS  286
+#define DEFLATE_NUM_DISTS 30
+#define DEFLATE_MAX_CODE_BITS 15
+#define DEFLATE_MAX_CODELEN_BITS 7
+
+struct DeflateLevel {
+	cc_uint8 hashBits;   /* Number of bits of hash table used */
+	cc_bool lazy;        /* Whether to check for a longer match at the next byte before using a match */
+	cc_bool insertAll;   /* Whether every byte in a match is added to the hash table (instead of just the first) */
+	cc_uint16 maxChain;  /* Max number of previous matches explored for each byte */
+	cc_uint16 niceLen;   /* Stops exploring previous matches once a match of at least this length is found */
+};
+static const struct DeflateLevel deflate_levels[DEFLATE_LEVEL_COUNT] = {
+	{ 12, false, false,   4,  16 }, /* DEFLATE_LEVEL_FASTEST */
+	{ 13, true,  false,   8,  32 }, /* DEFLATE_LEVEL_FAST    */
+	{ 14, true,  true,   32, 128 }, /* DEFLATE_LEVEL_DEFAULT */
+	{ 14, true,  true,  512, 258 }, /* DEFLATE_LEVEL_BEST    */
+};
+
+/* Index of length code for each match length */
+static cc_uint8 deflate_lenCodes[MAX_MATCH_LEN + 1];
+/* Index of distance code for distances 1 to 256, then for (distance - 1) >> 7 of larger distances */
+/*  (distances above 256 always have at least 7 extra bits, so this works) */
+static cc_uint8 deflate_distCodes[512];
+static cc_bool deflate_codesInited;
+#define Deflate_DistCode(dist) ((dist) <= 256 ? deflate_distCodes[(dist) - 1] : deflate_distCodes[256 + (((dist) - 1) >> 7)])
+
+static void Deflate_InitCodes(void) {
+	int i, j;
+	if (deflate_codesInited) return;
+
+	for (i = MIN_MATCH_LEN, j = 0; i <= MAX_MATCH_LEN; i++) {
+		while (i >= deflate_len[j + 1]) j++;
+		deflate_lenCodes[i] = j;
+	}
+	for (i = 1, j = 0; i <= 256; i++) {
+		while (i >= deflate_dist[j + 1]) j++;
+		deflate_distCodes[i - 1] = j;
+	}
+	for (i = 256; i < 512; i++) {
+		while (((i - 256) << 7) + 1 >= deflate_dist[j + 1]) j++;
+		deflate_distCodes[i] = j;
+	}
+	deflate_codesInited = true;
+}
+
+/* These CPUs support fast unaligned reads, so matches can be compared 4 bytes at a time */
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__ || defined __aarch64__)
+	#define DEFLATE_WORD_COMPARE
+	typedef cc_uint32 __attribute__((aligned(1), may_alias)) deflate_word;
+#elif defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+	#define DEFLATE_WORD_COMPARE
+	typedef cc_uint32 deflate_word;
+#endif
 
 /* Number of bytes that match (are the same) from a and b */
 static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
 	int i = 0;
-	while (i < maxLen && *a == *b) { i++; a++; b++; }
+#ifdef DEFLATE_WORD_COMPARE
+	while (i + 4 <= maxLen && *(deflate_word*)(a + i) == *(deflate_word*)(b + i)) i += 4;
+#endif
+	while (i < maxLen && a[i] == b[i]) i++;
 	return i;
 }
 
 /* Hashes 3 bytes of data */
-static cc_uint32 Deflate_Hash(cc_uint8* src) {
-	return (cc_uint32)((src[0] << 8) ^ (src[1] << 4) ^ (src[2])) & DEFLATE_HASH_MASK;
+static cc_uint32 Deflate_Hash(cc_uint8* src, int bits) {
+	cc_uint32 value = src[0] | (src[1] << 8) | (src[2] << 16);
+	return (cc_uint32)(value * 2654435761UL) >> (32 - bits);
 }
 
-/* Writes a literal to state->Output */
-static void Deflate_Lit(struct DeflateState* state, int lit) {
-	Deflate_PushLit(state, lit);
-	Deflate_FlushBits(state);
+/* Adds a literal to the symbols of the current block */
+static void Deflate_AddLit(struct DeflateState* state, int lit) {
+	state->Symbols[state->NumSymbols++] = lit;
+	state->LitsFreqs[lit]++;
 }
 
-/* Writes a length-distance pair to state->Output */
-static void Deflate_LenDist(struct DeflateState* state, int len, int dist) {
-	int j;
-	/* TODO: Do we actually need the if (len_bits[j]) ????????? does writing 0 bits matter??? */
-
-	for (j = 0; len >= deflate_len[j + 1]; j++);
-	Deflate_PushLit(state, j + 257);
-	if (len_bits[j]) { Deflate_PushBits(state, len - deflate_len[j], len_bits[j]); }
-	Deflate_FlushBits(state);
+/* Adds a length-distance pair to the symbols of the current block */
+static void Deflate_AddMatch(struct DeflateState* state, int len, int dist) {
+	/* Lengths are stored as 256 + length, so they can be told apart from literals */
+	state->Symbols[state->NumSymbols++] = 256 + len;
+	state->Symbols[state->NumSymbols++] = dist;
 
-	for (j = 0; dist >= deflate_dist[j + 1]; j++);
-	Deflate_PushHuff(state, j, 5);
-	if (dist_bits[j]) { Deflate_PushBits(state, dist - deflate_dist[j], dist_bits[j]); }
-	Deflate_FlushBits(state);
+	state->LitsFreqs[257 + deflate_lenCodes[len]]++;
+	state->DistsFreqs[Deflate_DistCode(dist)]++;
 }
 
 /* Moves "current block" to "previous block", adjusting state if needed. */
 static void Deflate_MoveBlock(struct DeflateState* state) {
-	int i;
+	int i, hashSize = 1 << deflate_levels[state->Level].hashBits;
 	Mem_Copy(state->Input, state->Input + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
 	state->InputPosition = DEFLATE_BLOCK_SIZE;
 
 	/* adjust hash table offsets, removing offsets that are no longer in data at all */
-	for (i = 0; i < Array_Elems(state->Head); i++) {
+	for (i = 0; i < hashSize; i++) {
 		state->Head[i] = state->Head[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Head[i] - DEFLATE_BLOCK_SIZE);
 	}
 	for (i = 0; i < Array_Elems(state->Prev); i++) {
@@ -867,90 +991,400 @@ static void Deflate_MoveBlock(struct DeflateState* state) {
 	}
 }
 
-/* Compresses current block of data */
-static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
+/* Finds the literals and length-distance pairs that make up the current block of data */
+static void Deflate_FindMatches(struct DeflateState* state, int len) {
+	const struct DeflateLevel* level = &deflate_levels[state->Level];
+	int bits = level->hashBits;
 	cc_uint32 hash, nextHash;
-	int bestLen, maxLen, matchLen, depth;
-	int bestPos, pos, nextPos;
-	cc_uint16 oldHead;
+	int bestLen, maxLen, niceLen, matchLen, depth;
+	int bestPos, pos, nextPos, i;
 	cc_uint8* input;
 	cc_uint8* cur;
-	cc_result res;
+	cc_uint8* end;
 
-	if (!state->WroteHeader) {
-		state->WroteHeader = true;
-		Deflate_PushBits(state, 3, 3); /* final block TRUE, block type FIXED */
-	}
+	state->NumSymbols = 0;
+	Mem_Set(state->LitsFreqs,  0, sizeof(state->LitsFreqs));
+	Mem_Set(state->DistsFreqs, 0, sizeof(state->DistsFreqs));
 
 	/* Based off descriptions from http://www.gzip.org/algorithm.txt and
 	https://github.com/nothings/stb/blob/master/stb_image_write.h */
 	input = state->Input;
 	cur   = input + DEFLATE_BLOCK_SIZE;
+	end   = cur + len;
 
-	/* Compress current block of data */
 	/* Use > instead of >=, because also try match at one byte after current */
 	while (len > MIN_MATCH_LEN) {
-		hash   = Deflate_Hash(cur);
-		maxLen = min(len, MAX_MATCH_LEN);
+		hash    = Deflate_Hash(cur, bits);
+		maxLen  = min(len, MAX_MATCH_LEN);
+		niceLen = min(maxLen, level->niceLen);
 
 		bestLen = MIN_MATCH_LEN - 1; /* Match must be at least 3 bytes */
 		bestPos = 0;
 
 		/* Find longest match starting at this byte */
-		/* Only explore up to 5 previous matches, to avoid slow performance */
-		/* (i.e prefer quickly saving maps/screenshots to completely optimal filesize) */
+		/* Only explore a limited number of previous matches, to avoid slow performance */
 		pos = state->Head[hash];
-		for (depth = 0; pos != 0 && depth < 5; depth++) {
-			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
-			if (matchLen > bestLen) { bestLen = matchLen; bestPos = pos; }
+		for (depth = 0; pos != 0 && depth < level->maxChain; depth++) {
+			/* Quickly skip matches that can't be longer than the longest match so far */
+			if (input[pos + bestLen] == cur[bestLen]) {
+				matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
+				if (matchLen > bestLen) { 
+					bestLen = matchLen; bestPos = pos;
+					if (bestLen >= niceLen) break;
+				}
+			}
 			pos = state->Prev[pos];
 		}
 
 		/* Insert this entry into the hash chain */
 		pos = (int)(cur - input);
-		oldHead = state->Head[hash];
+		state->Prev[pos]  = state->Head[hash];
 		state->Head[hash] = pos;
-		state->Prev[pos]  = oldHead;
 
 		/* Lazy evaluation: Find longest match starting at next byte */
 		/* If that's longer than the longest match at current byte, throwaway this match */
-		if (bestPos) {
-			nextHash = Deflate_Hash(cur + 1);
+		if (bestPos && level->lazy && bestLen < niceLen) {
+			nextHash = Deflate_Hash(cur + 1, bits);
 			nextPos  = state->Head[nextHash];
 			maxLen   = min(len - 1, MAX_MATCH_LEN);
 
-			for (depth = 0; nextPos != 0 && depth < 5; depth++) {
-				matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
-				if (matchLen > bestLen) { bestPos = 0; break; }
+			for (depth = 0; nextPos != 0 && depth < level->maxChain; depth++) {
+				if (bestLen < maxLen && input[nextPos + bestLen] == cur[1 + bestLen]) {
+					matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
+					if (matchLen > bestLen) { bestPos = 0; break; }
+				}
 				nextPos = state->Prev[nextPos];
 			}
 		}
 
 		if (bestPos) {
-			Deflate_LenDist(state, bestLen, pos - bestPos);
-			len -= bestLen; cur += bestLen;
+			Deflate_AddMatch(state, bestLen, pos - bestPos);
+			len -= bestLen;
+
+			/* Also insert the other bytes in the match into the hash chains */
+			for (i = 1; i < bestLen && level->insertAll; i++) {
+				if (cur + i + MIN_MATCH_LEN > end) break;
+				hash = Deflate_Hash(cur + i, bits);
+
+				state->Prev[pos + i] = state->Head[hash];
+				state->Head[hash]    = pos + i;
+			}
+			cur += bestLen;
 		} else {
-			Deflate_Lit(state, *cur);
+			Deflate_AddLit(state, *cur);
 			len--; cur++;
 		}
-
-		/* leave room for a few bytes and literals at end */
-		if (state->AvailOut >= 20) continue;
-		res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-		state->NextOut  = state->Output;
-		state->AvailOut = DEFLATE_OUT_SIZE;
-		if (res) return res;
 	}
 
 	/* literals for last few bytes */
 	while (len > 0) {
-		Deflate_Lit(state, *cur);
+		Deflate_AddLit(state, *cur);
 		len--; cur++;
 	}
+	state->LitsFreqs[256] = 1; /* end of block */
+}
+
+/* Calculates codeword lengths from the weights of symbols (sorted from smallest to largest weight) */
+/*  using the in-place algorithm by Moffat and Katajainen. Lengths are stored in the weights array. */
+static void Deflate_MinimumRedundancy(int* A, int n) {
+	int root, leaf, next, avbl, used, depth;
+
+	A[0] += A[1]; root = 0; leaf = 2;
+	for (next = 1; next < n - 1; next++) {
+		if (leaf >= n || A[root] < A[leaf]) { A[next] = A[root]; A[root++] = next; }
+		else { A[next] = A[leaf++]; }
+
+		if (leaf >= n || (root < next && A[root] < A[leaf])) { A[next] += A[root]; A[root++] = next; }
+		else { A[next] += A[leaf++]; }
+	}
+
+	A[n - 2] = 0;
+	for (next = n - 3; next >= 0; next--) A[next] = A[A[next]] + 1;
+
+	avbl = 1; used = depth = 0; root = n - 2; next = n - 1;
+	while (avbl > 0) {
+		while (root >= 0 && A[root] == depth) { used++; root--; }
+		while (avbl > used) { A[next--] = depth; avbl--; }
+		avbl = 2 * used; depth++; used = 0;
+	}
+}
+
+/* Calculates huffman codeword lengths (limited to maxBits) for symbols from how often they occur */
+static void Deflate_BuildLengths(const cc_uint16* freqs, int count, int maxBits, cc_uint8* lens) {
+	cc_uint16 symbols[INFLATE_MAX_LITS];
+	int weights[INFLATE_MAX_LITS];
+	int numCodes[DEFLATE_MAX_CODE_BITS + 1];
+	int i, j, len, sym, total, n = 0;
+
+	for (i = 0; i < count; i++) {
+		lens[i] = 0;
+		if (freqs[i]) symbols[n++] = i;
+	}
+	/* Some decoders reject a huffman code with only one codeword */
+	for (i = 0; n < 2; i++) {
+		if (!freqs[i]) symbols[n++] = i;
+	}
+
+	/* Sort by how often symbols occur */
+	for (i = 1; i < n; i++) {
+		sym = symbols[i];
+		for (j = i; j > 0 && freqs[symbols[j - 1]] > freqs[sym]; j--) {
+			symbols[j] = symbols[j - 1];
+		}
+		symbols[j] = sym;
+	}
+
+	for (i = 0; i < n; i++) weights[i] = freqs[symbols[i]];
+	Deflate_MinimumRedundancy(weights, n);
+
+	/* Codewords longer than maxBits are shortened, which oversubscribes the code */
+	/* So repeatedly remove a longest codeword and split a shorter codeword in two to compensate */
+	for (i = 0; i <= maxBits; i++) numCodes[i] = 0;
+	for (i = 0; i < n; i++) numCodes[min(weights[i], maxBits)]++;
+
+	for (total = 0, i = maxBits; i > 0; i--) total += numCodes[i] << (maxBits - i);
+	for (; total > (1 << maxBits); total--) {
+		numCodes[maxBits]--;
+		for (i = maxBits - 1; i > 0; i--) {
+			if (!numCodes[i]) continue;
+			numCodes[i]--; numCodes[i + 1] += 2; break;
+		}
+	}
+
+	/* Least frequently occurring symbols get the longest codewords */
+	for (i = 0, len = maxBits; len > 0; len--) {
+		for (j = 0; j < numCodes[len]; j++) lens[symbols[i++]] = len;
+	}
+}
+
+/* Calculates the (bit reversed) canonical huffman codewords from the lengths of the codewords */
+static void Deflate_BuildCodewords(const cc_uint8* lens, int count, cc_uint16* codewords) {
+	int numCodes[INFLATE_MAX_BITS], nextCode[INFLATE_MAX_BITS];
+	int i, code = 0;
+
+	for (i = 0; i < INFLATE_MAX_BITS; i++) numCodes[i] = 0;
+	for (i = 0; i < count; i++) numCodes[lens[i]]++;
+	numCodes[0] = 0;
+
+	for (i = 1; i < INFLATE_MAX_BITS; i++) {
+		code = (code + numCodes[i - 1]) << 1;
+		nextCode[i] = code;
+	}
+	for (i = 0; i < count; i++) {
+		if (lens[i]) codewords[i] = Huffman_ReverseBits(nextCode[lens[i]]++, lens[i]);
+	}
+}
 
-	res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
+/* Run length encodes the codeword lengths of a dynamic block, returning number of codes */
+static int Deflate_EncodeLens(const cc_uint8* lens, int count, cc_uint8* codes, cc_uint8* extras) {
+	int i, run, cur, n = 0;
+
+	for (i = 0; i < count; i += run) {
+		cur = lens[i];
+		for (run = 1; i + run < count && lens[i + run] == cur; run++) { }
+
+		if (!cur && run >= 11) {
+			run = min(run, 138);
+			codes[n] = 18; extras[n++] = run - 11;
+		} else if (!cur && run >= 3) {
+			codes[n] = 17; extras[n++] = run - 3;
+		} else if (cur && run >= 4) {
+			/* Repeat code repeats the previous length, so need to output the length first */
+			codes[n] = cur; extras[n++] = 0;
+			run = 1 + min(run - 1, 6);
+			codes[n] = 16; extras[n++] = run - 4;
+		} else {
+			codes[n] = cur; extras[n++] = 0;
+			run = 1;
+		}
+	}
+	return n;
+}
+
+static cc_result Deflate_FlushOutput(struct DeflateState* state) {
+	cc_result res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
+	return res;
+}
+
+/* Writes the current block of data uncompressed */
+static cc_result Deflate_WriteStored(struct DeflateState* state, int len, cc_bool final) {
+	cc_uint8* data = state->Input + DEFLATE_BLOCK_SIZE;
+	cc_result res;
+	int count;
+
+	Deflate_PushBits(state, final, 3); /* block type STORED */
+	Deflate_FlushBits(state);
+	if (state->NumBits) { Deflate_PushBits(state, 0, 8 - state->NumBits); }
+	Deflate_FlushBits(state);
+
+	Deflate_PushBits(state, len, 16);
+	Deflate_FlushBits(state);
+	Deflate_PushBits(state, len ^ 0xFFFF, 16);
+	Deflate_FlushBits(state);
+
+	while (len > 0) {
+		if (!state->AvailOut && (res = Deflate_FlushOutput(state))) return res;
+		count = min(len, (int)state->AvailOut);
+
+		Mem_Copy(state->NextOut, data, count);
+		state->NextOut  += count;
+		state->AvailOut -= count;
+		data += count; len -= count;
+	}
+	return 0;
+}
+
+/* Writes the header of a dynamic block, which describes its codeword lengths */
+static void Deflate_WriteDynamicHeader(struct DeflateState* state, cc_bool final, int numLits, int numDists, 
+							const cc_uint8* codes, const cc_uint8* extras, int numCodes, const cc_uint8* codeLensLens) {
+	cc_uint16 codeLensCodewords[INFLATE_MAX_CODELENS];
+	int i, code, numCodeLens;
+
+	for (numCodeLens = INFLATE_MAX_CODELENS; numCodeLens > 4; numCodeLens--) {
+		if (codeLensLens[codelens_order[numCodeLens - 1]]) break;
+	}
+	Deflate_BuildCodewords(codeLensLens, INFLATE_MAX_CODELENS, codeLensCodewords);
+
+	Deflate_PushBits(state, final | (2 << 1), 3); /* block type DYNAMIC */
+	Deflate_PushBits(state, numLits  - 257, 5);
+	Deflate_PushBits(state, numDists - 1,   5);
+	Deflate_PushBits(state, numCodeLens - 4, 4);
+	Deflate_FlushBits(state);
+
+	for (i = 0; i < numCodeLens; i++) {
+		Deflate_PushBits(state, codeLensLens[codelens_order[i]], 3);
+		Deflate_FlushBits(state);
+	}
+
+	for (i = 0; i < numCodes; i++) {
+		code = codes[i];
+		Deflate_PushBits(state, codeLensCodewords[code], codeLensLens[code]);
+		if (code == 16) { Deflate_PushBits(state, extras[i], 2); }
+		if (code == 17) { Deflate_PushBits(state, extras[i], 3); }
+		if (code == 18) { Deflate_PushBits(state, extras[i], 7); }
+		Deflate_FlushBits(state);
+	}
+}
+
+/* Writes the literals and length-distance pairs of the current block */
+static cc_result Deflate_WriteSymbols(struct DeflateState* state) {
+	cc_uint16* symbols = state->Symbols;
+	int i, j, len, dist;
+	cc_result res;
+
+	for (i = 0; i < state->NumSymbols; i++) {
+		len = symbols[i];
+		if (len < 256) {
+			Deflate_PushLit(state, len);
+			Deflate_FlushBits(state);
+		} else {
+			len -= 256; dist = symbols[++i];
+
+			j = deflate_lenCodes[len];
+			Deflate_PushLit(state, j + 257);
+			Deflate_PushBits(state, len - deflate_len[j], len_bits[j]);
+			Deflate_FlushBits(state);
+
+			j = Deflate_DistCode(dist);
+			Deflate_PushDist(state, j);
+			Deflate_FlushBits(state);
+			Deflate_PushBits(state, dist - deflate_dist[j], dist_bits[j]);
+			Deflate_FlushBits(state);
+		}
+
+		/* leave room for a few bytes and literals at end */
+		if (state->AvailOut >= 20) continue;
+		if ((res = Deflate_FlushOutput(state))) return res;
+	}
+
+	/* Write huffman encoded "literal 256" to terminate symbols */
+	Deflate_PushLit(state, 256);
+	Deflate_FlushBits(state);
+	return 0;
+}
+
+/* Writes the current block using whichever of a stored, fixed or dynamic block is smallest */
+static cc_result Deflate_WriteBlock(struct DeflateState* state, int len, cc_bool final) {
+	cc_uint8 lens[INFLATE_MAX_LITS_DISTS];
+	cc_uint8 codes[INFLATE_MAX_LITS_DISTS], extras[INFLATE_MAX_LITS_DISTS];
+	cc_uint16 codeLensFreqs[INFLATE_MAX_CODELENS];
+	cc_uint8  codeLensLens[INFLATE_MAX_CODELENS];
+	cc_uint8* distLens;
+	cc_uint32 extraBits = 0, fixedBits = 3, dynamicBits = 3 + 14, storedBits;
+	int i, numLits, numDists, numCodes;
+	cc_result res;
+
+	Deflate_BuildLengths(state->LitsFreqs,  DEFLATE_NUM_LITS,  DEFLATE_MAX_CODE_BITS, lens);
+	distLens = lens + DEFLATE_NUM_LITS;
+	Deflate_BuildLengths(state->DistsFreqs, DEFLATE_NUM_DISTS, DEFLATE_MAX_CODE_BITS, distLens);
+
+	for (i = 0; i < DEFLATE_NUM_LITS; i++) {
+		fixedBits   += state->LitsFreqs[i] * fixed_lits[i];
+		dynamicBits += state->LitsFreqs[i] * lens[i];
+		if (i > 256) extraBits += state->LitsFreqs[i] * len_bits[i - 257];
+	}
+	for (i = 0; i < DEFLATE_NUM_DISTS; i++) {
+		fixedBits   += state->DistsFreqs[i] * 5;
+		dynamicBits += state->DistsFreqs[i] * distLens[i];
+		extraBits   += state->DistsFreqs[i] * dist_bits[i];
+	}
+
+	for (numLits  = DEFLATE_NUM_LITS;  numLits  > 257 && !lens[numLits - 1];      numLits--)  { }
+	for (numDists = DEFLATE_NUM_DISTS; numDists > 1   && !distLens[numDists - 1]; numDists--) { }
+	/* Distance codeword lengths immediately follow the literal codeword lengths in the header */
+	Mem_Move(lens + numLits, distLens, numDists);
+	numCodes = Deflate_EncodeLens(lens, numLits + numDists, codes, extras);
+
+	Mem_Set(codeLensFreqs, 0, sizeof(codeLensFreqs));
+	for (i = 0; i < numCodes; i++) codeLensFreqs[codes[i]]++;
+	Deflate_BuildLengths(codeLensFreqs, INFLATE_MAX_CODELENS, DEFLATE_MAX_CODELEN_BITS, codeLensLens);
+
+	dynamicBits += INFLATE_MAX_CODELENS * 3;
+	for (i = 0; i < numCodes; i++) {
+		dynamicBits += codeLensLens[codes[i]];
+		if (codes[i] == 16) dynamicBits += 2;
+		if (codes[i] == 17) dynamicBits += 3;
+		if (codes[i] == 18) dynamicBits += 7;
+	}
+
+	/* Stored blocks need 3 header bits, up to 7 bits to align to next byte, and 4 bytes of lengths */
+	storedBits = 3 + 7 + 32 + len * 8;
+	fixedBits += extraBits; dynamicBits += extraBits;
+
+	/* leave room for the block header */
+	if (state->AvailOut < 1024 && (res = Deflate_FlushOutput(state))) return res;
+
+	if (storedBits <= fixedBits && storedBits <= dynamicBits) {
+		return Deflate_WriteStored(state, len, final);
+	} else if (fixedBits <= dynamicBits) {
+		/* NOTE: All 288/32 fixed lengths are needed, as the canonical codewords of the */
+		/*  9 bit literals depend on the 8 bit lengths of the two unused symbols 286 and 287 */
+		Mem_Copy(state->LitsLens,  fixed_lits,  INFLATE_MAX_LITS);
+		Mem_Copy(state->DistsLens, fixed_dists, INFLATE_MAX_DISTS);
+		Deflate_PushBits(state, final | (1 << 1), 3); /* block type FIXED */
+	} else {
+		Mem_Copy(state->LitsLens,  lens,           numLits);
+		Mem_Set(state->LitsLens + numLits, 0,      INFLATE_MAX_LITS - numLits);
+		Mem_Copy(state->DistsLens, lens + numLits, numDists);
+		Mem_Set(state->DistsLens + numDists, 0,    INFLATE_MAX_DISTS - numDists);
+		Deflate_WriteDynamicHeader(state, final, numLits, numDists, codes, extras, numCodes, codeLensLens);
+	}
+
+	Deflate_BuildCodewords(state->LitsLens,  INFLATE_MAX_LITS,  state->LitsCodewords);
+	Deflate_BuildCodewords(state->DistsLens, INFLATE_MAX_DISTS, state->DistsCodewords);
+	return Deflate_WriteSymbols(state);
+}
+
+/* Compresses current block of data */
+static cc_result Deflate_FlushBlock(struct DeflateState* state, int len, cc_bool final) {
+	cc_result res;
+	Deflate_FindMatches(state, len);
+
+	res = Deflate_WriteBlock(state, len, final);
+	if (res) return res;
+	res = Deflate_FlushOutput(state);
 
 	Deflate_MoveBlock(state);
 	return res;
@@ -978,26 +1412,22 @@ static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data
 		data += len;
 
 		if (state->InputPosition == DEFLATE_BUFFER_SIZE) {
-			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE);
+			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE, false);
 			if (res) return res;
 		}
 	}
 	return 0;
 }
 
-/* Flushes any buffered data, then writes terminating symbol */
+/* Flushes any buffered data as the final block */
 static cc_result Deflate_StreamClose(struct Stream* stream) {
 	struct DeflateState* state;
 	cc_result res;
 
 	state = (struct DeflateState*)stream->meta.inflate;
-	res   = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE);
+	res   = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE, true);
 	if (res) return res;
 
-	/* Write huffman encoded "literal 256" to terminate symbols */
-	Deflate_PushLit(state, 256);
-	Deflate_FlushBits(state);
-
 	/* In case last byte still has a few extra bits */
 	if (state->NumBits) {
 		while (state->NumBits < 8) { Deflate_PushBits(state, 0, 1); }
@@ -1007,31 +1437,12 @@ static cc_result Deflate_StreamClose(struct Stream* stream) {
 	return Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
 }
 
-/* Constructs a huffman encoding table (for values to codewords) */
-static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
-	int i, j, offset, codeword;
-	struct HuffmanTable table;
-
-	/* NOTE: Can ignore since lens table is not user controlled */
-	(void)Huffman_Build(&table, lens, count);
-	for (i = 0; i < INFLATE_MAX_BITS; i++) {
-		if (!table.endCodewords[i]) continue;
-		count = table.endCodewords[i] - table.firstCodewords[i];
-
-		for (j = 0; j < count; j++) {
-			offset   = table.values[table.firstOffsets[i] + j];
-			codeword = table.firstCodewords[i] + j;
-			bitlens[offset]   = i;
-			codewords[offset] = Huffman_ReverseBits(codeword, i);
-		}
-	}
-}
-
 void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying) {
 	Stream_Init(stream);
 	stream->meta.inflate = state;
 	stream->Write = Deflate_StreamWrite;
 	stream->Close = Deflate_StreamClose;
+	Deflate_InitCodes();
 
 	/* First half of buffer is "previous block" */
 	state->InputPosition = DEFLATE_BLOCK_SIZE;
@@ -1041,11 +1452,85 @@ void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struc
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
 	state->Dest     = underlying;
-	state->WroteHeader = false;
+	state->Level    = DEFLATE_LEVEL_DEFAULT;
 
 	Mem_Set(state->Head, 0, sizeof(state->Head));
 	Mem_Set(state->Prev, 0, sizeof(state->Prev));
-	Deflate_BuildTable(fixed_lits, INFLATE_MAX_LITS, state->LitsCodewords, state->LitsLens);
+}
+
+void Deflate_SetLevel(struct DeflateState* state, int level) {
+	/* Level is used to index into deflate_levels */
+	state->Level = max(0, min(level, DEFLATE_LEVEL_COUNT - 1));
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Deflate benchmarking----------------------------------------------------*
+*#########################################################################################################################*/
+static const char* const deflate_levelNames[DEFLATE_LEVEL_COUNT] = { "Fastest", "Fast", "Default", "Best" };
+
+static cc_result Deflate_MemoryWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	count = min(count, s->meta.mem.left);
+	Mem_Copy(s->meta.mem.cur, data, count);
+
+	s->meta.mem.cur  += count;
+	s->meta.mem.left -= count;
+	*modified = count;
+	return count ? 0 : ERR_END_OF_STREAM;
+}
+
+cc_bool Deflate_Benchmark(const cc_uint8* data, cc_uint32 size, struct DeflateBenchmark* results) {
+	/* Stored blocks add 5 bytes per block of data, so compressed output is never much larger than input */
+	cc_uint32 capacity = size + size / 16 + 1024;
+	struct DeflateState* deflate;
+	struct InflateState* inflate;
+	cc_uint8* compressed;
+	cc_uint8* decompressed;
+	struct DeflateBenchmark* r;
+	struct Stream mem, stream;
+	cc_uint64 beg;
+	cc_result res;
+	cc_bool ok;
+	int level;
+
+	deflate      = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	inflate      = (struct InflateState*)Mem_TryAlloc(1, sizeof(struct InflateState));
+	compressed   = (cc_uint8*)Mem_TryAlloc(capacity, 1);
+	decompressed = (cc_uint8*)Mem_TryAlloc(size + 1, 1);
+
+	ok = deflate && inflate && compressed && decompressed;
+
+	for (level = 0; ok && level < DEFLATE_LEVEL_COUNT; level++) 
+	{
+		r = &results[level];
+		r->name = deflate_levelNames[level];
+
+		Stream_ReadonlyMemory(&mem, compressed, capacity);
+		mem.Write = Deflate_MemoryWrite;
+
+		beg = Stopwatch_Measure();
+		Deflate_MakeStream(&stream, deflate, &mem);
+		Deflate_SetLevel(deflate, level);
+
+		res = Stream_Write(&stream, data, size);
+		if (!res) res = stream.Close(&stream);
+		r->compressTime   = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+		r->compressedSize = capacity - mem.meta.mem.left;
+
+		Stream_ReadonlyMemory(&mem, compressed, r->compressedSize);
+		beg = Stopwatch_Measure();
+		Inflate_MakeStream2(&stream, inflate, &mem);
+
+		if (!res) res = Stream_Read(&stream, decompressed, size);
+		r->decompressTime = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+		r->verified       = !res && Mem_Equal(decompressed, data, size);
+	}
+
+	Mem_Free(deflate);
+	Mem_Free(inflate);
+	Mem_Free(compressed);
+	Mem_Free(decompressed);
+	return ok;
 }
 
 
@@ -1065,15 +1550,8 @@ static cc_result GZip_StreamClose(struct Stream* stream) {
 
 static cc_result GZip_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct GZipState* state = (struct GZipState*)stream->meta.inflate;
-	cc_uint32 i, crc32 = state->Crc32;
 	state->Size += count;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		crc32 = Utils_Crc32Table[(crc32 ^ data[i]) & 0xFF] ^ (crc32 >> 8);
-	}
-
-	state->Crc32 = crc32;
+	state->Crc32 = Utils_UpdateCRC32(state->Crc32, data, count);
 	return Deflate_StreamWrite(stream, data, count, modified);
 }
 
@@ -1111,17 +1589,7 @@ static cc_result ZLib_StreamClose(struct Stream* stream) {
 
 static cc_result ZLib_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct ZLibState* state = (struct ZLibState*)stream->meta.inflate;
-	cc_uint32 i, adler32 = state->Adler32;
-	cc_uint32 s1 = adler32 & 0xFFFF, s2 = (adler32 >> 16) & 0xFFFF;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		#define ADLER32_BASE 65521
-		s1 = (s1 + data[i]) % ADLER32_BASE;
-		s2 = (s2 + s1)      % ADLER32_BASE;
-	}
-
-	state->Adler32 = (s2 << 16) | s1;
+	state->Adler32 = Utils_UpdateAdler32(state->Adler32, data, count);
 	return Deflate_StreamWrite(stream, data, count, modified);
 }
 
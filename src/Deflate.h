@@ -30,25 +30,32 @@ cc_result ZLibHeader_Read(struct Stream* s, struct ZLibHeader* header);
 #define INFLATE_MAX_LITS_DISTS (INFLATE_MAX_LITS + INFLATE_MAX_DISTS)
 #define INFLATE_MAX_BITS 16
 
-#define INFLATE_FAST_BITS 9
-#define INFLATE_FAST_LEN_SHIFT 9
-#define INFLATE_FAST_VAL_MASK  0x1FF
+#define INFLATE_FAST_BITS 10
+#define INFLATE_FAST_MASK ((1 << INFLATE_FAST_BITS) - 1)
 
 #define INFLATE_WINDOW_SIZE 0x8000UL
 #define INFLATE_WINDOW_MASK 0x7FFFUL
 
+/* 64 bit CPUs can buffer twice as many bits at no extra cost */
+#if defined __LP64__ || defined _WIN64
+	#define INFLATE_64BIT_BUFFER
+	typedef cc_uint64 InflateBits;
+#else
+	typedef cc_uint32 InflateBits;
+#endif
+
 struct HuffmanTable {
-	cc_int16 fast[1 << INFLATE_FAST_BITS];      /* Fast lookup table for huffman codes */
+	cc_uint32 fast[1 << INFLATE_FAST_BITS];     /* Fast lookup table for huffman codes (0 for longer codewords) */
 	cc_uint16 firstCodewords[INFLATE_MAX_BITS]; /* Starting codeword for each bit length */
 	cc_uint16 endCodewords[INFLATE_MAX_BITS];   /* (Last codeword + 1) for each bit length. 0 is ignored. */
 	cc_uint16 firstOffsets[INFLATE_MAX_BITS];   /* Base offset into Values for codewords of each bit length. */
-	cc_uint16 values[INFLATE_MAX_LITS];         /* Values/Symbols list */
+	cc_uint32 values[INFLATE_MAX_LITS];         /* Values/Symbols list (same format as fast table entries) */
 };
 
 struct InflateState {
 	cc_uint8 State;
 	cc_bool LastBlock; /* Whether the last DEFLATE block has been encounted in the stream */
-	cc_uint32 Bits;    /* Holds bits across byte boundaries */
+	InflateBits Bits;  /* Holds bits across byte boundaries */
 	cc_uint32 NumBits; /* Number of bits in Bits buffer */
 
 	cc_uint8* NextIn;   /* Pointer within Input buffer to next byte that can be read */
@@ -87,8 +94,7 @@ CC_API void Inflate_MakeStream2(struct Stream* stream, struct InflateState* stat
 #define DEFLATE_BLOCK_SIZE  16384
 #define DEFLATE_BUFFER_SIZE 32768
 #define DEFLATE_OUT_SIZE 8192
-#define DEFLATE_HASH_SIZE 0x1000UL
-#define DEFLATE_HASH_MASK 0x0FFFUL
+#define DEFLATE_HASH_SIZE 0x4000UL
 struct DeflateState {
 	cc_uint32 Bits;         /* Holds bits across byte boundaries */
 	cc_uint32 NumBits;      /* Number of bits in Bits buffer */
@@ -97,9 +103,14 @@ struct DeflateState {
 	cc_uint8* NextOut;    /* Pointer within Output buffer to next byte that can be written */
 	cc_uint32 AvailOut;   /* Max number of bytes that can be written to Output buffer */
 	struct Stream* Dest; /* Destination that Output buffer is written to */
-
-	cc_uint16 LitsCodewords[INFLATE_MAX_LITS]; /* Codewords for each value */
-	cc_uint8 LitsLens[INFLATE_MAX_LITS];       /* Bit lengths of each codeword */
+	int Level;           /* How hard to try to find matches (see DEFLATE_LEVEL_ enum) */
+
+	cc_uint16 LitsCodewords[INFLATE_MAX_LITS];   /* Codewords for each literal/length */
+	cc_uint8 LitsLens[INFLATE_MAX_LITS];         /* Bit lengths of each literal/length codeword */
+	cc_uint16 DistsCodewords[INFLATE_MAX_DISTS]; /* Codewords for each distance */
+	cc_uint8 DistsLens[INFLATE_MAX_DISTS];       /* Bit lengths of each distance codeword */
+	cc_uint16 LitsFreqs[INFLATE_MAX_LITS];       /* Number of times each literal/length occurs in current block */
+	cc_uint16 DistsFreqs[INFLATE_MAX_DISTS];     /* Number of times each distance occurs in current block */
 	
 	cc_uint8 Input[DEFLATE_BUFFER_SIZE];
 	cc_uint8 Output[DEFLATE_OUT_SIZE];
@@ -107,12 +118,36 @@ struct DeflateState {
 	cc_uint16 Prev[DEFLATE_BUFFER_SIZE];
 	/* NOTE: The largest possible value that can get */
 	/*  stored in Head/Prev is <= DEFLATE_BUFFER_SIZE */
-	cc_bool WroteHeader;
+
+	/* Literals and length-distance pairs in current block (lengths are stored as 256 + length) */
+	cc_uint16 Symbols[DEFLATE_BLOCK_SIZE];
+	int NumSymbols;
 };
 /* Compresses input data using DEFLATE, then writes compressed output to another stream. Write only stream. */
 /* DEFLATE compression is pure compressed data, there is no header or footer. */
 CC_API void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying);
 
+enum DEFLATE_LEVEL_ {
+	DEFLATE_LEVEL_FASTEST, DEFLATE_LEVEL_FAST, DEFLATE_LEVEL_DEFAULT, DEFLATE_LEVEL_BEST, DEFLATE_LEVEL_COUNT
+};
+/* Sets how hard the compressor tries to find matches (default is DEFLATE_LEVEL_DEFAULT) */
+/*  Higher levels produce smaller output, but are slower. Must be called before writing any data. */
+/* NOTE: Levels outside the valid range are clamped to the nearest valid level */
+CC_API void Deflate_SetLevel(struct DeflateState* state, int level);
+
+/* Size of and time taken to compress and decompress data at a compression level */
+struct DeflateBenchmark {
+	const char* name;         /* Name of the compression level */
+	cc_uint32 compressedSize; /* Number of bytes of compressed output */
+	/* Time taken (in microseconds) compressing and decompressing the data */
+	cc_uint64 compressTime, decompressTime;
+	cc_bool verified;         /* Whether decompressing the output gave back the original data */
+};
+/* Compresses the given data at each compression level, then decompresses it again and checks */
+/*  that it matches the original data. Results must have room for DEFLATE_LEVEL_COUNT entries. */
+/* Returns false when not enough memory to benchmark */
+cc_bool Deflate_Benchmark(const cc_uint8* data, cc_uint32 size, struct DeflateBenchmark* results);
+
 struct GZipState { struct DeflateState Base; cc_uint32 Crc32, Size; };
 /* Compresses input data using GZIP, then writes compressed output to another stream. Write only stream. */
 /* GZIP compression is GZIP header, followed by DEFLATE compressed data, followed by GZIP footer. */
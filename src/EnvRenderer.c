@@ -453,6 +453,28 @@ void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID n
 	}
 }
 
+void EnvRenderer_OnBlocksChanged(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count) {
+	cc_bool didBlock, nowBlock;
+	int i, hIndex;
+
+	for (i = 0; i < count; i++) 
+	{
+		didBlock = !(Blocks.Draw[oldBlocks[i]] == DRAW_GAS || Blocks.Draw[oldBlocks[i]] == DRAW_SPRITE);
+		nowBlock = !(Blocks.Draw[blocks[i]]    == DRAW_GAS || Blocks.Draw[blocks[i]]    == DRAW_SPRITE);
+		if (didBlock == nowBlock) continue;
+
+		hIndex = Weather_Pack(coords[i].x, coords[i].z);
+		if (coords[i].y < Weather_Heightmap[hIndex]) continue;
+
+		if (nowBlock) {
+			Weather_Heightmap[hIndex] = coords[i].y;
+		} else {
+			/* Rain height is recalculated once when next needed, instead of for each block changed in the column */
+			Weather_Heightmap[hIndex] = Int16_MaxValue;
+		}
+	}
+}
+
 static float CalcRainAlphaAt(float x) {
 	/* Wolfram Alpha: fit {0,178},{1,169},{4,147},{9,114},{16,59},{25,9} */
 	float falloff = 0.05f * x * x - 7 * x;
@@ -1,6 +1,7 @@
 #ifndef CC_ENVRENDERER_H
 #define CC_ENVRENDERER_H
 #include "Core.h"
+#include "Vectors.h"
 CC_BEGIN_HEADER
 
 /* 
@@ -32,6 +33,8 @@ cc_bool EnvRenderer_ShouldRenderSkybox(void);
 extern cc_int16* Weather_Heightmap;
 /* Called when a block is changed to update internal weather state. */
 void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+/* Called when multiple blocks are changed at once to update internal weather state. */
+void EnvRenderer_OnBlocksChanged(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count);
 /* Renders rainfall/snowfall weather. */
 void EnvRenderer_RenderWeather(float delta);
 
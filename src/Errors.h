@@ -138,5 +138,6 @@ enum CC_ERRORS {
 	SSL_ERR_CONTEXT_DEAD = 0xCCDED070UL, /* Server shutdown the SSL context and it must be recreated */
 	PNG_ERR_16BITSAMPLES = 0xCCDED071UL, /* Image uses 16 bit samples, which is unimplemented */
 	ERR_NO_NETWORKING    = 0xCCDED072UL, /* No working network connection */
+	NET_ERR_CAPTURE_SIG  = 0xCCDED073UL, /* Bytes #1-#8 of network capture aren't "CCNETCAP" */
 };
 #endif
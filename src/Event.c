@@ -1,7 +1,7 @@
 #include "Event.h"
 #include "Platform.h"
 
-int EventAPIVersion = 4;
+int EventAPIVersion = 5;
 struct _EntityEventsList        EntityEvents;
 struct _TabListEventsList       TabListEvents;
 struct _TextureEventsList       TextureEvents;
@@ -83,6 +83,7 @@ void Event_UnregisterAll(void) {
 	WorldEvents.MapLoaded.Count = 0;
 	WorldEvents.EnvVarChanged.Count = 0;
 	WorldEvents.LightingModeChanged.Count = 0;
+	WorldEvents.BlocksChanged.Count = 0;
 
 	ChatEvents.FontChanged.Count    = 0;
 	ChatEvents.ChatReceived.Count   = 0;
@@ -153,6 +154,13 @@ void Event_RaiseBlock(struct Event_Block* handlers, IVec3 coords, BlockID oldBlo
 	}
 }
 
+void Event_RaiseBlocks(struct Event_Blocks* handlers, const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count) {
+	int i;
+	for (i = 0; i < handlers->Count; i++) {
+		handlers->Handlers[i](handlers->Objs[i], coords, oldBlocks, blocks, count);
+	}
+}
+
 void Event_RaiseChat(struct Event_Chat* handlers, const cc_string* msg, int msgType) {
 	int i;
 	for (i = 0; i < handlers->Count; i++) {
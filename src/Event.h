@@ -43,6 +43,12 @@ struct Event_Block {
 	void* Objs[EVENT_MAX_CALLBACKS]; int Count;
 };
 
+typedef void (*Event_Blocks_Callback)(void* obj, const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count);
+struct Event_Blocks {
+	Event_Blocks_Callback Handlers[EVENT_MAX_CALLBACKS];
+	void* Objs[EVENT_MAX_CALLBACKS]; int Count;
+};
+
 typedef void (*Event_Chat_Callback)(void* obj, const cc_string* msg, int msgType);
 struct Event_Chat {
 	Event_Chat_Callback Handlers[EVENT_MAX_CALLBACKS];
@@ -107,6 +113,9 @@ void Event_RaiseEntry(struct Event_Entry* handlers, struct Stream* stream, const
 /* Calls all registered callbacks for an event which takes block change arguments. */
 /* These are the coordinates/location of the change, block there before, block there now. */
 void Event_RaiseBlock(struct Event_Block* handlers, IVec3 coords, BlockID oldBlock, BlockID block);
+/* Calls all registered callbacks for an event which takes multiple block changes arguments. */
+/* These are the coordinates/location of each change, blocks there before, blocks there now. */
+void Event_RaiseBlocks(struct Event_Blocks* handlers, const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count);
 /* Calls all registered callbacks for an event which has chat message type and contents. */
 /* See MsgType enum in Chat.h for what types of messages there are. */
 void Event_RaiseChat(struct Event_Chat* handlers, const cc_string* msg, int msgType);
@@ -132,6 +141,7 @@ void Event_UnregisterAll(void);
 /*  Version 2 - Added WindowEvents.Redrawing */
 /*  Version 3 - Changed InputEvent.Press from code page 437 to unicode character */
 /*  Version 4 - Added InputEvents.Down2 and InputEvents.Up2 */
+/*  Version 5 - Added WorldEvents.BlocksChanged */
 /* You MUST CHECK the event API version before attempting to use the events listed above, */
 /*  as otherwise if the player is using an older client that lacks some of the above events, */
 /*  you will be calling Event_Register on random data instead of the expected EventsList struct */
@@ -180,6 +190,7 @@ CC_VAR extern struct _WorldEventsList {
 	struct Event_Void  MapLoaded;     /* New world has finished loading, player can now interact with it */
 	struct Event_Int   EnvVarChanged; /* World environment variable changed by player/CPE/WoM config */
 	struct Event_LightingMode LightingModeChanged; /* Lighting mode changed. */
+	struct Event_Blocks BlocksChanged; /* Many blocks in the world are changed at once (e.g. by a bulk block update) */
 } WorldEvents;
 
 CC_VAR extern struct _ChatEventsList {
@@ -12,6 +12,7 @@
 #include "ExtMath.h"
 #include "Options.h"
 #include "Queue.h"
+#include "Builder.h"
 
 struct LightNode {
 	IVec3 coords; /* 12 bytes */
@@ -21,6 +22,17 @@ struct LightNode {
 
 static struct Queue lightQueue;
 static struct Queue unlightQueue;
+/* Light nodes of each brightness level, for spreading light from many sources at once */
+static struct Queue lightBuckets[FANCY_LIGHTING_LEVELS];
+
+static void InitLightBuckets(struct Queue* buckets) {
+	int i;
+	for (i = 0; i < FANCY_LIGHTING_LEVELS; i++) Queue_Init(&buckets[i], sizeof(struct LightNode));
+}
+static void ClearLightBuckets(struct Queue* buckets) {
+	int i;
+	for (i = 0; i < FANCY_LIGHTING_LEVELS; i++) Queue_Clear(&buckets[i]);
+}
 
 /* Top face, X face, Z face, bottomY face*/
 #define PALETTE_SHADES 4
@@ -41,11 +53,28 @@ static PackedCol* palettes[PALETTE_COUNT];
 
 typedef cc_uint8* LightingChunk;
 static cc_uint8* chunkLightingDataFlags;
+/* NOTE: States are ordered by how far along light calculation is (see CalcForChunkIfNeeded) */
 #define CHUNK_UNCALCULATED 0
-#define CHUNK_SELF_CALCULATED 1
-#define CHUNK_ALL_CALCULATED 2
+/* Chunk is in the batch of chunks having their light calculated on worker threads */
+#define CHUNK_SELF_QUEUED 1
+#define CHUNK_SELF_CALCULATED 2
+#define CHUNK_ALL_CALCULATED 3
 static LightingChunk* chunkLightingData;
 
+/* How the light data of each chunk is stored */
+static cc_uint8* chunkLightingFormats;
+/* Every cell in the chunk has the same light value, which is stored in chunkLightingUniform */
+#define LIGHT_FORMAT_UNIFORM 0
+/* Palette of up to 16 light values, followed by a 4 bit palette index for each cell */
+#define LIGHT_FORMAT_PACKED  1
+/* Light value of each cell is stored directly */
+#define LIGHT_FORMAT_FULL    2
+static cc_uint8* chunkLightingUniform;
+
+#define PACKED_PALETTE_SIZE 16
+#define PACKED_CHUNK_SIZE (PACKED_PALETTE_SIZE + CHUNK_SIZE_3 / 2)
+#define PackedChunk_Get(data, i) data[(data[PACKED_PALETTE_SIZE + ((i) >> 1)] >> (((i) & 1) << 2)) & 0x0F]
+
 #define MakePaletteIndex(lampLevel, lavaLevel) ((lampLevel << FANCY_LIGHTING_LAMP_SHIFT) | lavaLevel)
 /* Fill in a palette with values based on the current light colors, shaded by the given shade value and lightened by the given ambientColor */
 static void InitPalette(PackedCol* palette, float shaded, PackedCol ambientColor) {
@@ -108,8 +137,11 @@ static void AllocState(void) {
 
 	chunkLightingDataFlags = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light flags");
 	chunkLightingData = (LightingChunk*)Mem_AllocCleared(chunksCount, sizeof(LightingChunk), "light chunks");
+	chunkLightingFormats = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light formats");
+	chunkLightingUniform = (cc_uint8*)Mem_AllocCleared(chunksCount, sizeof(cc_uint8), "light uniform");
 	Queue_Init(&lightQueue, sizeof(struct LightNode));
 	Queue_Init(&unlightQueue, sizeof(struct LightNode));
+	InitLightBuckets(lightBuckets);
 }
 
 static void FreeState(void) {
@@ -127,10 +159,15 @@ static void FreeState(void) {
 
 	Mem_Free(chunkLightingDataFlags);
 	Mem_Free(chunkLightingData);
+	Mem_Free(chunkLightingFormats);
+	Mem_Free(chunkLightingUniform);
 	chunkLightingDataFlags = NULL;
 	chunkLightingData = NULL;
+	chunkLightingFormats = NULL;
+	chunkLightingUniform = NULL;
 	Queue_Clear(&lightQueue);
 	Queue_Clear(&unlightQueue);
+	ClearLightBuckets(lightBuckets);
 }
 
 /* Converts chunk x/y/z coordinates to the corresponding index in chunks array/list */
@@ -140,41 +177,114 @@ static void FreeState(void) {
 /* Converts global x/y/z coordinates to the corresponding index in a chunk */
 #define GlobalCoordsToChunkCoordsIndex(x, y, z) (LocalCoordsToIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK))
 
+/* Returns the light data (lamp and lava level) of the given cell in the given chunk */
+static cc_uint8 GetLightData(int chunkIndex, int localIndex) {
+	cc_uint8* data = chunkLightingData[chunkIndex];
+
+	switch (chunkLightingFormats[chunkIndex]) {
+	case LIGHT_FORMAT_FULL:
+		return data[localIndex];
+	case LIGHT_FORMAT_PACKED:
+		return PackedChunk_Get(data, localIndex);
+	}
+	return chunkLightingUniform[chunkIndex];
+}
+
+/* Returns the light data of the given chunk, converting it to full format first if necessary */
+/*  (returns NULL when out of memory) */
+static cc_uint8* GetFullChunk(int chunkIndex) {
+	cc_uint8* data = chunkLightingData[chunkIndex];
+	cc_uint8* full;
+	int i;
+	if (chunkLightingFormats[chunkIndex] == LIGHT_FORMAT_FULL) return data;
+
+	full = (cc_uint8*)Mem_TryAlloc(CHUNK_SIZE_3, sizeof(cc_uint8));
+	if (!full) return NULL;
+
+	if (chunkLightingFormats[chunkIndex] == LIGHT_FORMAT_PACKED) {
+		for (i = 0; i < CHUNK_SIZE_3; i++) full[i] = PackedChunk_Get(data, i);
+	} else {
+		Mem_Set(full, chunkLightingUniform[chunkIndex], CHUNK_SIZE_3);
+	}
+
+	Mem_Free(data);
+	chunkLightingData[chunkIndex]    = full;
+	chunkLightingFormats[chunkIndex] = LIGHT_FORMAT_FULL;
+	return full;
+}
+
+/* Converts the light data of the given chunk to the smallest format that can store it */
+/*  (chunks are converted back to full format whenever their light changes) */
+static void CompressChunk(int chunkIndex) {
+	cc_uint8* data = chunkLightingData[chunkIndex];
+	cc_uint8 palette[PACKED_PALETTE_SIZE];
+	cc_uint8 indices[256];
+	cc_uint8* packed;
+	int i, count = 0;
+	if (chunkLightingFormats[chunkIndex] != LIGHT_FORMAT_FULL) return;
+
+	Mem_Set(indices, 0xFF, sizeof(indices));
+	for (i = 0; i < CHUNK_SIZE_3; i++) 
+	{
+		if (indices[data[i]] != 0xFF) continue;
+		/* Too many different light values to fit in a palette */
+		if (count == PACKED_PALETTE_SIZE) return;
+
+		indices[data[i]] = count;
+		palette[count++] = data[i];
+	}
+
+	if (count == 1) {
+		chunkLightingUniform[chunkIndex] = palette[0];
+		chunkLightingFormats[chunkIndex] = LIGHT_FORMAT_UNIFORM;
+		chunkLightingData[chunkIndex]    = NULL;
+		Mem_Free(data); return;
+	}
+
+	packed = (cc_uint8*)Mem_TryAllocCleared(PACKED_CHUNK_SIZE, sizeof(cc_uint8));
+	if (!packed) return;
+	Mem_Copy(packed, palette, count);
+
+	for (i = 0; i < CHUNK_SIZE_3; i += 2) 
+	{
+		packed[PACKED_PALETTE_SIZE + (i >> 1)] = indices[data[i]] | (indices[data[i + 1]] << 4);
+	}
+
+	chunkLightingData[chunkIndex]    = packed;
+	chunkLightingFormats[chunkIndex] = LIGHT_FORMAT_PACKED;
+	Mem_Free(data);
+}
+
 /* Sets the light level at this cell. Does NOT check that the cell is in bounds. */
 static void SetBrightness(cc_uint8 brightness, int x, int y, int z, cc_bool isLamp, cc_bool refreshChunk) {
-	cc_uint8 clearMask, shift = isLamp ? FANCY_LIGHTING_LAMP_SHIFT : 0, prevValue;
+	cc_uint8 clearMask, shift = isLamp ? FANCY_LIGHTING_LAMP_SHIFT : 0, prevValue, newValue;
 	int cx = x >> CHUNK_SHIFT, lx = x & CHUNK_MASK;
 	int cy = y >> CHUNK_SHIFT, ly = y & CHUNK_MASK;
 	int cz = z >> CHUNK_SHIFT, lz = z & CHUNK_MASK;
 	int chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
 	int localIndex = LocalCoordsToIndex(lx, ly, lz);
-
-	if (chunkLightingData[chunkIndex] == NULL) {
-		chunkLightingData[chunkIndex] = (cc_uint8*)Mem_TryAllocCleared(CHUNK_SIZE_3, sizeof(cc_uint8));
-	}
+	cc_uint8* data;
 
 	/* 00001111 if lamp, otherwise 11110000*/
 	clearMask = ~(FANCY_LIGHTING_MAX_LEVEL << shift);
 
+	prevValue = GetLightData(chunkIndex, localIndex);
+	newValue  = (prevValue & clearMask) | (brightness << shift);
+	/* Avoid needlessly converting compressed light data to full format */
+	if (prevValue == newValue) return;
+
+	data = GetFullChunk(chunkIndex);
+	if (!data) return;
+	data[localIndex] = newValue;
+
+	/* There is no reason to refresh current chunk as the builder does that automatically */
 	if (refreshChunk) {
-		prevValue = chunkLightingData[chunkIndex][localIndex];
-
-		chunkLightingData[chunkIndex][localIndex] &= clearMask;
-		chunkLightingData[chunkIndex][localIndex] |= brightness << shift;
-
-		/* There is no reason to refresh current chunk as the builder does that automatically */
-		if (prevValue != chunkLightingData[chunkIndex][localIndex]) {
-			if (lx == CHUNK_MAX) MapRenderer_RefreshChunk(cx + 1, cy, cz);
-			if (lx == 0)         MapRenderer_RefreshChunk(cx - 1, cy, cz);
-			if (ly == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy + 1, cz);
-			if (ly == 0)         MapRenderer_RefreshChunk(cx, cy - 1, cz);
-			if (lz == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy, cz + 1);
-			if (lz == 0)         MapRenderer_RefreshChunk(cx, cy, cz - 1);
-		}
-	}
-	else {
-		chunkLightingData[chunkIndex][localIndex] &= clearMask;
-		chunkLightingData[chunkIndex][localIndex] |= brightness << shift;
+		if (lx == CHUNK_MAX) MapRenderer_RefreshChunk(cx + 1, cy, cz);
+		if (lx == 0)         MapRenderer_RefreshChunk(cx - 1, cy, cz);
+		if (ly == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy + 1, cz);
+		if (ly == 0)         MapRenderer_RefreshChunk(cx, cy - 1, cz);
+		if (lz == CHUNK_MAX) MapRenderer_RefreshChunk(cx, cy, cz + 1);
+		if (lz == 0)         MapRenderer_RefreshChunk(cx, cy, cz - 1);
 	}
 }
 /* Returns the light level at this cell. Does NOT check that the cell is in bounds. */
@@ -182,14 +292,12 @@ static cc_uint8 GetBrightness(int x, int y, int z, cc_bool isLamp) {
 	int cx = x >> CHUNK_SHIFT, lx = x & CHUNK_MASK;
 	int cy = y >> CHUNK_SHIFT, ly = y & CHUNK_MASK;
 	int cz = z >> CHUNK_SHIFT, lz = z & CHUNK_MASK;
-	int chunkIndex = ChunkCoordsToIndex(cx, cy, cz), localIndex;
-
-	if (chunkLightingData[chunkIndex] == NULL) { return 0; }
-	localIndex = LocalCoordsToIndex(lx, ly, lz);
+	int chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+	cc_uint8 lightData = GetLightData(chunkIndex, LocalCoordsToIndex(lx, ly, lz));
 
 	return isLamp ?
-		chunkLightingData[chunkIndex][localIndex] >> FANCY_LIGHTING_LAMP_SHIFT :
-		chunkLightingData[chunkIndex][localIndex] & FANCY_LIGHTING_MAX_LEVEL;
+		lightData >> FANCY_LIGHTING_LAMP_SHIFT :
+		lightData & FANCY_LIGHTING_MAX_LEVEL;
 }
 
 
@@ -214,51 +322,76 @@ static cc_bool CanLightPass(BlockID thisBlock, Face face) {
 	return !Block_IsFaceHidden(BLOCK_STONE, thisBlock, face);
 }
 
-#define Light_TrySpreadInto(axis, AXIS, dir, limit, isLamp, thisFace, thatFace) \
+#define Light_TrySpreadInto(queue, get_brightness, axis, AXIS, dir, limit, thisFace, thatFace) \
 	if (ln.coords.axis dir ## = limit && \
 		CanLightPass(thisBlock, FACE_ ## AXIS ## thisFace) && \
 		CanLightPass(World_GetBlock(ln.coords.x, ln.coords.y, ln.coords.z), FACE_ ## AXIS ## thatFace) && \
-		GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, isLamp) < ln.brightness) { \
-		Queue_Enqueue(&lightQueue, &ln); \
+		get_brightness(ln.coords.x, ln.coords.y, ln.coords.z) < ln.brightness) { \
+		Queue_Enqueue(queue, &ln); \
 	} \
 
+/* Spreads out the light of every node in the queue, using the given functions to get/set light levels */
+/*  (nodes for the cells that light spreads into are added to next_queue) */
+#define FlushLightQueueBody(queue, next_queue, get_brightness, set_brightness) \
+	while ((queue)->count > 0) { \
+		ln = *(struct LightNode*)(Queue_Dequeue(queue)); \
+\
+		brightnessHere = get_brightness(ln.coords.x, ln.coords.y, ln.coords.z); \
+\
+		/* If this cell is already more lit, we can assume this cell and its neighbors have been accounted for */ \
+		if (brightnessHere >= ln.brightness) { continue; } \
+		if (ln.brightness == 0) { continue; } \
+\
+		set_brightness(ln.brightness, ln.coords.x, ln.coords.y, ln.coords.z); \
+\
+		thisBlock = World_GetBlock(ln.coords.x, ln.coords.y, ln.coords.z); \
+		ln.brightness--; \
+		if (ln.brightness == 0) continue; \
+\
+		ln.coords.x--; \
+		Light_TrySpreadInto(next_queue, get_brightness, x, X, > , 0, MAX, MIN) \
+		ln.coords.x += 2; \
+		Light_TrySpreadInto(next_queue, get_brightness, x, X, < , World.MaxX, MIN, MAX) \
+		ln.coords.x--; \
+\
+		ln.coords.y--; \
+		Light_TrySpreadInto(next_queue, get_brightness, y, Y, >, 0, MAX, MIN) \
+		ln.coords.y += 2; \
+		Light_TrySpreadInto(next_queue, get_brightness, y, Y, <, World.MaxY, MIN, MAX) \
+		ln.coords.y--; \
+\
+		ln.coords.z--; \
+		Light_TrySpreadInto(next_queue, get_brightness, z, Z, > , 0, MAX, MIN) \
+		ln.coords.z += 2; \
+		Light_TrySpreadInto(next_queue, get_brightness, z, Z, < , World.MaxZ, MIN, MAX) \
+	}
+
+#define Shared_GetBrightness(x, y, z) GetBrightness(x, y, z, isLamp)
+#define Shared_SetBrightness(brightness, x, y, z) SetBrightness(brightness, x, y, z, isLamp, refreshChunk)
+
 static void FlushLightQueue(cc_bool isLamp, cc_bool refreshChunk) {
 	struct LightNode ln;
 	cc_uint8 brightnessHere;
 	BlockID thisBlock;
 
-	while (lightQueue.count > 0) {
-		ln = *(struct LightNode*)(Queue_Dequeue(&lightQueue));
-
-		brightnessHere = GetBrightness(ln.coords.x, ln.coords.y, ln.coords.z, isLamp);
-
-		/* If this cell is already more lit, we can assume this cell and its neighbors have been accounted for */
-		if (brightnessHere >= ln.brightness) { continue; }
-		if (ln.brightness == 0) { continue; }
-
-		SetBrightness(ln.brightness, ln.coords.x, ln.coords.y, ln.coords.z, isLamp, refreshChunk);
-
-		thisBlock = World_GetBlock(ln.coords.x, ln.coords.y, ln.coords.z);
-		ln.brightness--;
-		if (ln.brightness == 0) continue;
+	FlushLightQueueBody(&lightQueue, &lightQueue, Shared_GetBrightness, Shared_SetBrightness)
+}
 
-		ln.coords.x--;
-		Light_TrySpreadInto(x, X, > , 0, isLamp, MAX, MIN)
-		ln.coords.x += 2;
-		Light_TrySpreadInto(x, X, < , World.MaxX, isLamp, MIN, MAX)
-		ln.coords.x--;
+/* Spreads out the light of every node in the buckets, starting from the brightest nodes */
+/*  (so a cell is only ever lit once, by the brightest light that reaches it) */
+#define FlushLightBucketsBody(buckets, get_brightness, set_brightness) \
+	for (level = FANCY_LIGHTING_MAX_LEVEL; level > 0; level--) { \
+		FlushLightQueueBody(&(buckets)[level], &(buckets)[level - 1], get_brightness, set_brightness) \
+	}
 
-		ln.coords.y--;
-		Light_TrySpreadInto(y, Y, >, 0, isLamp, MAX, MIN)
-		ln.coords.y += 2;
-		Light_TrySpreadInto(y, Y, <, World.MaxY, isLamp, MIN, MAX)
-		ln.coords.y--;
+static void FlushLightBuckets(cc_bool isLamp) {
+	struct LightNode ln;
+	cc_uint8 brightnessHere;
+	BlockID thisBlock;
+	int level;
+	cc_bool refreshChunk = false;
 
-		ln.coords.z--;
-		Light_TrySpreadInto(z, Z, > , 0, isLamp, MAX, MIN)
-		ln.coords.z += 2;
-		Light_TrySpreadInto(z, Z, < , World.MaxZ, isLamp, MIN, MAX)
-	}
+	FlushLightBucketsBody(lightBuckets, Shared_GetBrightness, Shared_SetBrightness)
 }
 
 cc_uint8 GetBlockBrightness(BlockID curBlock, cc_bool isLamp) {
@@ -269,6 +402,54 @@ cc_uint8 GetBlockBrightness(BlockID curBlock, cc_bool isLamp) {
 #define LightNode_Init(node, X, Y, Z, bright) \
 	node.coords.x = X; node.coords.y = Y; node.coords.z = Z; node.brightness = bright;
 
+/* Whether the given chunk can't possibly have any light-casting blocks in it */
+/* NOTE: Called from light worker threads, so must only use World_IsChunkAir (which doesn't recount) */
+#define ChunkHasNoLightSources(cx, cy, cz) (World_IsChunkAir(cx, cy, cz) && !Blocks.Brightness[BLOCK_AIR])
+
+/* Returns the level of the given type of light that the given block is a source of */
+/*  (blocks that cast both types of light only cast lava light) */
+static cc_uint8 GetSourceBrightness(BlockID curBlock, cc_bool isLamp) {
+	cc_uint8 lavaBrightness = GetBlockBrightness(curBlock, false);
+	if (!isLamp) return lavaBrightness;
+	return lavaBrightness ? 0 : GetBlockBrightness(curBlock, true);
+}
+
+#define CalcChunkBounds() \
+	chunkStartX = cx * CHUNK_SIZE; \
+	chunkStartY = cy * CHUNK_SIZE; \
+	chunkStartZ = cz * CHUNK_SIZE; \
+	chunkEndX = min(chunkStartX + CHUNK_SIZE, World.Width); \
+	chunkEndY = min(chunkStartY + CHUNK_SIZE, World.Height); \
+	chunkEndZ = min(chunkStartZ + CHUNK_SIZE, World.Length);
+
+/* Spreads out the light of every light-casting block in the chunk, by adding all of the */
+/*  blocks casting each type of light to the buckets at once and then flushing the buckets */
+#define CalcChunkSourcesBody(buckets, flush_buckets) \
+	CalcChunkBounds() \
+\
+	for (i = 0; i < 2; i++) { \
+		isLamp = i == 1; \
+		anySources = false; \
+\
+		for (y = chunkStartY; y < chunkEndY; y++) { \
+			for (z = chunkStartZ; z < chunkEndZ; z++) { \
+				for (x = chunkStartX; x < chunkEndX; x++) { \
+\
+					curBlock = World_GetBlock(x, y, z); \
+					if (!Blocks.Brightness[curBlock]) continue; \
+\
+					brightness = GetSourceBrightness(curBlock, isLamp); \
+					if (!brightness) continue; \
+\
+					LightNode_Init(entry, x, y, z, brightness); \
+					Queue_Enqueue(&(buckets)[brightness], &entry); \
+					anySources = true; \
+				} \
+			} \
+		} \
+		if (anySources) flush_buckets(isLamp); \
+	}
+
 static void CalculateChunkLightingSelf(int chunkIndex, int cx, int cy, int cz) {
 	int x, y, z;
 	/* Block coordinates */
@@ -276,49 +457,15 @@ static void CalculateChunkLightingSelf(int chunkIndex, int cx, int cy, int cz) {
 	cc_uint8 brightness;
 	BlockID curBlock;
 	struct LightNode entry;
+	cc_bool isLamp, anySources;
+	int i;
 
-	chunkStartX = cx * CHUNK_SIZE;
-	chunkStartY = cy * CHUNK_SIZE;
-	chunkStartZ = cz * CHUNK_SIZE;
-	chunkEndX = chunkStartX + CHUNK_SIZE;
-	chunkEndY = chunkStartY + CHUNK_SIZE;
-	chunkEndZ = chunkStartZ + CHUNK_SIZE;
-
-	if (chunkEndX > World.Width ) { chunkEndX = World.Width;  }
-	if (chunkEndY > World.Height) { chunkEndY = World.Height; }
-	if (chunkEndZ > World.Length) { chunkEndZ = World.Length; }
-
-	for (y = chunkStartY; y < chunkEndY; y++) {
-		for (z = chunkStartZ; z < chunkEndZ; z++) {
-			for (x = chunkStartX; x < chunkEndX; x++) {
-
-				curBlock = World_GetBlock(x, y, z);
-				
-				if (Blocks.Brightness[curBlock] > 0) {
-
-					brightness = GetBlockBrightness(curBlock, false);
-
-					if (brightness > 0) {
-						LightNode_Init(entry, x, y, z, brightness);
-						Queue_Enqueue(&lightQueue, &entry);
-						FlushLightQueue(false, false);
-					}
-					else {
-						/* If no lava brightness, it must use lamp brightness */
-						brightness = Blocks.Brightness[curBlock] >> FANCY_LIGHTING_LAMP_SHIFT;
-						LightNode_Init(entry, x, y, z, brightness);
-						Queue_Enqueue(&lightQueue, &entry);
-						FlushLightQueue(true, false);
-					}
-				}
-
-				/* Note: This code only deals with generating light from block sources.
-				Regular sun light is added on as a "post process" step when returning light color in the exposed API.
-				This has the added benefit of being able to skip allocating chunk lighting data in regions that have no light-casting blocks*/
-			}
-		}
+	/* Note: This code only deals with generating light from block sources.
+	Regular sun light is added on as a "post process" step when returning light color in the exposed API.
+	This has the added benefit of being able to skip allocating chunk lighting data in regions that have no light-casting blocks*/
+	if (!ChunkHasNoLightSources(cx, cy, cz)) {
+		CalcChunkSourcesBody(lightBuckets, FlushLightBuckets)
 	}
-
 	chunkLightingDataFlags[chunkIndex] = CHUNK_SELF_CALCULATED;
 }
 
@@ -355,7 +502,202 @@ static void CalculateChunkLightingAll(int chunkIndex, int cx, int cy, int cz) {
 		}
 	}
 	chunkLightingDataFlags[chunkIndex] = CHUNK_ALL_CALCULATED;
+
+	/* Light of all the chunks around this chunk has been calculated, */
+	/*  so the light data of this chunk won't change anymore (unless blocks change) */
+	CompressChunk(chunkIndex);
+}
+
+/* Light from blocks in a chunk can only spread into the chunks directly around it */
+#define WINDOW_CHUNKS 3
+#define WINDOW_SIZE (CHUNK_SIZE * WINDOW_CHUNKS)
+#define WINDOW_SIZE_3 (WINDOW_SIZE * WINDOW_SIZE * WINDOW_SIZE)
+
+/* Private light data for the 3x3x3 chunks around a chunk, so that the light */
+/*  of blocks in that chunk can be calculated without modifying the shared light data */
+struct LightWindow {
+	struct Queue queue;
+	struct Queue buckets[FANCY_LIGHTING_LEVELS];
+	/* Block coordinates of the minimum corner of the window */
+	int x1, y1, z1;
+	/* Whether any light has been set in each of the chunks of the window */
+	cc_bool touched[WINDOW_CHUNKS * WINDOW_CHUNKS * WINDOW_CHUNKS];
+	cc_uint8 data[WINDOW_SIZE_3];
+};
+
+#define Window_Index(x, y, z) ((((y) - w->y1) * WINDOW_SIZE + ((z) - w->z1)) * WINDOW_SIZE + ((x) - w->x1))
+#define Window_Chunk(x, y, z) (((((y) - w->y1) >> CHUNK_SHIFT) * WINDOW_CHUNKS + (((z) - w->z1) >> CHUNK_SHIFT)) * WINDOW_CHUNKS + (((x) - w->x1) >> CHUNK_SHIFT))
+
+#define Window_GetBrightness(x, y, z) (isLamp ? \
+	w->data[Window_Index(x, y, z)] >> FANCY_LIGHTING_LAMP_SHIFT : \
+	w->data[Window_Index(x, y, z)] & FANCY_LIGHTING_MAX_LEVEL)
+
+static void Window_SetBrightness(struct LightWindow* w, cc_uint8 brightness, int x, int y, int z, cc_bool isLamp) {
+	cc_uint8 shift = isLamp ? FANCY_LIGHTING_LAMP_SHIFT : 0;
+	int index = Window_Index(x, y, z);
+
+	w->data[index] &= ~(FANCY_LIGHTING_MAX_LEVEL << shift);
+	w->data[index] |= brightness << shift;
+	w->touched[Window_Chunk(x, y, z)] = true;
+}
+#define Window_SetBrightness_(brightness, x, y, z) Window_SetBrightness(w, brightness, x, y, z, isLamp)
+
+static void InitWindow(struct LightWindow* w) {
+	Queue_Init(&w->queue, sizeof(struct LightNode));
+	InitLightBuckets(w->buckets);
+}
+static void FreeWindow(struct LightWindow* w) {
+	Queue_Clear(&w->queue);
+	ClearLightBuckets(w->buckets);
+}
+
+static void FlushWindowBuckets(struct LightWindow* w, cc_bool isLamp) {
+	struct LightNode ln;
+	cc_uint8 brightnessHere;
+	BlockID thisBlock;
+	int level;
+
+	FlushLightBucketsBody(w->buckets, Window_GetBrightness, Window_SetBrightness_)
 }
+#define Window_FlushBuckets(isLamp) FlushWindowBuckets(w, isLamp)
+
+/* Resets the window to be around the given chunk */
+static void ResetWindow(struct LightWindow* w, int cx, int cy, int cz) {
+	int i;
+
+	/* Only need to clear the window when the last chunk calculated had any light */
+	for (i = 0; i < Array_Elems(w->touched); i++) 
+	{
+		if (!w->touched[i]) continue;
+		Mem_Set(w->data,    0, sizeof(w->data));
+		Mem_Set(w->touched, 0, sizeof(w->touched));
+		break;
+	}
+
+	w->x1 = (cx - 1) * CHUNK_SIZE;
+	w->y1 = (cy - 1) * CHUNK_SIZE;
+	w->z1 = (cz - 1) * CHUNK_SIZE;
+}
+
+/* Calculates the light from the blocks in the given chunk into the window */
+/* NOTE: Only reads the world, so can be safely called from multiple threads at once */
+static void CalcChunkWindow(struct LightWindow* w, int cx, int cy, int cz) {
+	int x, y, z;
+	int chunkStartX, chunkStartY, chunkStartZ, chunkEndX, chunkEndY, chunkEndZ;
+	cc_uint8 brightness;
+	BlockID curBlock;
+	struct LightNode entry;
+	cc_bool isLamp, anySources;
+	int i;
+
+	ResetWindow(w, cx, cy, cz);
+	if (ChunkHasNoLightSources(cx, cy, cz)) return;
+
+	CalcChunkSourcesBody(w->buckets, Window_FlushBuckets)
+}
+
+/* Calculates the light from the blocks in the given chunk into the window, */
+/*  by spreading out the light of each light-casting block one at a time */
+/* NOTE: This is much slower than CalcChunkWindow, and only used to check its results */
+static void CalcChunkWindowEach(struct LightWindow* w, int cx, int cy, int cz) {
+	int x, y, z;
+	int chunkStartX, chunkStartY, chunkStartZ, chunkEndX, chunkEndY, chunkEndZ;
+	struct LightNode entry, ln;
+	cc_uint8 brightness, brightnessHere;
+	BlockID curBlock, thisBlock;
+	cc_bool isLamp;
+
+	ResetWindow(w, cx, cy, cz);
+	if (ChunkHasNoLightSources(cx, cy, cz)) return;
+	CalcChunkBounds()
+
+	for (y = chunkStartY; y < chunkEndY; y++) {
+		for (z = chunkStartZ; z < chunkEndZ; z++) {
+			for (x = chunkStartX; x < chunkEndX; x++) {
+
+				curBlock = World_GetBlock(x, y, z);
+				if (!Blocks.Brightness[curBlock]) continue;
+
+				/* If no lava brightness, it must use lamp brightness */
+				isLamp     = !GetBlockBrightness(curBlock, false);
+				brightness = GetSourceBrightness(curBlock, isLamp);
+
+				LightNode_Init(entry, x, y, z, brightness);
+				Queue_Enqueue(&w->queue, &entry);
+				FlushLightQueueBody(&w->queue, &w->queue, Window_GetBrightness, Window_SetBrightness_)
+			}
+		}
+	}
+}
+
+int FancyLighting_CheckBatched(int* litCells) {
+	struct LightWindow* batched;
+	struct LightWindow* each;
+	int cx, cy, cz, i, mismatches = 0;
+	*litCells = 0;
+
+	batched = (struct LightWindow*)Mem_TryAllocCleared(1, sizeof(struct LightWindow));
+	each    = (struct LightWindow*)Mem_TryAllocCleared(1, sizeof(struct LightWindow));
+	if (!batched || !each) {
+		Mem_Free(batched); Mem_Free(each); return -1;
+	}
+	InitWindow(batched);
+	InitWindow(each);
+
+	for (cy = 0; cy < World.ChunksY; cy++)
+		for (cz = 0; cz < World.ChunksZ; cz++)
+			for (cx = 0; cx < World.ChunksX; cx++)
+	{
+		CalcChunkWindow(batched,  cx, cy, cz);
+		CalcChunkWindowEach(each, cx, cy, cz);
+
+		for (i = 0; i < WINDOW_SIZE_3; i++) 
+		{
+			if (batched->data[i]) (*litCells)++;
+			if (batched->data[i] != each->data[i]) mismatches++;
+		}
+	}
+
+	FreeWindow(batched); Mem_Free(batched);
+	FreeWindow(each);    Mem_Free(each);
+	return mismatches;
+}
+
+#ifndef CC_BUILD_COOPTHREADED
+/* Merges the light in the window into the shared light data, keeping the brighter light of each cell */
+static void MergeChunkWindow(struct LightWindow* w, int cx, int cy, int cz) {
+	int x, y, z, wx, wy, wz, index, localIndex;
+	cc_uint8 cur, light, lava, lamp;
+	LightingChunk chunk;
+
+	for (y = 0; y < WINDOW_CHUNKS; y++)
+		for (z = 0; z < WINDOW_CHUNKS; z++)
+			for (x = 0; x < WINDOW_CHUNKS; x++)
+	{
+		if (!w->touched[(y * WINDOW_CHUNKS + z) * WINDOW_CHUNKS + x]) continue;
+
+		/* Light is never spread outside the world, so touched chunks are always inside */
+		index = ChunkCoordsToIndex(cx + x - 1, cy + y - 1, cz + z - 1);
+		chunk = GetFullChunk(index);
+		if (!chunk) continue;
+
+		for (localIndex = 0; localIndex < CHUNK_SIZE_3; localIndex++) 
+		{
+			wx = x * CHUNK_SIZE + (localIndex & CHUNK_MASK);
+			wz = z * CHUNK_SIZE + ((localIndex >> CHUNK_SHIFT) & CHUNK_MASK);
+			wy = y * CHUNK_SIZE + (localIndex >> (CHUNK_SHIFT * 2));
+
+			light = w->data[(wy * WINDOW_SIZE + wz) * WINDOW_SIZE + wx];
+			if (!light) continue;
+			cur = chunk[localIndex];
+
+			lava = max(cur & FANCY_LIGHTING_MAX_LEVEL, light & FANCY_LIGHTING_MAX_LEVEL);
+			lamp = max(cur & FANCY_LIGHTING_LAMP_MASK, light & FANCY_LIGHTING_LAMP_MASK);
+			chunk[localIndex] = lamp | lava;
+		}
+	}
+}
+#endif
 
 
 #define Light_TryUnSpreadInto(axis, dir, limit, AXIS, thisFace, thatFace) \
@@ -469,6 +811,161 @@ static void OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlo
 	CalcBlockChange(x, y, z, oldBlock, newBlock, false);
 	CalcBlockChange(x, y, z, oldBlock, newBlock, true);
 }
+/* Spreads the light of the cell just outside a region into the given cell inside it */
+static void SeedFromOutside(const cc_uint8* inRegion, int x, int y, int z, int nx, int ny, int nz,
+							Face thisFace, Face thatFace, cc_bool isLamp) {
+	struct LightNode entry;
+	cc_uint8 brightness;
+
+	if (!World_Contains(nx, ny, nz)) return;
+	if (inRegion[ChunkCoordsToIndex(nx >> CHUNK_SHIFT, ny >> CHUNK_SHIFT, nz >> CHUNK_SHIFT)]) return;
+
+	brightness = GetBrightness(nx, ny, nz, isLamp);
+	if (brightness <= 1) return;
+	if (!CanLightPass(World_GetBlock(nx, ny, nz), thisFace)) return;
+	if (!CanLightPass(World_GetBlock(x, y, z),    thatFace)) return;
+
+	LightNode_Init(entry, x, y, z, brightness - 1);
+	Queue_Enqueue(&lightBuckets[brightness - 1], &entry);
+}
+
+/* Adds the light from the blocks in the given chunk, and from the cells just outside */
+/*  the region around the given chunk, to the buckets */
+static void SeedRegionChunk(const cc_uint8* inRegion, int cx, int cy, int cz, cc_bool isLamp) {
+	int x, y, z;
+	int chunkStartX, chunkStartY, chunkStartZ, chunkEndX, chunkEndY, chunkEndZ;
+	cc_uint8 brightness;
+	BlockID curBlock;
+	struct LightNode entry;
+	cc_bool hasSources;
+	CalcChunkBounds()
+
+	/* Light from chunks that haven't been calculated yet is spread when they are calculated */
+	hasSources = chunkLightingDataFlags[ChunkCoordsToIndex(cx, cy, cz)] != CHUNK_UNCALCULATED
+					&& !ChunkHasNoLightSources(cx, cy, cz);
+
+	for (y = chunkStartY; y < chunkEndY; y++) {
+		for (z = chunkStartZ; z < chunkEndZ; z++) {
+			for (x = chunkStartX; x < chunkEndX; x++) {
+
+				if (hasSources) {
+					curBlock   = World_GetBlock(x, y, z);
+					brightness = Blocks.Brightness[curBlock] ? GetSourceBrightness(curBlock, isLamp) : 0;
+
+					if (brightness) {
+						LightNode_Init(entry, x, y, z, brightness);
+						Queue_Enqueue(&lightBuckets[brightness], &entry);
+					}
+				}
+
+				if (x == chunkStartX)   SeedFromOutside(inRegion, x, y, z, x - 1, y, z, FACE_XMIN, FACE_XMAX, isLamp);
+				if (x == chunkEndX - 1) SeedFromOutside(inRegion, x, y, z, x + 1, y, z, FACE_XMAX, FACE_XMIN, isLamp);
+				if (y == chunkStartY)   SeedFromOutside(inRegion, x, y, z, x, y - 1, z, FACE_YMIN, FACE_YMAX, isLamp);
+				if (y == chunkEndY - 1) SeedFromOutside(inRegion, x, y, z, x, y + 1, z, FACE_YMAX, FACE_YMIN, isLamp);
+				if (z == chunkStartZ)   SeedFromOutside(inRegion, x, y, z, x, y, z - 1, FACE_ZMIN, FACE_ZMAX, isLamp);
+				if (z == chunkEndZ - 1) SeedFromOutside(inRegion, x, y, z, x, y, z + 1, FACE_ZMAX, FACE_ZMIN, isLamp);
+			}
+		}
+	}
+}
+
+#define REGION_CHUNK     1
+#define REGION_HAD_LIGHT 2
+/* Recalculating a region takes as long as updating the light for around this many blocks */
+#define REGION_MIN_BLOCKS 1024
+
+/* Recalculates the light of all the chunks around the chunks containing the given blocks at once */
+/* Light travels at most 15 cells, so the light of cells outside this region can't have */
+/*  changed, and spreading it back into the region along with the light of the blocks */
+/*  inside the region gives the same result as updating the light for each block in turn */
+/* Returns false when out of memory */
+static cc_bool RecalcRegion(const IVec3* coords, int count) {
+	cc_uint8* inRegion;
+	IVec3* chunks;
+	int numChunks = 0, lastIndex = -1;
+	int i, x, y, z, cx, cy, cz, chunkIndex;
+	cc_bool isLamp;
+
+	inRegion = (cc_uint8*)Mem_TryAllocCleared(World.ChunksCount, sizeof(cc_uint8));
+	chunks   = (IVec3*)Mem_TryAlloc(World.ChunksCount, sizeof(IVec3));
+	if (!inRegion || !chunks) { Mem_Free(inRegion); Mem_Free(chunks); return false; }
+
+	for (i = 0; i < count; i++) 
+	{
+		cx = coords[i].x >> CHUNK_SHIFT; cy = coords[i].y >> CHUNK_SHIFT; cz = coords[i].z >> CHUNK_SHIFT;
+		chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+		/* Blocks are usually changed in runs of blocks in the same chunk */
+		if (chunkIndex == lastIndex) continue;
+		lastIndex = chunkIndex;
+
+		for (y = max(cy - 1, 0); y <= min(cy + 1, World.ChunksY - 1); y++)
+			for (z = max(cz - 1, 0); z <= min(cz + 1, World.ChunksZ - 1); z++)
+				for (x = max(cx - 1, 0); x <= min(cx + 1, World.ChunksX - 1); x++)
+		{
+			chunkIndex = ChunkCoordsToIndex(x, y, z);
+			if (inRegion[chunkIndex]) continue;
+
+			inRegion[chunkIndex] = REGION_CHUNK;
+			chunks[numChunks].x = x; chunks[numChunks].y = y; chunks[numChunks].z = z;
+			numChunks++;
+		}
+	}
+
+	/* Clear the light of every chunk in the region */
+	for (i = 0; i < numChunks; i++) 
+	{
+		chunkIndex = ChunkCoordsToIndex(chunks[i].x, chunks[i].y, chunks[i].z);
+		if (chunkLightingFormats[chunkIndex] == LIGHT_FORMAT_UNIFORM && !chunkLightingUniform[chunkIndex]) continue;
+
+		inRegion[chunkIndex] |= REGION_HAD_LIGHT;
+		Mem_Free(chunkLightingData[chunkIndex]);
+		chunkLightingData[chunkIndex]    = NULL;
+		chunkLightingFormats[chunkIndex] = LIGHT_FORMAT_UNIFORM;
+		chunkLightingUniform[chunkIndex] = 0;
+	}
+
+	for (i = 0; i < 2; i++) 
+	{
+		isLamp = i == 1;
+		for (x = 0; x < numChunks; x++) 
+		{
+			SeedRegionChunk(inRegion, chunks[x].x, chunks[x].y, chunks[x].z, isLamp);
+		}
+		FlushLightBuckets(isLamp);
+	}
+
+	/* Chunks that had no light before and still have no light look the same */
+	for (i = 0; i < numChunks; i++) 
+	{
+		cx = chunks[i].x; cy = chunks[i].y; cz = chunks[i].z;
+		chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+
+		if (chunkLightingDataFlags[chunkIndex] == CHUNK_ALL_CALCULATED) CompressChunk(chunkIndex);
+		if (inRegion[chunkIndex] & REGION_HAD_LIGHT || chunkLightingFormats[chunkIndex] != LIGHT_FORMAT_UNIFORM
+				|| chunkLightingUniform[chunkIndex]) {
+			MapRenderer_RefreshChunk(cx, cy, cz);
+		}
+	}
+
+	Mem_Free(inRegion);
+	Mem_Free(chunks);
+	return true;
+}
+
+static void OnBlocksChanged(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count) {
+	int i;
+	ClassicLighting_OnBlocksChanged(coords, oldBlocks, blocks, count);
+	if (count >= REGION_MIN_BLOCKS && RecalcRegion(coords, count)) return;
+
+	/* Spreading of light is cheaper to update for each block changed when only a few blocks changed */
+	for (i = 0; i < count; i++) 
+	{
+		if (oldBlocks[i] == blocks[i]) continue;
+
+		CalcBlockChange(coords[i].x, coords[i].y, coords[i].z, oldBlocks[i], blocks[i], false);
+		CalcBlockChange(coords[i].x, coords[i].y, coords[i].z, oldBlocks[i], blocks[i], true);
+	}
+}
 /* Invalidates/Resets lighting state for all of the blocks in the world */
 /*  (e.g. because a block changed whether it is full bright or not) */
 static void Refresh(void) {
@@ -496,13 +993,8 @@ static PackedCol Color_Core(int x, int y, int z, int paletteFace) {
 	chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
 	CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
 
-	/* There might be no light data in this chunk even after it was calculated */
-	if (chunkLightingData[chunkIndex] == NULL) {
-		lightData = 0;
-	} else {
-		chunkCoordsIndex = GlobalCoordsToChunkCoordsIndex(x, y, z);
-		lightData = chunkLightingData[chunkIndex][chunkCoordsIndex];
-	}
+	chunkCoordsIndex = GlobalCoordsToChunkCoordsIndex(x, y, z);
+	lightData = GetLightData(chunkIndex, chunkCoordsIndex);
 
 	/* This cell is exposed to sunlight */
 	if (y > ClassicLighting_GetLightHeight(x, z)) {
@@ -537,20 +1029,143 @@ static PackedCol Color_ZSide(int x, int y, int z) {
 
 static void LightHint(int startX, int startY, int startZ) {
 	int cx, cy, cz, chunkIndex;
+	int cx1, cy1, cz1, cx2, cy2, cz2;
 	ClassicLighting_LightHint(startX, startY, startZ);
-	/* Add 1 to startX/Z, as coordinates are for the extended chunk (18x18x18) */
-	startX++; startY++; startZ++;
 
-	cx = (startX + HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
-	cy = (startY + HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
-	cz = (startZ + HALF_CHUNK_SIZE) >> CHUNK_SHIFT;
+	/* Calculate lighting for every chunk the extended chunk (18x18x18) overlaps, */
+	/*  so that the _Fast functions only ever need to read lighting data afterwards */
+	/*  (which allows chunk meshes to be built on other threads) */
+	cx1 = max(startX, 0) >> CHUNK_SHIFT; cx2 = (min(startX + EXTCHUNK_SIZE, World.Width)  - 1) >> CHUNK_SHIFT;
+	cy1 = max(startY, 0) >> CHUNK_SHIFT; cy2 = (min(startY + EXTCHUNK_SIZE, World.Height) - 1) >> CHUNK_SHIFT;
+	cz1 = max(startZ, 0) >> CHUNK_SHIFT; cz2 = (min(startZ + EXTCHUNK_SIZE, World.Length) - 1) >> CHUNK_SHIFT;
+
+	for (cy = cy1; cy <= cy2; cy++) {
+		for (cz = cz1; cz <= cz2; cz++) {
+			for (cx = cx1; cx <= cx2; cx++) {
+				chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+				CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+			}
+		}
+	}
+}
 
-	chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
-	CalcForChunkIfNeeded(cx, cy, cz, chunkIndex);
+#ifndef CC_BUILD_COOPTHREADED
+/* Max number of chunks that have their light calculated together in one batch */
+#define LIGHT_MAX_JOBS 1024
+
+/* Window that each thread calculates light in (indexed by thread, see Builder_RunJobs) */
+static struct LightWindow* windows[BUILDER_MAX_WORKERS + 1];
+static int windowsCount;
+/* Only one thread at a time can modify the shared light data */
+static void* mergeMutex;
+/* Chunks in the current batch */
+static IVec3 jobs[LIGHT_MAX_JOBS];
+
+/* Calculates light of the given chunk in the current batch */
+static void RunJob(int job, int thread) {
+	struct LightWindow* w = windows[thread];
+	IVec3 pos = jobs[job];
+	CalcChunkWindow(w, pos.x, pos.y, pos.z);
+
+	Mutex_Lock(mergeMutex);
+	MergeChunkWindow(w, pos.x, pos.y, pos.z);
+	chunkLightingDataFlags[ChunkCoordsToIndex(pos.x, pos.y, pos.z)] = CHUNK_SELF_CALCULATED;
+	Mutex_Unlock(mergeMutex);
+}
+
+/* Allocates a window for the main thread and for each chunk builder worker thread */
+/* Returns false if there wasn't enough memory to allocate all of them */
+static cc_bool AllocWindows(void) {
+	int count = Builder_WorkersCount + 1;
+	if (!mergeMutex) mergeMutex = Mutex_Create("Lighting merge");
+
+	for (; windowsCount < count; windowsCount++) 
+	{
+		windows[windowsCount] = (struct LightWindow*)Mem_TryAllocCleared(1, sizeof(struct LightWindow));
+		if (!windows[windowsCount]) return false;
+		InitWindow(windows[windowsCount]);
+	}
+	return true;
+}
+
+static void FreeWindows(void) {
+	int i;
+	for (i = 0; i < windowsCount; i++) 
+	{
+		FreeWindow(windows[i]);
+		Mem_Free(windows[i]);
+		windows[i] = NULL;
+	}
+
+	if (mergeMutex) Mutex_Free(mergeMutex);
+	mergeMutex   = NULL;
+	windowsCount = 0;
+}
+
+/* Adds the chunks in the given region which haven't had their light calculated yet to the batch */
+static int QueueChunks(int count, int cx1, int cy1, int cz1, int cx2, int cy2, int cz2) {
+	int cx, cy, cz, chunkIndex;
+	cx1 = max(cx1, 0); cx2 = min(cx2, World.ChunksX - 1);
+	cy1 = max(cy1, 0); cy2 = min(cy2, World.ChunksY - 1);
+	cz1 = max(cz1, 0); cz2 = min(cz2, World.ChunksZ - 1);
+
+	for (cy = cy1; cy <= cy2; cy++) {
+		for (cz = cz1; cz <= cz2; cz++) {
+			for (cx = cx1; cx <= cx2; cx++) {
+				chunkIndex = ChunkCoordsToIndex(cx, cy, cz);
+				if (chunkLightingDataFlags[chunkIndex] != CHUNK_UNCALCULATED) continue;
+				if (count == LIGHT_MAX_JOBS) return count;
+
+				chunkLightingDataFlags[chunkIndex] = CHUNK_SELF_QUEUED;
+				jobs[count].x = cx; jobs[count].y = cy; jobs[count].z = cz;
+				count++;
+			}
+		}
+	}
+	return count;
 }
 
+static void LightHints(const IVec3* starts, int count) {
+	int i, cx1, cy1, cz1, queued = 0;
+	cc_bool batch = Builder_WorkersCount && AllocWindows();
+
+	/* Light of all the chunks around the chunks overlapped by each region must be calculated */
+	/*  first, so calculate light of those chunks in parallel on the chunk builder worker threads */
+	/*  before LightHint needs it (any chunks not in the batch are calculated by LightHint as normal) */
+	for (i = 0; batch && i < count; i++) 
+	{
+		cx1 = max(starts[i].x, 0) >> CHUNK_SHIFT;
+		cy1 = max(starts[i].y, 0) >> CHUNK_SHIFT;
+		cz1 = max(starts[i].z, 0) >> CHUNK_SHIFT;
+		queued = QueueChunks(queued, cx1 - 1, cy1 - 1, cz1 - 1, 
+			((starts[i].x + EXTCHUNK_SIZE - 1) >> CHUNK_SHIFT) + 1,
+			((starts[i].y + EXTCHUNK_SIZE - 1) >> CHUNK_SHIFT) + 1,
+			((starts[i].z + EXTCHUNK_SIZE - 1) >> CHUNK_SHIFT) + 1);
+	}
+	if (queued) Builder_RunJobs(queued, RunJob);
+
+	for (i = 0; i < count; i++) 
+	{
+		LightHint(starts[i].x, starts[i].y, starts[i].z);
+	}
+}
+
+void FancyLighting_OnFree(void) { FreeWindows(); }
+#else
+static void LightHints(const IVec3* starts, int count) {
+	int i;
+	for (i = 0; i < count; i++) 
+	{
+		LightHint(starts[i].x, starts[i].y, starts[i].z);
+	}
+}
+
+void FancyLighting_OnFree(void) { }
+#endif
+
 void FancyLighting_SetActive(void) {
 	Lighting.OnBlockChanged = OnBlockChanged;
+	Lighting.OnBlocksChanged = OnBlocksChanged;
 	Lighting.Refresh = Refresh;
 	Lighting.IsLit = IsLit;
 	Lighting.Color = Color;
@@ -566,6 +1181,7 @@ void FancyLighting_SetActive(void) {
 	Lighting.FreeState  = FreeState;
 	Lighting.AllocState = AllocState;
 	Lighting.LightHint  = LightHint;
+	Lighting.LightHints = LightHints;
 }
 
 static void OnEnvVariableChanged(void* obj, int envVar) {
@@ -16,22 +16,41 @@
 #include "Chat.h"
 #include "TexturePack.h"
 #include "Utils.h"
+#include "Screens.h"
 
 #ifdef CC_BUILD_FILESYSTEM
 static struct LocationUpdate* spawn_point;
 static struct MapImporter* imp_head;
 static struct MapImporter* imp_tail;
 
+/* The map being imported. Maps are imported into this instead of directly into World, so that */
+/*  the game never sees a partially imported world when importing on a background thread */
+static struct MapImport {
+	BlockRaw* blocks;
+#ifdef EXTENDED_BLOCKS
+	BlockRaw* blocks2;
+#endif
+	int width, height, length, volume, seed;
+	cc_bool hasUuid;
+	cc_uint8 uuid[WORLD_UUID_LEN];
+	struct LocationUpdate spawn;
+	/* Applies changes to the game's state (e.g. environment settings) read from the map */
+	/* NOTE: Always called on the main thread, after the map has been successfully imported */
+	cc_result (*ApplyMetadata)(void);
+} map;
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------General----------------------------------------------------------*
 *#########################################################################################################################*/
+#define Map_Pack(x, y, z) (((y) * map.length + (z)) * map.width + (x))
+
 static cc_result Map_ReadBlocks(struct Stream* stream) {
-	World.Volume = World.Width * World.Length * World.Height;
-	World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+	map.volume = map.width * map.length * map.height;
+	map.blocks = (BlockRaw*)Mem_TryAlloc(map.volume, 1);
 
-	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
-	return Stream_Read(stream, World.Blocks, World.Volume);
+	if (!map.blocks) return ERR_OUT_OF_MEMORY;
+	return Stream_Read(stream, map.blocks, map.volume);
 }
 
 static cc_result Map_SkipGZipHeader(struct Stream* stream) {
@@ -61,40 +80,6 @@ struct MapImporter* MapImporter_Find(const cc_string* path) {
 	return NULL;
 }
 
-cc_result Map_LoadFrom(const cc_string* path) {
-	cc_string relPath, fileName, fileExt;
-	struct LocationUpdate update = { 0 };
-	struct MapImporter* imp;
-	struct Stream stream;
-	cc_result res;
-	Game_Reset();
-	
-	spawn_point = &update;
-	res = Stream_OpenFile(&stream, path);
-	if (res) { Logger_SysWarn2(res, "opening", path); return res; }
-
-	imp = MapImporter_Find(path);
-	if (!imp) {
-		res = ERR_NOT_SUPPORTED;
-	} else if ((res = imp->import(&stream))) {
-		World_Reset();
-	}
-
-	/* No point logging error for closing readonly file */
-	(void)stream.Close(&stream);
-	if (res) Logger_SysWarn2(res, "decoding", path);
-
-	World_SetNewMap(World.Blocks, World.Width, World.Height, World.Length);
-	if (!spawn_point) LocalPlayer_CalcDefaultSpawn(Entities.CurPlayer, &update);
-	LocalPlayers_MoveToSpawn(&update);
-
-	relPath = *path;
-	Utils_UNSAFE_GetFilename(&relPath);
-	String_UNSAFE_Separate(&relPath, '.', &fileName, &fileExt);
-	String_Copy(&World.Name, &fileName);
-	return res;
-}
-
 
 /*########################################################################################################################*
 *--------------------------------------------------MCSharp level Format---------------------------------------------------*
@@ -141,33 +126,33 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 	int x, y, z, i;
 
 	/* skip bounds checks when we know chunk is entirely inside map */
-	int adjWidth  = World.Width  & ~0x0F;
-	int adjHeight = World.Height & ~0x0F;
-	int adjLength = World.Length & ~0x0F;
+	int adjWidth  = map.width  & ~0x0F;
+	int adjHeight = map.height & ~0x0F;
+	int adjLength = map.length & ~0x0F;
 
-	for (y = 0; y < World.Height; y += LVL_CHUNKSIZE) {
-		for (z = 0; z < World.Length; z += LVL_CHUNKSIZE) {
-			for (x = 0; x < World.Width; x += LVL_CHUNKSIZE) {
+	for (y = 0; y < map.height; y += LVL_CHUNKSIZE) {
+		for (z = 0; z < map.length; z += LVL_CHUNKSIZE) {
+			for (x = 0; x < map.width; x += LVL_CHUNKSIZE) {
 
 				if ((res = stream->ReadU8(stream, &hasCustom))) return res;
 				if (hasCustom != 1) continue;
 				if ((res = Stream_Read(stream, chunk, sizeof(chunk)))) return res;
-				baseIndex = World_Pack(x, y, z);
+				baseIndex = Map_Pack(x, y, z);
 
 				if ((x + LVL_CHUNKSIZE) <= adjWidth && (y + LVL_CHUNKSIZE) <= adjHeight && (z + LVL_CHUNKSIZE) <= adjLength) {
 					for (i = 0; i < sizeof(chunk); i++) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
 
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+						index = baseIndex + Map_Pack(xx, yy, zz);
+						map.blocks[index] = map.blocks[index] == LVL_CUSTOMTILE ? chunk[i] : map.blocks[index];
 					}
 				} else {
 					for (i = 0; i < sizeof(chunk); i++) {
 						xx = i & 0xF; yy = (i >> 8) & 0xF; zz = (i >> 4) & 0xF;
-						if ((x + xx) >= World.Width || (y + yy) >= World.Height || (z + zz) >= World.Length) continue;
+						if ((x + xx) >= map.width || (y + yy) >= map.height || (z + zz) >= map.length) continue;
 
-						index = baseIndex + World_Pack(xx, yy, zz);
-						World.Blocks[index] = World.Blocks[index] == LVL_CUSTOMTILE ? chunk[i] : World.Blocks[index];
+						index = baseIndex + Map_Pack(xx, yy, zz);
+						map.blocks[index] = map.blocks[index] == LVL_CUSTOMTILE ? chunk[i] : map.blocks[index];
 					}
 				}
 			}
@@ -176,6 +161,12 @@ static cc_result Lvl_ReadCustomBlocks(struct Stream* stream) {
 	return 0;
 }
 
+static cc_result Lvl_WarnCustomBlocks(void) {
+	Chat_AddRaw("&cEnd of stream reading .lvl custom blocks section");
+	Chat_AddRaw("&c  Some blocks may therefore appear incorrectly");
+	return 0;
+}
+
 /* Imports a world from a .lvl MCSharp server map file */
 /* Used by MCSharp/MCLawl/MCForge/MCDzienny/MCGalaxy */
 static cc_result Lvl_Load(struct Stream* stream) {
@@ -193,9 +184,9 @@ static cc_result Lvl_Load(struct Stream* stream) {
 	if ((res = Stream_Read(&compStream, header, sizeof(header)))) return res;
 	if (Stream_GetU16_LE(&header[0]) != 1874) return LVL_ERR_VERSION;
 
-	World.Width  = Stream_GetU16_LE(&header[2]);
-	World.Length = Stream_GetU16_LE(&header[4]);
-	World.Height = Stream_GetU16_LE(&header[6]);
+	map.width  = Stream_GetU16_LE(&header[2]);
+	map.length = Stream_GetU16_LE(&header[4]);
+	map.height = Stream_GetU16_LE(&header[6]);
 
 	spawn_point->flags = LU_HAS_POS | LU_HAS_YAW | LU_HAS_PITCH;
 	spawn_point->pos.x = Stream_GetU16_LE(&header[8]);
@@ -206,15 +197,15 @@ static cc_result Lvl_Load(struct Stream* stream) {
 	/* (2) pervisit, perbuild permissions */
 
 	if ((res = Map_ReadBlocks(&compStream))) return res;
-	blocks = World.Blocks;
+	blocks = map.blocks;
 	/* Bulk convert 4 blocks at once */
-	for (i = 0; i < (World.Volume & ~3); i += 4) {
+	for (i = 0; i < (map.volume & ~3); i += 4) {
 		*blocks = Lvl_table[*blocks]; blocks++;
 		*blocks = Lvl_table[*blocks]; blocks++;
 		*blocks = Lvl_table[*blocks]; blocks++;
 		*blocks = Lvl_table[*blocks]; blocks++;
 	}
-	for (; i < World.Volume; i++) {
+	for (; i < map.volume; i++) {
 		*blocks = Lvl_table[*blocks]; blocks++;
 	}
 
@@ -229,8 +220,7 @@ static cc_result Lvl_Load(struct Stream* stream) {
 	res = Lvl_ReadCustomBlocks(&compStream);
 	/* At least one map out there has a corrupted 0xBD section */
 	if (res == ERR_END_OF_STREAM) {
-		Chat_AddRaw("&cEnd of stream reading .lvl custom blocks section");
-		Chat_AddRaw("&c  Some blocks may therefore appear incorrectly");
+		map.ApplyMetadata = Lvl_WarnCustomBlocks;
 		res = 0;
 	}
 	return res;
@@ -280,9 +270,9 @@ static cc_result Fcm_Load(struct Stream* stream) {
 	if (Stream_GetU32_LE(&header[0]) != 0x0FC2AF40UL)        return FCM_ERR_IDENTIFIER;
 	if (header[4] != 13) return FCM_ERR_REVISION;
 	
-	World.Width  = Stream_GetU16_LE(&header[5]);
-	World.Height = Stream_GetU16_LE(&header[7]);
-	World.Length = Stream_GetU16_LE(&header[9]);
+	map.width  = Stream_GetU16_LE(&header[5]);
+	map.height = Stream_GetU16_LE(&header[7]);
+	map.length = Stream_GetU16_LE(&header[9]);
 	
 	spawn_point->flags = LU_HAS_POS | LU_HAS_YAW | LU_HAS_PITCH;
 	spawn_point->pos.x = ((int)Stream_GetU32_LE(&header[11])) / 32.0f;
@@ -293,7 +283,8 @@ static cc_result Fcm_Load(struct Stream* stream) {
 
 	/* header[25] (4) date modified */
 	/* header[29] (4) date created */
-	Mem_Copy(&World.Uuid, &header[33], WORLD_UUID_LEN);
+	Mem_Copy(map.uuid, &header[33], WORLD_UUID_LEN);
+	map.hasUuid = true;
 	/* header[49] (26) layer index */
 	count = (int)Stream_GetU32_LE(&header[75]);
 
@@ -343,6 +334,7 @@ struct NbtTag {
 	char _nameBuffer[NBT_STRING_SIZE];
 	cc_result result;
 	int listIndex;
+	cc_uint32 id; /* Unique ID of the tag within the file */
 };
 
 static cc_uint8 NbtTag_U8(struct NbtTag* tag) {
@@ -414,6 +406,8 @@ static cc_result Nbt_ReadString(struct Stream* stream, cc_string* str) {
 }
 
 typedef void (*Nbt_Callback)(struct NbtTag* tag);
+static cc_uint32 nbt_lastID;
+
 static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream* stream, 
 							struct NbtTag* parent, Nbt_Callback callback, int listIndex) {
 	struct NbtTag tag;
@@ -427,6 +421,7 @@ static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream
 	tag.parent    = parent;
 	tag.dataSize  = 0;
 	tag.listIndex = listIndex;
+	tag.id        = ++nbt_lastID;
 	String_InitArray(tag.name, tag._nameBuffer);
 
 	if (readTagName) {
@@ -515,6 +510,100 @@ static BlockRaw* Nbt_TakeArray(struct NbtTag* tag, const char* type) {
 	return ptr;
 }
 
+/* Tags which change the game's state (e.g. environment settings or block definitions) can't be */
+/*  processed on a background thread. So they are instead copied when read, and then processed */
+/*  later on the main thread (along with copies of their parents) after the map has been read */
+struct NbtSavedTag { struct NbtTag tag; int parent; cc_bool process; };
+#define NBT_MAX_SAVED_DEPTH 8
+
+static struct NbtSavedTag* nbt_saved;
+static int nbt_savedCount, nbt_savedCapacity;
+/* ID and index of the most recently copied parent tag at each depth */
+static cc_uint32 nbt_parentIDs[NBT_MAX_SAVED_DEPTH];
+static int nbt_parentIndices[NBT_MAX_SAVED_DEPTH];
+
+static int Nbt_SaveParent(struct NbtTag* tag, int depth);
+static int Nbt_CopyTag(struct NbtTag* tag, int depth, cc_bool process) {
+	struct NbtSavedTag* saved;
+	int parent = depth ? Nbt_SaveParent(tag->parent, depth - 1) : -1;
+
+	if (nbt_savedCount == nbt_savedCapacity) {
+		Utils_Resize((void**)&nbt_saved, &nbt_savedCapacity,
+					sizeof(struct NbtSavedTag), 0, 64);
+	}
+	saved = &nbt_saved[nbt_savedCount];
+
+	saved->tag     = *tag;
+	saved->parent  = parent;
+	saved->process = process;
+	/* So Nbt_ReadTag doesn't call Mem_Free on the array */
+	if (!NbtTag_IsSmall(tag)) tag->value.big = NULL;
+	return nbt_savedCount++;
+}
+
+static int Nbt_SaveParent(struct NbtTag* tag, int depth) {
+	int index;
+	/* Sibling tags usually share the same parents, so only copy them once */
+	if (depth < NBT_MAX_SAVED_DEPTH && nbt_parentIDs[depth] == tag->id) 
+		return nbt_parentIndices[depth];
+
+	index = Nbt_CopyTag(tag, depth, false);
+	if (depth < NBT_MAX_SAVED_DEPTH) {
+		nbt_parentIDs[depth]     = tag->id;
+		nbt_parentIndices[depth] = index;
+	}
+	return index;
+}
+
+/* Copies the given tag, so that it can be processed later by Nbt_ProcessSaved */
+static void Nbt_SaveTag(struct NbtTag* tag, int depth) { Nbt_CopyTag(tag, depth, true); }
+
+static void Nbt_FreeSaved(void) {
+	int i;
+	for (i = 0; i < nbt_savedCount; i++) 
+	{
+		if (!NbtTag_IsSmall(&nbt_saved[i].tag)) Mem_Free(nbt_saved[i].tag.value.big);
+	}
+
+	Mem_Free(nbt_saved);
+	nbt_saved         = NULL;
+	nbt_savedCount    = 0;
+	nbt_savedCapacity = 0;
+	Mem_Set(nbt_parentIDs, 0, sizeof(nbt_parentIDs));
+}
+
+/* Calls the given callback for each tag saved by Nbt_SaveTag, in the order they were read */
+static cc_result Nbt_ProcessSaved(Nbt_Callback callback) {
+	struct NbtSavedTag* saved;
+	struct NbtTag* tag;
+	cc_result res = 0;
+	int i;
+
+	/* The copies still point to the original parents and string buffers */
+	for (i = 0; i < nbt_savedCount; i++) 
+	{
+		saved = &nbt_saved[i];
+		tag   = &saved->tag;
+
+		tag->parent      = saved->parent >= 0 ? &nbt_saved[saved->parent].tag : NULL;
+		tag->name.buffer = tag->_nameBuffer;
+		if (tag->type == NBT_STR) tag->value.str.text.buffer = tag->value.str.buffer;
+	}
+
+	for (i = 0; i < nbt_savedCount && !res; i++) 
+	{
+		if (!nbt_saved[i].process) continue;
+		tag = &nbt_saved[i].tag;
+
+		tag->result = 0;
+		callback(tag);
+		res = tag->result;
+	}
+
+	Nbt_FreeSaved();
+	return res;
+}
+
 static cc_result Nbt_Read(struct Stream* stream, Nbt_Callback callback) {
 	struct Stream compStream;
 	struct InflateState state;
@@ -653,33 +742,34 @@ COMPOUND "ClassicWorld" {
 }*/
 
 static void Cw_Callback_1(struct NbtTag* tag) {
-	if (IsTag(tag, "X")) { World.Width  = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Y")) { World.Height = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Z")) { World.Length = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "X")) { map.width  = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "Y")) { map.height = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "Z")) { map.length = NbtTag_U16(tag); return; }
 
 	if (IsTag(tag, "UUID")) {
 		if (tag->dataSize != WORLD_UUID_LEN) {
 			tag->result = CW_ERR_UUID_LEN;
 		} else {
-			Mem_Copy(World.Uuid, tag->value.small, WORLD_UUID_LEN);
+			Mem_Copy(map.uuid, tag->value.small, WORLD_UUID_LEN);
+			map.hasUuid = true;
 		}
 		return;
 	}
 
 	if (IsTag(tag, "BlockArray")) {
-		World.Volume = tag->dataSize;
-		World.Blocks = Nbt_TakeArray(tag, ".cw map blocks");
+		map.volume = tag->dataSize;
+		map.blocks = Nbt_TakeArray(tag, ".cw map blocks");
 	}
 #ifdef EXTENDED_BLOCKS
 	if (IsTag(tag, "BlockArray2")) {
-		World_SetMapUpper(Nbt_TakeArray(tag, ".cw map blocks2"));
+		map.blocks2 = Nbt_TakeArray(tag, ".cw map blocks2");
 	}
 #endif
 }
 
 static void Cw_Callback_2(struct NbtTag* tag) {
 	if (IsTag(tag->parent, "MapGenerator")) {
-		if (IsTag(tag, "Seed")) { World.Seed = NbtTag_I32(tag); return; }
+		if (IsTag(tag, "Seed")) { map.seed = NbtTag_I32(tag); return; }
 		return;
 	}
 	if (!IsTag(tag->parent, "Spawn")) return;
@@ -864,16 +954,31 @@ static void Cw_Callback(struct NbtTag* tag) {
 	switch (depth) {
 	case 1: Cw_Callback_1(tag); return;
 	case 2: Cw_Callback_2(tag); return;
-	case 4: Cw_Callback_4(tag); return;
-	case 5: Cw_Callback_5(tag); return;
+	/* Metadata changes the game's state, so must be processed on the main thread */
+	case 4: 
+	case 5: Nbt_SaveTag(tag, depth); return;
 	}
 	/* ClassicWorld -> Metadata -> CPE -> ExtName -> [values]
 	        0             1         2        3          4   */
 }
 
+static void Cw_MetadataCallback(struct NbtTag* tag) {
+	struct NbtTag* tmp = tag->parent;
+	int depth = 0;
+	while (tmp) { depth++; tmp = tmp->parent; }
+
+	if (depth == 4) Cw_Callback_4(tag);
+	if (depth == 5) Cw_Callback_5(tag);
+}
+
+static cc_result Cw_ApplyMetadata(void) {
+	return Nbt_ProcessSaved(Cw_MetadataCallback);
+}
+
 /* Imports a world from a .cw ClassicWorld map file */
 /* Used by ClassiCube/ClassicalSharp */
 static cc_result Cw_Load(struct Stream* stream) {
+	map.ApplyMetadata = Cw_ApplyMetadata;
 	return Nbt_Read(stream, Cw_Callback);
 }
 
@@ -1236,35 +1341,45 @@ Classic 0.15 to Classic 0.30:
 	VAR "Level"      (Java serialised level object instance)
 }*/
 
-static void Dat_Format0And1(void) {
-	/* Formats 0 and 1 don't store spawn position, so use default of map centre */
-	spawn_point = NULL;
-
+static cc_result Dat_ApplyFormat1Env(void) {
 	/* Similiar env to how it appears in preclassic - 0.13 classic client */
 	Env.CloudsHeight = -30000;
 	Env.SkyCol       = PackedCol_Make(0x7F, 0xCC, 0xFF, 0xFF);
 	Env.FogCol       = PackedCol_Make(0x7F, 0xCC, 0xFF, 0xFF);
+	return 0;
 }
 
-static cc_result Dat_LoadFormat0(struct Stream* stream) {
-	Dat_Format0And1();
+static cc_result Dat_ApplyFormat0Env(void) {
+	Dat_ApplyFormat1Env();
 	/* Similiar env to how it appears in preclassic client */
 	Env.EdgeBlock  = BLOCK_AIR;
 	Env.SidesBlock = BLOCK_AIR;
+	return 0;
+}
+
+static void Dat_Format0And1(void) {
+	/* Formats 0 and 1 don't store spawn position, so use default of map centre */
+	spawn_point = NULL;
+	map.ApplyMetadata = Dat_ApplyFormat1Env;
+}
+
+static cc_result Dat_LoadFormat0(struct Stream* stream) {
+	Dat_Format0And1();
+	map.ApplyMetadata = Dat_ApplyFormat0Env;
 
 	/* Map 'format' is just the 256x64x256 blocks of the level */
-	World.Width  = 256;
-	World.Height =  64;
-	World.Length = 256;
+	map.width  = 256;
+	map.height =  64;
+	map.length = 256;
 
 	#define PC_VOLUME (256 * 64 * 256)
-	World.Volume = PC_VOLUME;
-	World.Blocks = (BlockRaw*)Mem_TryAlloc(PC_VOLUME, 1);
-	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
+	map.volume = PC_VOLUME;
+	map.blocks = (BlockRaw*)Mem_TryAlloc(PC_VOLUME, 1);
+	if (!map.blocks) return ERR_OUT_OF_MEMORY;
 
 	/* First 5 bytes already read earlier as .dat header */
-	Mem_Set(World.Blocks, BLOCK_STONE, 5);
-	return Stream_Read(stream, World.Blocks + 5, PC_VOLUME - 5);
+	Mem_Set(map.blocks, BLOCK_STONE, 5);
+	return Stream_Read(stream, map.blocks + 5, PC_VOLUME - 5);
 }
 
 static cc_result Dat_LoadFormat1(struct Stream* stream) {
@@ -1279,9 +1394,9 @@ static cc_result Dat_LoadFormat1(struct Stream* stream) {
 	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
 	
 	/* bytes 0-8 = created timestamp (currentTimeMillis) */
-	World.Width  = Stream_GetU16_BE(header +  8);
-	World.Length = Stream_GetU16_BE(header + 10);
-	World.Height = Stream_GetU16_BE(header + 12);
+	map.width  = Stream_GetU16_BE(header +  8);
+	map.length = Stream_GetU16_BE(header + 10);
+	map.height = Stream_GetU16_BE(header + 12);
 	return Map_ReadBlocks(stream);
 }
 
@@ -1315,15 +1430,15 @@ static cc_result Dat_LoadFormat2(struct Stream* stream) {
 		fieldName = String_FromRaw((char*)field->FieldName, JNAME_SIZE);
 
 		if (String_CaselessEqualsConst(&fieldName, "width")) {
-			World.Width  = Java_I32(field);
+			map.width  = Java_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "height")) {
-			World.Length = Java_I32(field);
+			map.length = Java_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "depth")) {
-			World.Height = Java_I32(field);
+			map.height = Java_I32(field);
 		} else if (String_CaselessEqualsConst(&fieldName, "blocks")) {
 			if (field->Type != JFIELD_ARRAY) Process_Abort("Blocks field must be Array");
-			World.Blocks = field->Value.Array.Ptr;
-			World.Volume = field->Value.Array.Size;
+			map.blocks = field->Value.Array.Ptr;
+			map.volume = field->Value.Array.Size;
 		} else if (String_CaselessEqualsConst(&fieldName, "xSpawn")) {
 			spawn_point->pos.x = (float)Java_I32(field);
 			spawn_point->flags = LU_HAS_POS;
@@ -1396,13 +1511,13 @@ COMPOUND "MinecraftLevel" {
 static int mcl_edgeHeight, mcl_sidesHeight;
 
 static void MCLevel_ParseMap(struct NbtTag* tag) {
-	if (IsTag(tag, "width"))  { World.Width  = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "height")) { World.Height = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "length")) { World.Length = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "width"))  { map.width  = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "height")) { map.height = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "length")) { map.length = NbtTag_U16(tag); return; }
 
 	if (IsTag(tag, "blocks")) {
-		World.Volume = tag->dataSize;
-		World.Blocks = Nbt_TakeArray(tag, ".mclevel map blocks");
+		map.volume = tag->dataSize;
+		map.blocks = Nbt_TakeArray(tag, ".mclevel map blocks");
 	}
 }
 
@@ -1440,7 +1555,8 @@ static void MCLevel_Callback_2(struct NbtTag* tag) {
 	if (IsTag(group, "Map")) {
 		MCLevel_ParseMap(tag);
 	} else if (IsTag(group, "Environment")) {
-		MCLevel_ParseEnvironment(tag);
+		/* Environment changes the game's state, so must be processed on the main thread */
+		Nbt_SaveTag(tag, 2);
 	}
 }
 
@@ -1473,14 +1589,198 @@ static void MCLevel_Callback(struct NbtTag* tag) {
 
 /* Imports a world from a .mclevel NBT map file */
 /* Used by Minecraft Indev client */
-static cc_result MCLevel_Load(struct Stream* stream) {
-	cc_result res = Nbt_Read(stream, MCLevel_Callback);
+static cc_result MCLevel_ApplyMetadata(void) {
+	cc_result res = Nbt_ProcessSaved(MCLevel_ParseEnvironment);
 
 	Env.EdgeHeight  = mcl_edgeHeight;
 	Env.SidesOffset = mcl_sidesHeight - mcl_edgeHeight;
 	return res;
 }
 
+static cc_result MCLevel_Load(struct Stream* stream) {
+	map.ApplyMetadata = MCLevel_ApplyMetadata;
+	return Nbt_Read(stream, MCLevel_Callback);
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Map loading-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Built-in importers only write to the map being imported (and defer changing the game's */
+/*  state to ApplyMetadata), so they can safely be run on a background thread */
+static cc_bool MapImporter_IsThreadSafe(struct MapImporter* imp) {
+	return imp->import == Cw_Load  || imp->import == Dat_Load || imp->import == Lvl_Load ||
+		   imp->import == Fcm_Load || imp->import == MCLevel_Load;
+}
+
+static void Map_BeginImport(void) {
+	Mem_Set(&map, 0, sizeof(map));
+	spawn_point = &map.spawn;
+}
+
+static void Map_FreeImport(void) {
+#ifdef EXTENDED_BLOCKS
+	if (map.blocks2 != map.blocks) Mem_Free(map.blocks2);
+	map.blocks2 = NULL;
+#endif
+	Mem_Free(map.blocks);
+	map.blocks = NULL;
+	Nbt_FreeSaved();
+}
+
+static void Map_EndImport(cc_result res, const cc_string* path) {
+	cc_string relPath, fileName, fileExt;
+	struct LocationUpdate update;
+
+	if (!res && map.ApplyMetadata) res = map.ApplyMetadata();
+	if (res) {
+		Map_FreeImport();
+		Logger_SysWarn2(res, "decoding", path);
+		World_Reset();
+	}
+
+	/* Importers registered by plugins import directly into World instead */
+	if (!map.blocks && World.Blocks) {
+		map.blocks = World.Blocks;
+		map.width  = World.Width; map.height = World.Height; map.length = World.Length;
+	} else {
+		if (map.hasUuid) Mem_Copy(World.Uuid, map.uuid, WORLD_UUID_LEN);
+		World.Seed = map.seed;
+#ifdef EXTENDED_BLOCKS
+		if (map.blocks2) World_SetMapUpper(map.blocks2);
+#endif
+	}
+
+	update = map.spawn;
+	World_SetNewMap(map.blocks, map.width, map.height, map.length);
+	if (!spawn_point) LocalPlayer_CalcDefaultSpawn(Entities.CurPlayer, &update);
+	LocalPlayers_MoveToSpawn(&update);
+
+	/* World now owns the blocks arrays */
+	Mem_Set(&map, 0, sizeof(map));
+	relPath = *path;
+	Utils_UNSAFE_GetFilename(&relPath);
+	String_UNSAFE_Separate(&relPath, '.', &fileName, &fileExt);
+	String_Copy(&World.Name, &fileName);
+}
+
+static cc_result Map_Open(struct Stream* stream, const cc_string* path, struct MapImporter** imp) {
+	cc_result res;
+	Game_Reset();
+
+	res = Stream_OpenFile(stream, path);
+	if (res) { Logger_SysWarn2(res, "opening", path); return res; }
+
+	*imp = MapImporter_Find(path);
+	Map_BeginImport();
+	return 0;
+}
+
+cc_result Map_LoadFrom(const cc_string* path) {
+	struct MapImporter* imp;
+	struct Stream stream;
+	cc_result res;
+
+	res = Map_Open(&stream, path, &imp);
+	if (res) return res;
+
+	res = imp ? imp->import(&stream) : ERR_NOT_SUPPORTED;
+	/* No point logging error for closing readonly file */
+	(void)stream.Close(&stream);
+
+	Map_EndImport(res, path);
+	return res;
+}
+
+#ifdef CC_BUILD_COOPTHREADED
+/* No point importing on a background thread when it would block the main thread anyways */
+cc_result Map_LoadFromAsync(const cc_string* path) { return Map_LoadFrom(path); }
+float Map_AsyncProgress(void) { return 0.0f; }
+void Map_CheckAsyncLoad(void) { }
+static void Map_CancelAsyncLoad(void) { }
+#else
+static void* map_thread;
+static struct Stream map_file, map_progress;
+static struct MapImporter* map_importer;
+static cc_result map_loadResult;
+static cc_uint32 map_loadLength;
+static volatile cc_uint32 map_loadRead;
+static volatile cc_bool map_loadDone, map_loadCancel;
+static char map_pathBuffer[FILENAME_SIZE];
+static cc_string map_loadPath = String_FromArray(map_pathBuffer);
+
+static cc_result Map_ProgressRead(struct Stream* s, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	struct Stream* source = s->meta.portion.source;
+	cc_result res;
+	/* Returning an error here makes the importer stop early (the result is discarded anyways) */
+	if (map_loadCancel) return ERR_NOT_SUPPORTED;
+
+	res = source->Read(source, data, count, modified);
+	map_loadRead += *modified;
+	return res;
+}
+
+static void Map_LoadThread(void) {
+	map_loadResult = map_importer->import(&map_progress);
+	map_loadDone   = true;
+}
+
+static void Map_FinishAsyncLoad(void) {
+	Thread_Join(map_thread);
+	map_thread = NULL;
+	(void)map_file.Close(&map_file);
+}
+
+cc_result Map_LoadFromAsync(const cc_string* path) {
+	cc_result res;
+	res = Map_Open(&map_file, path, &map_importer);
+	if (res) return res;
+
+	if (!map_importer || !MapImporter_IsThreadSafe(map_importer)) {
+		res = map_importer ? map_importer->import(&map_file) : ERR_NOT_SUPPORTED;
+		(void)map_file.Close(&map_file);
+
+		Map_EndImport(res, path);
+		return res;
+	}
+
+	Stream_Init(&map_progress);
+	map_progress.Read = Map_ProgressRead;
+	map_progress.meta.portion.source = &map_file;
+
+	if (map_file.Length(&map_file, &map_loadLength)) map_loadLength = 0;
+	map_loadRead   = 0;
+	map_loadDone   = false;
+	map_loadCancel = false;
+	String_Copy(&map_loadPath, path);
+
+	/* NOTE: Larger stack size needed for .dat, as it reads the Java class descriptors on the stack */
+	Thread_Run(&map_thread, Map_LoadThread, 256 * 1024, "Map loading");
+	MapLoadingScreen_Show(path);
+	return 0;
+}
+
+float Map_AsyncProgress(void) {
+	if (!map_loadLength) return 0.0f;
+	return (float)map_loadRead / map_loadLength;
+}
+
+void Map_CheckAsyncLoad(void) {
+	if (!map_thread || !map_loadDone) return;
+
+	Map_FinishAsyncLoad();
+	Map_EndImport(map_loadResult, &map_loadPath);
+}
+
+static void Map_CancelAsyncLoad(void) {
+	if (!map_thread) return;
+
+	map_loadCancel = true;
+	Map_FinishAsyncLoad();
+	Map_FreeImport();
+}
+#endif
+
 
 /*########################################################################################################################*
 *--------------------------------------------------ClassicWorld export----------------------------------------------------*
@@ -1875,23 +2175,33 @@ static void OnInit(void) {
 	MapImporter_Register(&mclvl_imp);
 }
 
+static void OnReset(void) {
+	Map_CancelAsyncLoad();
+}
+
 static void OnFree(void) {
+	Map_CancelAsyncLoad();
 	imp_head = NULL;
 }
 #else
 /* No point including map format code when can't save/load maps anyways */
 struct MapImporter* MapImporter_Find(const cc_string* path) { return NULL; }
 cc_result Map_LoadFrom(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+cc_result Map_LoadFromAsync(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+float Map_AsyncProgress(void) { return 0.0f; }
+void Map_CheckAsyncLoad(void) { }
 
 cc_result Cw_Save(struct Stream* stream)  { return ERR_NOT_SUPPORTED; }
 cc_result Dat_Save(struct Stream* stream) { return ERR_NOT_SUPPORTED; }
 cc_result Schematic_Save(struct Stream* stream) { return ERR_NOT_SUPPORTED; }
 
-static void OnInit(void) { }
-static void OnFree(void) { }
+static void OnInit(void)  { }
+static void OnReset(void) { }
+static void OnFree(void)  { }
 #endif
 
 struct IGameComponent Formats_Component = {
 	OnInit, /* Init  */
-	OnFree  /* Free  */
+	OnFree, /* Free  */
+	OnReset /* Reset */
 };
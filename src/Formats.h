@@ -28,6 +28,14 @@ CC_API void MapImporter_Register(struct MapImporter* imp);
 CC_API struct MapImporter* MapImporter_Find(const cc_string* path);
 /* Attempts to import a map from the given file */
 CC_API cc_result Map_LoadFrom(const cc_string* path);
+/* Same as Map_LoadFrom, but imports the map on a background thread while showing a loading screen */
+/* NOTE: Errors opening the file are returned, but errors importing the map are only logged */
+/* NOTE: Falls back to importing on the main thread for importers registered by plugins */
+cc_result Map_LoadFromAsync(const cc_string* path);
+/* Returns how much of the map file has been read so far by Map_LoadFromAsync, from 0 to 1 */
+float Map_AsyncProgress(void);
+/* Finishes loading the map (e.g. calls World_SetNewMap) if Map_LoadFromAsync has completed importing it */
+void Map_CheckAsyncLoad(void);
 
 /* Exports a world to a .cw ClassicWorld map file. */
 /* Compatible with ClassiCube/ClassicalSharp */
@@ -214,6 +214,32 @@ void Game_ChangeBlock(int x, int y, int z, BlockID block) {
 	Server.SendBlock(x, y, z, old, block);
 }
 
+void Game_UpdateBlocks(const IVec3* coords, const BlockID* blocks, BlockID* oldBlocks, int count) {
+	int i;
+	for (i = 0; i < count; i++) 
+	{
+		oldBlocks[i] = World_GetBlock(coords[i].x, coords[i].y, coords[i].z);
+		World_SetBlock(coords[i].x, coords[i].y, coords[i].z, blocks[i]);
+	}
+
+	if (Weather_Heightmap) {
+		EnvRenderer_OnBlocksChanged(coords, oldBlocks, blocks, count);
+	}
+	Lighting.OnBlocksChanged(coords, oldBlocks, blocks, count);
+	MapRenderer_OnBlocksChanged(coords, blocks, count);
+	Event_RaiseBlocks(&WorldEvents.BlocksChanged, coords, oldBlocks, blocks, count);
+}
+
+void Game_ChangeBlocks(const IVec3* coords, const BlockID* blocks, BlockID* oldBlocks, int count) {
+	int i;
+	Game_UpdateBlocks(coords, blocks, oldBlocks, count);
+
+	for (i = 0; i < count; i++) 
+	{
+		Server.SendBlock(coords[i].x, coords[i].y, coords[i].z, oldBlocks[i], blocks[i]);
+	}
+}
+
 cc_bool Game_CanPick(BlockID block) {
 	if (Blocks.Draw[block] == DRAW_GAS)    return false;
 	if (Blocks.Draw[block] == DRAW_SPRITE) return true;
@@ -1,6 +1,7 @@
 #ifndef CC_GAME_H
 #define CC_GAME_H
 #include "Core.h"
+#include "Vectors.h"
 CC_BEGIN_HEADER
 
 /* Represents the game and related structures.
@@ -106,6 +107,13 @@ CC_API void Game_UpdateBlock(int x, int y, int z, BlockID block);
 /* Calls Game_UpdateBlock, then informs server connection of the block change. */
 /* In multiplayer this is sent to the server, in singleplayer just activates physics. */
 CC_API void Game_ChangeBlock(int x, int y, int z, BlockID block);
+/* Sets all of the given blocks in the map first, then updates state associated with the blocks. */
+/* (state is only updated once for each column/chunk of changed blocks, instead of for every block) */
+/* NOTE: oldBlocks is set to the blocks that were previously at each of the coordinates. */
+/* NOTE: This does NOT notify the server, use Game_ChangeBlocks for that. */
+CC_API void Game_UpdateBlocks(const IVec3* coords, const BlockID* blocks, BlockID* oldBlocks, int count);
+/* Calls Game_UpdateBlocks, then informs server connection of each of the block changes. */
+CC_API void Game_ChangeBlocks(const IVec3* coords, const BlockID* blocks, BlockID* oldBlocks, int count);
 
 cc_bool Game_CanPick(BlockID block);
 /* Updates Game_Width and Game_Height. */
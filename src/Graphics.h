@@ -28,11 +28,12 @@ struct MenuOptionsScreen;
 extern struct IGameComponent Gfx_Component;
 
 typedef enum VertexFormat_ {
-	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED
+	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED, VERTEX_FORMAT_CHUNK
 } VertexFormat;
 
 #define SIZEOF_VERTEX_COLOURED 16
 #define SIZEOF_VERTEX_TEXTURED 24
+#define SIZEOF_VERTEX_CHUNK    12
 
 #if defined CC_BUILD_PSP
 /* 3 floats for position (XYZ), 4 bytes for colour */
@@ -45,6 +46,14 @@ struct VertexColoured { float x, y, z; PackedCol Col; };
 /* 3 floats for position (XYZ), 2 floats for texture coordinates (UV), 4 bytes for colour */
 struct VertexTextured { float x, y, z; PackedCol Col; float U, V; };
 #endif
+/* 3 fixed point shorts for position (XYZ) relative to chunk origin, 2 bytes for RGB565 colour, */
+/*  2 fixed point shorts for texture coordinates (UV). Only used for chunk meshes. */
+/* NOTE: Only supported when Gfx.SupportsChunkVertices is true */
+struct VertexChunk { cc_int16 x, y, z; cc_uint16 Col; cc_uint16 U, V; };
+/* Scale factors for the fixed point components of VertexChunk */
+#define VERTEX_CHUNK_POS_SCALE 1024
+#define VERTEX_CHUNK_U_SCALE   4096
+#define VERTEX_CHUNK_V_SCALE   65536
 
 void Gfx_Create(void);
 void Gfx_Free(void);
@@ -72,7 +81,12 @@ CC_VAR extern struct _GfxData {
 	cc_uint8 Limitations;
 	/* Type of the backend (e.g. OpenGL, Direct3D 9, etc)*/
 	cc_uint8 BackendType;
-	cc_bool __pad;
+	/* Whether the graphics backend supports VERTEX_FORMAT_CHUNK */
+	cc_bool SupportsChunkVertices;
+	/* Whether the graphics backend supports ranged vertex buffers (see Gfx_CreateRangedVb) */
+	cc_bool SupportsRangedVbs;
+	/* Whether the graphics backend supports wrapping texture V within a tile (see Gfx_EnableTileWrap) */
+	cc_bool SupportsTileWrap;
 	/* Maximum total size in pixels a low resolution texture can consist of */
 	/* NOTE: Not all graphics backends specify a value for this */
 	int MaxLowResTexSize;
@@ -331,6 +345,16 @@ CC_API void  Gfx_UnlockDynamicVb(GfxResourceID vb);
 /* Updates the data of a dynamic vertex buffer */
 CC_API void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount);
 
+/* Creates a new vertex buffer, whose contents are changed in separate parts using Gfx_LockVbRange */
+/*  (e.g. so that the meshes of many chunks can be stored in the same vertex buffer) */
+/* NOTE: Only supported when Gfx.SupportsRangedVbs is true, returns 0 on failure */
+/* NOTE: Deleted/bound using Gfx_DeleteVb/Gfx_BindVb */
+GfxResourceID Gfx_CreateRangedVb(VertexFormat fmt, int count);
+/* Acquires temp memory for changing the given range of vertices in a ranged vertex buffer */
+void* Gfx_LockVbRange(GfxResourceID vb, VertexFormat fmt, int offset, int count);
+/* Submits the changed range of vertices in a ranged vertex buffer */
+void  Gfx_UnlockVbRange(GfxResourceID vb);
+
 
 /*########################################################################################################################*
 *------------------------------------------------------Vertex drawing-----------------------------------------------------*
@@ -406,6 +430,16 @@ CC_API void Gfx_LoadMatrix(MatrixType type, const struct Matrix* matrix);
 CC_API void Gfx_EnableTextureOffset(float x, float y);
 /* Disables texture U/V translation */
 CC_API void Gfx_DisableTextureOffset(void);
+
+/* Texture V coordinates at or above this value are wrapped within a single tile, when tile wrapping is enabled */
+/*  Such coordinates are encoded as (tile row + 1) * GFX_TILE_WRAP_SCALE + V within the tile (in tiles) */
+/*  (e.g. so a face stretched across several blocks can repeat one tile of a vertically stacked atlas) */
+#define GFX_TILE_WRAP_SCALE 16
+/* Enables wrapping of encoded texture V coordinates within tiles that are tileSize high (in texture V units) */
+/* NOTE: Only supported when Gfx.SupportsTileWrap is true, and only for VERTEX_FORMAT_TEXTURED */
+void Gfx_EnableTileWrap(float tileSize);
+/* Disables wrapping of texture V coordinates within tiles */
+void Gfx_DisableTileWrap(void);
 /* Loads given modelview and projection matrices, then calculates the combined MVP matrix */
 void Gfx_LoadMVP(const struct Matrix* view, const struct Matrix* proj, struct Matrix* mvp);
 
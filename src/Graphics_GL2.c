@@ -49,6 +49,9 @@ void Gfx_Create(void) {
 	GLContext_GetAll(core_funcs, Array_Elems(core_funcs));
 #endif
 	Gfx.BackendType = CC_GFX_BACKEND_GL2;
+	Gfx.SupportsChunkVertices = true;
+	Gfx.SupportsRangedVbs     = true;
+	Gfx.SupportsTileWrap      = true;
 	
 	GL_InitCommon();
 	GLBackend_Init();
@@ -115,6 +118,27 @@ void Gfx_UnlockVb(GfxResourceID vb) {
 	glBufferData(GL_ARRAY_BUFFER, tmpSize, tmpData, GL_STATIC_DRAW);
 }
 
+/* Offset in bytes of the range of the vertex buffer that is currently locked */
+static cc_uint32 lockedRangeOffset;
+
+GfxResourceID Gfx_CreateRangedVb(VertexFormat fmt, int count) {
+	GLuint id      = GL_GenAndBind(GL_ARRAY_BUFFER);
+	cc_uint32 size = count * strideSizes[fmt];
+
+	glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+	return uint_to_ptr(id);
+}
+
+void* Gfx_LockVbRange(GfxResourceID vb, VertexFormat fmt, int offset, int count) {
+	lockedRangeOffset = offset * strideSizes[fmt];
+	return FastAllocTempMem(count * strideSizes[fmt]);
+}
+
+void Gfx_UnlockVbRange(GfxResourceID vb) {
+	glBindBuffer(GL_ARRAY_BUFFER, ptr_to_uint(vb));
+	glBufferSubData(GL_ARRAY_BUFFER, lockedRangeOffset, tmpSize, tmpData);
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------Dynamic vertex buffers-------------------------------------------------*
@@ -162,6 +186,8 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 #define FTR_LINEAR_FOG (1 << 3)
 #define FTR_DENSIT_FOG (1 << 4)
 #define FTR_HASANY_FOG (FTR_LINEAR_FOG | FTR_DENSIT_FOG)
+#define FTR_CHUNK_VERT (1 << 5)
+#define FTR_TILE_WRAP  (1 << 6)
 #define FTR_FS_MEDIUMP (1 << 7)
 
 #define UNI_MVP_MATRIX (1 << 0)
@@ -169,12 +195,13 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 #define UNI_FOG_COL    (1 << 2)
 #define UNI_FOG_END    (1 << 3)
 #define UNI_FOG_DENS   (1 << 4)
-#define UNI_MASK_ALL   0x1F
+#define UNI_TILE_SIZE  (1 << 5)
+#define UNI_MASK_ALL   0x3F
 
 /* cached uniforms (cached for multiple programs */
 static struct Matrix _view, _proj, _mvp;
-static cc_bool gfx_texTransform;
-static float _texX, _texY;
+static cc_bool gfx_texTransform, gfx_tileWrap;
+static float _texX, _texY, _tileSize;
 static PackedCol gfx_fogColor;
 static float gfx_fogEnd = -1.0f, gfx_fogDensity = -1.0f;
 static int gfx_fogMode = -1;
@@ -184,8 +211,8 @@ static struct GLShader {
 	int features;     /* what features are enabled for this shader */
 	int uniforms;     /* which associated uniforms need to be resent to GPU */
 	GLuint program;   /* OpenGL program ID (0 if not yet compiled) */
-	int locations[5]; /* location of uniforms (not constant) */
-} shaders[6 * 3] = {
+	int locations[6]; /* location of uniforms (not constant) */
+} shaders[6 * 3 + 2 * 3 + 2 * 3] = {
 	/* no fog */
 	{ 0              },
 	{ 0              | FTR_ALPHA_TEST },
@@ -207,6 +234,20 @@ static struct GLShader {
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET | FTR_ALPHA_TEST },
+	/* chunk vertices (no fog, linear fog, density fog) */
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_LINEAR_FOG },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_LINEAR_FOG | FTR_ALPHA_TEST },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_DENSIT_FOG },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_DENSIT_FOG | FTR_ALPHA_TEST },
+	/* tile wrapped textured vertices (no fog, linear fog, density fog) */
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV },
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV | FTR_LINEAR_FOG },
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV | FTR_LINEAR_FOG | FTR_ALPHA_TEST },
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV | FTR_DENSIT_FOG },
+	{ FTR_TILE_WRAP  | FTR_TEXTURE_UV | FTR_DENSIT_FOG | FTR_ALPHA_TEST },
 };
 static struct GLShader* gfx_activeShader;
 
@@ -214,20 +255,42 @@ static struct GLShader* gfx_activeShader;
 static void GenVertexShader(const struct GLShader* shader, cc_string* dst) {
 	int uv = shader->features & FTR_TEXTURE_UV;
 	int tm = shader->features & FTR_TEX_OFFSET;
+	int ck = shader->features & FTR_CHUNK_VERT;
+	int tw = shader->features & FTR_TILE_WRAP;
 
 	String_AppendConst(dst,         "attribute vec3 in_pos;\n");
-	String_AppendConst(dst,         "attribute vec4 in_col;\n");
+	if (ck) String_AppendConst(dst, "attribute float in_col;\n");
+	else    String_AppendConst(dst, "attribute vec4 in_col;\n");
 	if (uv) String_AppendConst(dst, "attribute vec2 in_uv;\n");
 	String_AppendConst(dst,         "varying vec4 out_col;\n");
 	if (uv) String_AppendConst(dst, "varying vec2 out_uv;\n");
+	if (tw) String_AppendConst(dst, "varying float out_tile;\n");
 	String_AppendConst(dst,         "uniform mat4 mvp;\n");
 	if (tm) String_AppendConst(dst, "uniform vec2 texOffset;\n");
 
 	String_AppendConst(dst,         "void main() {\n");
 	String_AppendConst(dst,         "  gl_Position = mvp * vec4(in_pos, 1.0);\n");
-	String_AppendConst(dst,         "  out_col = in_col;\n");
-	if (uv) String_AppendConst(dst, "  out_uv  = in_uv;\n");
+
+	if (ck) {
+		/* Chunk vertices have RGB565 colour and fixed point texture coordinates */
+		String_AppendConst(dst, "  vec3 rgb = mod(floor(in_col / vec3(2048.0, 32.0, 1.0)), vec3(32.0, 64.0, 32.0));\n");
+		String_AppendConst(dst, "  out_col = vec4(rgb / vec3(31.0, 63.0, 31.0), 1.0);\n");
+		String_AppendConst(dst, "  out_uv  = in_uv * vec2(1.0 / 4096.0, 1.0 / 65536.0);\n");
+	} else {
+		String_AppendConst(dst,         "  out_col = in_col;\n");
+		if (uv) String_AppendConst(dst, "  out_uv  = in_uv;\n");
+	}
 	if (tm) String_AppendConst(dst, "  out_uv  = out_uv + texOffset;\n");
+
+	if (tw) {
+		/* Split encoded V into tile row and V within the tile (see GFX_TILE_WRAP_SCALE) */
+		/* Done here, as fragment shaders may only have mediump precision */
+		String_AppendConst(dst, "  out_tile = -1.0;\n");
+		String_AppendConst(dst, "  if (out_uv.y >= 16.0) {\n");
+		String_AppendConst(dst, "    out_tile = floor(out_uv.y / 16.0) - 1.0;\n");
+		String_AppendConst(dst, "    out_uv.y = out_uv.y - (out_tile + 1.0) * 16.0;\n");
+		String_AppendConst(dst, "  }\n");
+	}
 	String_AppendConst(dst,         "}");
 }
 
@@ -247,6 +310,7 @@ static void GenFragmentShader(const struct GLShader* shader, cc_string* dst) {
 	int fl = shader->features & FTR_LINEAR_FOG;
 	int fd = shader->features & FTR_DENSIT_FOG;
 	int fm = shader->features & FTR_HASANY_FOG;
+	int tw = shader->features & FTR_TILE_WRAP;
 
 #ifdef CC_BUILD_GLES
 	int mp = shader->features & FTR_FS_MEDIUMP;
@@ -256,14 +320,21 @@ static void GenFragmentShader(const struct GLShader* shader, cc_string* dst) {
 
 	String_AppendConst(dst,         "varying vec4 out_col;\n");
 	if (uv) String_AppendConst(dst, "varying vec2 out_uv;\n");
+	if (tw) String_AppendConst(dst, "varying float out_tile;\n");
 	if (uv) String_AppendConst(dst, "uniform sampler2D texImage;\n");
+	if (tw) String_AppendConst(dst, "uniform float tileSize;\n");
 	if (fm) String_AppendConst(dst, "uniform vec3 fogCol;\n");
 	if (fl) String_AppendConst(dst, "uniform float fogEnd;\n");
 	if (fd) String_AppendConst(dst, "uniform float fogDensity;\n");
 
 	String_AppendConst(dst,         "void main() {\n");
-	if (uv) String_AppendConst(dst, "  vec4 col = texture2D(texImage, out_uv) * out_col;\n");
-	else    String_AppendConst(dst, "  vec4 col = out_col;\n");
+	if (tw) {
+		String_AppendConst(dst, "  vec2 uv = out_uv;\n");
+		String_AppendConst(dst, "  if (out_tile >= 0.0) uv.y = (out_tile + fract(uv.y)) * tileSize;\n");
+		String_AppendConst(dst, "  vec4 col = texture2D(texImage, uv) * out_col;\n");
+	}
+	else if (uv) String_AppendConst(dst, "  vec4 col = texture2D(texImage, out_uv) * out_col;\n");
+	else         String_AppendConst(dst, "  vec4 col = out_col;\n");
 	if (al) String_AppendConst(dst, "  if (col.a < 0.5) discard;\n");
 	if (fm) String_AppendConst(dst, "  float depth = 1.0 / gl_FragCoord.w;\n");
 	if (fl) String_AppendConst(dst, "  float f = clamp(1.0 - depth * fogEnd, 0.0, 1.0);\n");
@@ -362,6 +433,7 @@ static void CompileProgram(struct GLShader* shader) {
 		shader->locations[2] = glGetUniformLocation(program, "fogCol");
 		shader->locations[3] = glGetUniformLocation(program, "fogEnd");
 		shader->locations[4] = glGetUniformLocation(program, "fogDensity");
+		shader->locations[5] = glGetUniformLocation(program, "tileSize");
 		return;
 	}
 	temp = 0;
@@ -411,6 +483,10 @@ static void ReloadUniforms(void) {
 		glUniform1f(s->locations[4], -gfx_fogDensity);
 		s->uniforms &= ~UNI_FOG_DENS;
 	}
+	if ((s->uniforms & UNI_TILE_SIZE) && (s->features & FTR_TILE_WRAP)) {
+		glUniform1f(s->locations[5], _tileSize);
+		s->uniforms &= ~UNI_TILE_SIZE;
+	}
 }
 
 /* Switches program to one that duplicates current fixed function state */
@@ -424,9 +500,17 @@ static void SwitchProgram(void) {
 		if (gfx_fogMode >= 1) index += 6; /* exp fog */
 	}
 
-	if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
-	if (gfx_texTransform) index += 2;
-	if (gfx_alphaTest)    index += 1;
+	if (gfx_format == VERTEX_FORMAT_CHUNK) {
+		/* chunk shaders come after the 3 groups of 6 normal shaders */
+		index = 6 * 3 + (index / 6) * 2;
+	} else if (gfx_format == VERTEX_FORMAT_TEXTURED && gfx_tileWrap) {
+		/* tile wrap shaders come after the 3 groups of 2 chunk shaders */
+		index = 6 * 3 + 2 * 3 + (index / 6) * 2;
+	} else {
+		if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
+		if (gfx_texTransform) index += 2;
+	}
+	if (gfx_alphaTest) index += 1;
 
 	shader = &shaders[index];
 	if (shader == gfx_activeShader) { ReloadUniforms(); return; }
@@ -521,6 +605,18 @@ void Gfx_DisableTextureOffset(void) {
 	SwitchProgram();
 }
 
+void Gfx_EnableTileWrap(float tileSize) {
+	_tileSize    = tileSize;
+	gfx_tileWrap = true;
+	DirtyUniform(UNI_TILE_SIZE);
+	SwitchProgram();
+}
+
+void Gfx_DisableTileWrap(void) {
+	gfx_tileWrap = false;
+	SwitchProgram();
+}
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------State setup-------------------------------------------------------*
@@ -647,6 +743,12 @@ static void GL_SetupVbTextured(void) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, SIZEOF_VERTEX_TEXTURED, uint_to_ptr(16));
 }
 
+static void GL_SetupVbChunk(void) {
+	glVertexAttribPointer(0, 3, GL_SHORT,          false, SIZEOF_VERTEX_CHUNK, uint_to_ptr( 0));
+	glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr( 6));
+	glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr( 8));
+}
+
 static void GL_SetupVbColoured_Range(int startVertex) {
 	cc_uint32 offset = startVertex * SIZEOF_VERTEX_COLOURED;
 	glVertexAttribPointer(0, 3, GL_FLOAT,         false, SIZEOF_VERTEX_COLOURED, uint_to_ptr(offset     ));
@@ -660,6 +762,13 @@ static void GL_SetupVbTextured_Range(int startVertex) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, SIZEOF_VERTEX_TEXTURED, uint_to_ptr(offset + 16));
 }
 
+static void GL_SetupVbChunk_Range(int startVertex) {
+	cc_uint32 offset = startVertex * SIZEOF_VERTEX_CHUNK;
+	glVertexAttribPointer(0, 3, GL_SHORT,          false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset    ));
+	glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset + 6));
+	glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset + 8));
+}
+
 void Gfx_SetVertexFormat(VertexFormat fmt) {
 	if (fmt == gfx_format) return;
 	gfx_format = fmt;
@@ -669,6 +778,10 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 		glEnableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbTextured;
 		gfx_setupVBRangeFunc = GL_SetupVbTextured_Range;
+	} else if (fmt == VERTEX_FORMAT_CHUNK) {
+		glEnableVertexAttribArray(2);
+		gfx_setupVBFunc      = GL_SetupVbChunk;
+		gfx_setupVBRangeFunc = GL_SetupVbChunk_Range;
 	} else {
 		glDisableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbColoured;
@@ -692,16 +805,17 @@ void Gfx_DrawVb_IndexedTris(int verticesCount) {
 	glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
 }
 
+/* NOTE: Also used with VERTEX_FORMAT_CHUNK, so uses the current format's setup functions */
 void Gfx_BindVb_Textured(GfxResourceID vb) {
 	Gfx_BindVb(vb);
-	GL_SetupVbTextured();
+	gfx_setupVBFunc();
 }
 
 void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	if (startVertex + verticesCount > GFX_MAX_VERTICES) {
-		GL_SetupVbTextured_Range(startVertex);
+		gfx_setupVBRangeFunc(startVertex);
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
-		GL_SetupVbTextured();
+		gfx_setupVBFunc();
 	} else {
 		/* ICOUNT(startVertex) * 2 = startVertex * 3  */
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, uint_to_ptr(startVertex * 3));
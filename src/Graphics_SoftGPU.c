@@ -49,6 +49,9 @@ void Gfx_Create(void) {
 
 	Gfx.Created      = true;
 	Gfx.BackendType  = CC_GFX_BACKEND_SOFTGPU;
+	Gfx.SupportsChunkVertices = true;
+	Gfx.SupportsRangedVbs     = true;
+	Gfx.SupportsTileWrap      = true;
 	
 	Gfx_RestoreState();
 }
@@ -229,6 +232,19 @@ void Gfx_UnlockVb(GfxResourceID vb) {
 	gfx_vertices = vb; 
 }
 
+/* Ranged vertex buffers are just plain memory, so ranges can be changed in place */
+GfxResourceID Gfx_CreateRangedVb(VertexFormat fmt, int count) {
+	return Mem_TryAlloc(count, strideSizes[fmt]);
+}
+
+void* Gfx_LockVbRange(GfxResourceID vb, VertexFormat fmt, int offset, int count) {
+	return (cc_uint8*)vb + offset * strideSizes[fmt];
+}
+
+void Gfx_UnlockVbRange(GfxResourceID vb) {
+	gfx_vertices = vb;
+}
+
 
 static GfxResourceID Gfx_AllocDynamicVb(VertexFormat fmt, int maxVertices) {
 	return Mem_TryAlloc(maxVertices, strideSizes[fmt]);
@@ -278,6 +294,19 @@ void Gfx_DisableTextureOffset(void) {
 	texOffsetY = 0;
 }
 
+// Height of tiles that encoded texture V coordinates wrap within, or 0 if tile wrapping is disabled
+static float tileWrapSize;
+// Texture Y of the start of the tile that the current quad wraps within, or -1 if it doesn't
+static int tileWrapY = -1, tileWrapMask;
+
+void Gfx_EnableTileWrap(float tileSize) {
+	tileWrapSize = tileSize;
+}
+
+void Gfx_DisableTileWrap(void) {
+	tileWrapSize = 0;
+}
+
 void Gfx_CalcOrthoMatrix(struct Matrix* matrix, float width, float height, float zNear, float zFar) {
 	/* Source https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixorthooffcenterrh */
 	/*   The simplified calculation below uses: L = 0, R = width, T = 0, B = height */
@@ -342,17 +371,36 @@ static void TransformVertex2D(int index, Vertex* vertex) {
 	}
 }
 
+// Expands a RGB565 colour from a VertexChunk
+static CC_INLINE PackedCol UnpackChunkCol(cc_uint16 col) {
+	int r = (col >> 11) & 0x1F, g = (col >> 5) & 0x3F, b = col & 0x1F;
+	return PackedCol_Make((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255);
+}
+
 static int TransformVertex3D(int index, Vertex* vertex) {
 	// TODO: avoid the multiply, just add down in DrawTriangles
 	char* ptr = (char*)gfx_vertices + index * gfx_stride;
-	Vector3* pos = (Vector3*)ptr;
+	float x, y, z;
 
-	vertex->x = pos->x * _mvp.row1.x + pos->y * _mvp.row2.x + pos->z * _mvp.row3.x + _mvp.row4.x;
-	vertex->y = pos->x * _mvp.row1.y + pos->y * _mvp.row2.y + pos->z * _mvp.row3.y + _mvp.row4.y;
-	vertex->z = pos->x * _mvp.row1.z + pos->y * _mvp.row2.z + pos->z * _mvp.row3.z + _mvp.row4.z;
-	vertex->w = pos->x * _mvp.row1.w + pos->y * _mvp.row2.w + pos->z * _mvp.row3.w + _mvp.row4.w;
+	if (gfx_format == VERTEX_FORMAT_CHUNK) {
+		struct VertexChunk* v = (struct VertexChunk*)ptr;
+		x = v->x; y = v->y; z = v->z;
+	} else {
+		Vector3* pos = (Vector3*)ptr;
+		x = pos->x; y = pos->y; z = pos->z;
+	}
 
-	if (gfx_format != VERTEX_FORMAT_TEXTURED) {
+	vertex->x = x * _mvp.row1.x + y * _mvp.row2.x + z * _mvp.row3.x + _mvp.row4.x;
+	vertex->y = x * _mvp.row1.y + y * _mvp.row2.y + z * _mvp.row3.y + _mvp.row4.y;
+	vertex->z = x * _mvp.row1.z + y * _mvp.row2.z + z * _mvp.row3.z + _mvp.row4.z;
+	vertex->w = x * _mvp.row1.w + y * _mvp.row2.w + z * _mvp.row3.w + _mvp.row4.w;
+
+	if (gfx_format == VERTEX_FORMAT_CHUNK) {
+		struct VertexChunk* v = (struct VertexChunk*)ptr;
+		vertex->u = v->U * (1.0f / VERTEX_CHUNK_U_SCALE);
+		vertex->v = v->V * (1.0f / VERTEX_CHUNK_V_SCALE);
+		vertex->c = UnpackChunkCol(v->Col);
+	} else if (gfx_format != VERTEX_FORMAT_TEXTURED) {
 		struct VertexColoured* v = (struct VertexColoured*)ptr;
 		vertex->u = 0.0f;
 		vertex->v = 0.0f;
@@ -366,6 +414,20 @@ static int TransformVertex3D(int index, Vertex* vertex) {
 	return vertex->z >= 0.0f;
 }
 
+// Makes texture V of a quad relative to the start of the tile it wraps within (see GFX_TILE_WRAP_SCALE)
+static void UnwrapTileQuad(Vertex* vertices) {
+	int row = (int)(vertices[0].v / GFX_TILE_WRAP_SCALE) - 1;
+	float base = (float)((row + 1) * GFX_TILE_WRAP_SCALE);
+
+	for (int i = 0; i < 4; i++)
+	{
+		vertices[i].v = (vertices[i].v - base) * tileWrapSize;
+	}
+	// NOTE: Assumes tiles are a power of two pixels high, like textures are
+	tileWrapMask = (int)(tileWrapSize * curTexHeight + 0.5f) - 1;
+	tileWrapY    = row * (tileWrapMask + 1);
+}
+
 static void ViewportVertex3D(Vertex* vertex) {
 	float invW = 1.0f / vertex->w;
 
@@ -508,7 +570,7 @@ static void DrawTriangle2D(Vertex* V0, Vertex* V1, Vertex* V2) {
 			int cb_index = y * cb_stride + x;
 
 			int R, G, B, A;
-			if (gfx_format == VERTEX_FORMAT_TEXTURED) {
+			if (gfx_format != VERTEX_FORMAT_COLOURED) {
 				float u = ic0 * u0 + ic1 * u1 + ic2 * u2;
 				float v = ic0 * v0 + ic1 * v1 + ic2 * v2;
 				int texX = ((int)u) & texWidthMask;
@@ -604,6 +666,12 @@ static void DrawTriangle3D(Vertex* V0, Vertex* V1, Vertex* V2) {
 
 	float u0 = V0->u * curTexWidth,  u1 = V1->u * curTexWidth,  u2 = V2->u * curTexWidth;
 	float v0 = V0->v * curTexHeight, v1 = V1->v * curTexHeight, v2 = V2->v * curTexHeight;
+	int texYBase = 0, texYMask = texHeightMask;
+
+	if (tileWrapY >= 0) {
+		texYBase = tileWrapY;
+		texYMask = tileWrapMask;
+	}
 	
 	// https://fgiesen.wordpress.com/2013/02/10/optimizing-the-basic-rasterizer/
 	// Essentially these are the deltas of edge functions between X/Y and X/Y + 1 (i.e. one X/Y step)
@@ -618,7 +686,7 @@ static void DrawTriangle3D(Vertex* V0, Vertex* V1, Vertex* V2) {
 	int R, G, B, A;
 	int a1, r1, g1, b1;
 	int a2, r2, g2, b2;
-	cc_bool texturing = gfx_format == VERTEX_FORMAT_TEXTURED;
+	cc_bool texturing = gfx_format != VERTEX_FORMAT_COLOURED;
 
 	if (!texturing) {
 		R = PackedCol_R(color);
@@ -662,7 +730,7 @@ static void DrawTriangle3D(Vertex* V0, Vertex* V1, Vertex* V2) {
 				float u = (ic0 * u0 + ic1 * u1 + ic2 * u2) * w;
 				float v = (ic0 * v0 + ic1 * v1 + ic2 * v2) * w;
 				int texX = ((int)u) & texWidthMask;
-				int texY = ((int)v) & texHeightMask;
+				int texY = (((int)v) & texYMask) + texYBase;
 
 				int texIndex = texY * curTexWidth + texX;
 				BitmapCol tColor = curTexPixels[texIndex];
@@ -992,6 +1060,9 @@ void DrawQuads(int startVertex, int verticesCount, DrawHints hints) {
 					|  TransformVertex3D(j + 2, &vertices[2]) << 2
 					|  TransformVertex3D(j + 3, &vertices[3]) << 3;
 
+			tileWrapY = -1;
+			if (tileWrapSize && vertices[0].v >= GFX_TILE_WRAP_SCALE) UnwrapTileQuad(vertices);
+
 			if (clip == 0) {
 				// Quad entirely clipped
 			} else if (clip == 0x0F) {
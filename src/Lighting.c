@@ -191,14 +191,16 @@ static cc_bool ClassicLighting_NeedsNeighour(BlockID block, int i, int minY, int
 	return false;
 }
 
-static void ClassicLighting_ResetNeighbour(int x, int y, int z, BlockID block, int cx, int cy, int cz, int minCy, int maxCy) {
+/* NOTE: Only the blocks between affectedMinY and affectedMaxY need to be redrawn */
+static void ClassicLighting_ResetNeighbour(int x, int y, int z, BlockID block, int cx, int cy, int cz, int minCy, int maxCy,
+											int affectedMinY, int affectedMaxY) {
 	int minY, maxY;
 
 	if (minCy == maxCy) {
 		minY = cy << CHUNK_SHIFT;
 
 		if (ClassicLighting_NeedsNeighour(block, World_Pack(x, y, z), minY, y, y)) {
-			MapRenderer_RefreshChunk(cx, cy, cz);
+			MapRenderer_RefreshChunkSlices(cx, cy, cz, affectedMinY, affectedMaxY);
 		}
 	} else {
 		for (cy = maxCy; cy >= minCy; cy--) {
@@ -207,18 +209,18 @@ static void ClassicLighting_ResetNeighbour(int x, int y, int z, BlockID block, i
 			if (maxY > World.MaxY) maxY = World.MaxY;
 
 			if (ClassicLighting_NeedsNeighour(block, World_Pack(x, maxY, z), minY, maxY, y)) {
-				MapRenderer_RefreshChunk(cx, cy, cz);
+				MapRenderer_RefreshChunkSlices(cx, cy, cz, affectedMinY, affectedMaxY);
 			}
 		}
 	}
 }
 
-static void ClassicLighting_ResetColumn(int cx, int cy, int cz, int minCy, int maxCy) {
+static void ClassicLighting_ResetColumn(int cx, int cy, int cz, int minCy, int maxCy, int affectedMinY, int affectedMaxY) {
 	if (minCy == maxCy) {
-		MapRenderer_RefreshChunk(cx, cy, cz);
+		MapRenderer_RefreshChunkSlices(cx, cy, cz, affectedMinY, affectedMaxY);
 	} else {
 		for (cy = maxCy; cy >= minCy; cy--) {
-			MapRenderer_RefreshChunk(cx, cy, cz);
+			MapRenderer_RefreshChunkSlices(cx, cy, cz, affectedMinY, affectedMaxY);
 		}
 	}
 }
@@ -232,26 +234,30 @@ static void ClassicLighting_RefreshAffected(int x, int y, int z, BlockID block,
 	int newCy = newHeight < 0 ? 0 : newHeight >> 4;
 	int oldCy = oldHeight < 0 ? 0 : oldHeight >> 4;
 	int minCy = min(oldCy, newCy), maxCy = max(oldCy, newCy);
-	ClassicLighting_ResetColumn(cx, cy, cz, minCy, maxCy);
+
+	/* Only faces of blocks next to the changed block, or next to blocks whose light changed, are affected */
+	int minY = min(y, min(oldHeight, newHeight)) - 1;
+	int maxY = max(y, max(oldHeight, newHeight)) + 1;
+	ClassicLighting_ResetColumn(cx, cy, cz, minCy, maxCy, minY, maxY);
 
 	if (bX == 0 && cx > 0) {
-		ClassicLighting_ResetNeighbour(x - 1, y, z, block, cx - 1, cy, cz, minCy, maxCy);
+		ClassicLighting_ResetNeighbour(x - 1, y, z, block, cx - 1, cy, cz, minCy, maxCy, minY, maxY);
 	}
 	if (bY == 0 && cy > 0 && ClassicLighting_Needs(block, World_GetBlock(x, y - 1, z))) {
-		MapRenderer_RefreshChunk(cx, cy - 1, cz);
+		MapRenderer_RefreshChunkSlices(cx, cy - 1, cz, minY, maxY);
 	}
 	if (bZ == 0 && cz > 0) {
-		ClassicLighting_ResetNeighbour(x, y, z - 1, block, cx, cy, cz - 1, minCy, maxCy);
+		ClassicLighting_ResetNeighbour(x, y, z - 1, block, cx, cy, cz - 1, minCy, maxCy, minY, maxY);
 	}
 
 	if (bX == 15 && cx < World.ChunksX - 1) {
-		ClassicLighting_ResetNeighbour(x + 1, y, z, block, cx + 1, cy, cz, minCy, maxCy);
+		ClassicLighting_ResetNeighbour(x + 1, y, z, block, cx + 1, cy, cz, minCy, maxCy, minY, maxY);
 	}
 	if (bY == 15 && cy < World.ChunksY - 1 && ClassicLighting_Needs(block, World_GetBlock(x, y + 1, z))) {
-		MapRenderer_RefreshChunk(cx, cy + 1, cz);
+		MapRenderer_RefreshChunkSlices(cx, cy + 1, cz, minY, maxY);
 	}
 	if (bZ == 15 && cz < World.ChunksZ - 1) {
-		ClassicLighting_ResetNeighbour(x, y, z + 1, block, cx, cy, cz + 1, minCy, maxCy);
+		ClassicLighting_ResetNeighbour(x, y, z + 1, block, cx, cy, cz + 1, minCy, maxCy, minY, maxY);
 	}
 }
 
@@ -269,6 +275,74 @@ void ClassicLighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, Block
 	ClassicLighting_RefreshAffected(x, y, z, newBlock, lightH + 1, newHeight);
 }
 
+/* Range of blocks changed in a column of the world */
+struct LightColumn { int x, z, minY, maxY; cc_bool used; };
+/* Changed blocks in any 16x16 area of columns map to different entries */
+#define LIGHT_COLUMNS 256
+#define LightColumn_Index(x, z) ((((z) & 0x0F) << 4) | ((x) & 0x0F))
+static struct LightColumn light_columns[LIGHT_COLUMNS];
+
+static void ClassicLighting_UpdateColumn(struct LightColumn* c) {
+	int hIndex = Lighting_Pack(c->x, c->z);
+	int lightH = classic_heightmap[hIndex];
+	int cx = c->x >> CHUNK_SHIFT, bX = c->x & CHUNK_MASK;
+	int cz = c->z >> CHUNK_SHIFT, bZ = c->z & CHUNK_MASK;
+	int newH, minY, maxY, cy;
+	c->used = false;
+
+	/* Since light wasn't checked to begin with, means column never had meshes for any of its chunks built. */
+	if (lightH == HEIGHT_UNCALCULATED) return;
+
+	/* Blocks above the changed blocks are unchanged, and blocks above the old light height */
+	/*  didn't block light, so light height can't be higher than either of those */
+	newH = ClassicLighting_CalcHeightAt(c->x, min(World.MaxY, max(c->maxY, lightH + 1)), c->z, hIndex);
+
+	/* Only faces of blocks next to the changed blocks, or next to blocks whose light changed, are affected */
+	minY = c->minY - 1;
+	maxY = c->maxY + 1;
+	if (newH != lightH) {
+		minY = min(minY, min(lightH, newH));
+		maxY = max(maxY, max(lightH, newH) + 2);
+	}
+	minY = max(minY, 0);
+	maxY = min(maxY, World.MaxY);
+
+	for (cy = minY >> CHUNK_SHIFT; cy <= maxY >> CHUNK_SHIFT; cy++) 
+	{
+		MapRenderer_RefreshChunkSlices(cx, cy, cz, minY, maxY);
+
+		if (bX == 0)         MapRenderer_RefreshChunkSlices(cx - 1, cy, cz, minY, maxY);
+		if (bX == CHUNK_MAX) MapRenderer_RefreshChunkSlices(cx + 1, cy, cz, minY, maxY);
+		if (bZ == 0)         MapRenderer_RefreshChunkSlices(cx, cy, cz - 1, minY, maxY);
+		if (bZ == CHUNK_MAX) MapRenderer_RefreshChunkSlices(cx, cy, cz + 1, minY, maxY);
+	}
+}
+
+void ClassicLighting_OnBlocksChanged(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count) {
+	struct LightColumn* c;
+	int i, x, y, z;
+
+	/* Group the changed blocks by column, so each column is only updated once */
+	for (i = 0; i < count; i++) 
+	{
+		x = coords[i].x; y = coords[i].y; z = coords[i].z;
+		c = &light_columns[LightColumn_Index(x, z)];
+
+		if (c->used && c->x == x && c->z == z) {
+			c->minY = min(c->minY, y); c->maxY = max(c->maxY, y); continue;
+		}
+		if (c->used) ClassicLighting_UpdateColumn(c);
+
+		c->x = x; c->minY = y; c->used = true;
+		c->z = z; c->maxY = y;
+	}
+
+	for (i = 0; i < LIGHT_COLUMNS; i++) 
+	{
+		if (light_columns[i].used) ClassicLighting_UpdateColumn(&light_columns[i]);
+	}
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Lighting heightmap----------------------------------------------------*
@@ -386,6 +460,14 @@ void ClassicLighting_LightHint(int startX, int startY, int startZ) {
 	}
 }
 
+void ClassicLighting_LightHints(const IVec3* starts, int count) {
+	int i;
+	for (i = 0; i < count; i++) 
+	{
+		ClassicLighting_LightHint(starts[i].x, starts[i].y, starts[i].z);
+	}
+}
+
 void ClassicLighting_FreeState(void) {
 	Mem_Free(classic_heightmap);
 	classic_heightmap = NULL;
@@ -405,6 +487,7 @@ static void ClassicLighting_SetActive(void) {
 	if (!Game_ClassicMode) smoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
 
 	Lighting.OnBlockChanged = ClassicLighting_OnBlockChanged;
+	Lighting.OnBlocksChanged = ClassicLighting_OnBlocksChanged;
 	Lighting.Refresh        = ClassicLighting_Refresh;
 	Lighting.IsLit          = ClassicLighting_IsLit;
 	Lighting.Color          = smoothLighting ? SmoothLighting_Color : ClassicLighting_Color;
@@ -420,6 +503,7 @@ static void ClassicLighting_SetActive(void) {
 	Lighting.FreeState  = ClassicLighting_FreeState;
 	Lighting.AllocState = ClassicLighting_AllocState;
 	Lighting.LightHint  = ClassicLighting_LightHint;
+	Lighting.LightHints = ClassicLighting_LightHints;
 }
 
 
@@ -464,11 +548,12 @@ static void OnInit(void) {
 	Event_Register_(&WorldEvents.LightingModeChanged, NULL, Lighting_HandleModeChanged);
 }
 static void OnReset(void)        { Lighting.FreeState(); }
+static void OnFree(void)         { Lighting.FreeState(); FancyLighting_OnFree(); }
 static void OnNewMapLoaded(void) { Lighting.AllocState(); }
 
 struct IGameComponent Lighting_Component = {
 	OnInit,  /* Init  */
-	OnReset, /* Free  */
+	OnFree,  /* Free  */
 	OnReset, /* Reset */
 	OnReset, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
@@ -1,6 +1,7 @@
 #ifndef CC_WORLDLIGHTING_H
 #define CC_WORLDLIGHTING_H
 #include "PackedCol.h"
+#include "Vectors.h"
 CC_BEGIN_HEADER
 
 /*
@@ -46,10 +47,17 @@ CC_VAR extern struct _Lighting {
 	/* Quickly calculates lighting for the blocks in the region */
 	/*  [x, y, z] to [x + 18, y + 18, z + 18] */
 	void (*LightHint)(int startX, int startY, int startZ);
+	/* Same as LightHint, but for the regions starting at each of the given coordinates */
+	/*  (lighting engines may calculate the lighting of those regions in parallel) */
+	void (*LightHints)(const IVec3* starts, int count);
 
 	/* Called when a block is changed to update internal lighting state. */
 	/* NOTE: Implementations ***MUST*** mark all chunks affected by this lighting change as needing to be refreshed. */
 	void (*OnBlockChanged)(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+	/* Called after all of the given blocks have been changed to update internal lighting state. */
+	/*  (e.g. light heights only need to be recalculated once for each column of changed blocks) */
+	/* NOTE: Implementations ***MUST*** mark all chunks affected by these lighting changes as needing to be refreshed. */
+	void (*OnBlocksChanged)(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count);
 	/* Invalidates/Resets lighting state for all of the blocks in the world */
 	/*  (e.g. because a block changed whether it is full bright or not) */
 	void (*Refresh)(void);
@@ -76,6 +84,11 @@ CC_VAR extern struct _Lighting {
 
 void FancyLighting_SetActive(void);
 void FancyLighting_OnInit(void);
+void FancyLighting_OnFree(void);
+/* Calculates the light cast by the blocks in every chunk of the world, both by spreading */
+/*  the light of all the blocks in a chunk at once and of each block one at a time. */
+/* Returns the number of cells with different light levels (or -1 when out of memory) */
+int FancyLighting_CheckBatched(int* litCells);
 
 /* Expose ClassicLighting functions for reuse in Fancy lighting */
 void ClassicLighting_Refresh(void);
@@ -83,9 +96,11 @@ void ClassicLighting_FreeState(void);
 void ClassicLighting_AllocState(void);
 int ClassicLighting_GetLightHeight(int x, int z);
 void ClassicLighting_LightHint(int startX, int startY, int startZ);
+void ClassicLighting_LightHints(const IVec3* starts, int count);
 cc_bool ClassicLighting_IsLit(int x, int y, int z);
 cc_bool ClassicLighting_IsLit_Fast(int x, int y, int z);
 void ClassicLighting_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
+void ClassicLighting_OnBlocksChanged(const IVec3* coords, const BlockID* oldBlocks, const BlockID* blocks, int count);
 
 CC_END_HEADER
 #endif
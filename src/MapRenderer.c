@@ -25,16 +25,21 @@ static IVec3 chunkPos;
 /* The number of non-empty Normal/Translucent ChunkPartInfos (across entire world) for each 1D atlas batch. */
 /* 1D atlas batches that do not have any ChunkPartInfos can be entirely skipped. */
 static int normPartsCount[ATLAS1D_MAX_ATLASES], tranPartsCount[ATLAS1D_MAX_ATLASES];
-/* Whether there are any visible Normal/Translucent ChunkPartInfos for each 1D atlas batch. */
-/* 1D atlas batches that do not have any visible ChunkPartInfos can be skipped. */
-static cc_bool hasNormParts[ATLAS1D_MAX_ATLASES], hasTranParts[ATLAS1D_MAX_ATLASES];
-/* Whether renderer should check if there are any visible Normal/Translucent ChunkPartInfos for each 1D atlas batch. */
-static cc_bool checkNormParts[ATLAS1D_MAX_ATLASES], checkTranParts[ATLAS1D_MAX_ATLASES];
+/* Visible chunks which have Normal/Translucent ChunkPartInfos for each 1D atlas batch, sorted by distance. */
+/* Chunks for a batch are from drawList[starts[batch]] up to (but not including) drawList[starts[batch + 1]] */
+static struct ChunkInfo** drawList;
+static int drawListCapacity;
+static int normListStarts[ATLAS1D_MAX_ATLASES + 1], tranListStarts[ATLAS1D_MAX_ATLASES + 1];
+/* Whether the draw lists need to be rebuilt (e.g. because the visible chunks changed) */
+static cc_bool drawListsDirty;
 
 /* Render info for all chunks in the world. Unsorted. */
 static struct ChunkInfo* mapChunks;
-/* Pointers to render info for all chunks in the world, sorted by distance from the camera. */
+/* Pointers to render info for chunks in the world, sorted by distance from the camera. */
+/* NOTE: Chunks too far away to be built or rendered may not be included in this. */
 static struct ChunkInfo** sortedChunks;
+/* Number of actually used pointers in the sortedChunks array. */
+static int sortedChunksCount;
 /* Pointers to render info for all chunks in the world, sorted by distance from the camera. */
 /* Only chunks that can be rendered (i.e. not empty and are visible) are included in this.  */
 static struct ChunkInfo** renderChunks;
@@ -42,36 +47,139 @@ static struct ChunkInfo** renderChunks;
 static int renderChunksCount;
 /* Distance of each chunk from the camera. */
 static cc_uint32* distances;
+#define MAX_CHUNK_UPDATES 1024
 /* Maximum number of chunk updates that can be performed in one frame. */
 static int maxChunkUpdates;
 /* Cached number of chunks in the world */
 static int chunksCount;
+/* Chunks are grouped into regions of 4x4x4 chunks for frustum culling, so that */
+/*  whole regions outside the frustum can be rejected with only one test */
+#define REGION_SHIFT 2
+#define REGION_SIZE (1 << REGION_SHIFT)
+/* Region hasn't been tested against the current frustum yet */
+#define REGION_UNTESTED 0xFF
+/* Result of testing each region against the frustum (see FrustumBoxResult) */
+static cc_uint8* regionStates;
+static int regionsX, regionsY, regionsZ, regionsCount;
+
+/* Chunks which have meshes, so may need to be unloaded when far away. Unsorted. */
+/* NOTE: May include chunks that have since been deleted (see ChunkInfo.loaded) */
+static struct ChunkInfo** loadedChunks;
+static int loadedChunksCount;
+
+/* Chunks which are waiting to have their meshes built. Unsorted. */
+/* NOTE: May include chunks that have since been built (see ChunkInfo.pending) */
+static struct ChunkInfo** dirtyChunks;
+static int dirtyChunksCount;
+
+/* Offset (in chunks) of a chunk from the chunk the camera is in */
+struct ChunkOffset { cc_int16 x, y, z; };
+/* Offsets of all chunks within view distance of the camera's chunk, sorted by distance */
+/* NOTE: NULL when using this isn't faster than sorting all the chunks in the world */
+static struct ChunkOffset* shellOffsets;
+static cc_uint32* shellDistances;
+static int shellCount;
+/* Whether shellOffsets needs to be recalculated (e.g. view distance changed) */
+static cc_bool shellDirty = true;
+
+static void FreeShell(void) {
+	Mem_Free(shellOffsets);
+	Mem_Free(shellDistances);
+	shellOffsets   = NULL;
+	shellDistances = NULL;
+	shellCount     = 0;
+	shellDirty     = true;
+}
+
+/* Chunk waiting to be built, along with how urgently it needs to be built */
+struct BuildEntry {
+	cc_uint32 priority;
+	struct ChunkInfo* info;
+};
+/* Binary min-heap of the dirty chunks within build distance, with the most urgent chunk first */
+/* NOTE: May include chunks that no longer need to be built (these are skipped when popped) */
+static struct BuildEntry* buildHeap;
+static int buildHeapCount;
+/* Whether buildHeap needs to be recreated from dirtyChunks (e.g. camera moved to another chunk) */
+static cc_bool buildQueueStale = true;
+static void BuildQueue_Add(struct ChunkInfo* info);
+
+/* Chunk reached while flood filling outwards from the camera, for occlusion culling */
+struct VisEntry {
+	int index;
+	cc_uint8 entryFace; /* Face the chunk was entered through, or FACE_COUNT for camera chunk */
+	cc_uint8 travelled; /* Bit flags of the directions travelled from the camera to reach the chunk */
+};
+static struct VisEntry* visQueue;
+/* Whether chunk visibility needs to be recalculated, even if the camera hasn't moved */
+static cc_bool visGraphChanged;
+
+/* Marks the given chunk as needing to be rebuilt, and adds it to the list of chunks to build */
+static void ChunkInfo_MarkDirty(struct ChunkInfo* chunk) {
+	chunk->dirty = true;
+	if (!chunk->queued) BuildQueue_Add(chunk);
+	if (chunk->pending) return;
+
+	chunk->pending = true;
+	dirtyChunks[dirtyChunksCount++] = chunk;
+}
 
 static void ChunkInfo_Init(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->centreX = x + HALF_CHUNK_SIZE; chunk->centreY = y + HALF_CHUNK_SIZE; 
 	chunk->centreZ = z + HALF_CHUNK_SIZE;
 #ifndef CC_BUILD_GL11
-	chunk->vb = 0;
+	chunk->vb       = 0;
+	chunk->vbArena  = CHUNK_NO_ARENA;
+	chunk->vbOffset = 0;
+	chunk->vbCount  = 0;
 #endif
 
 	chunk->visible = true;  
 	chunk->empty   = false;
 	chunk->allAir  = false;
 	chunk->noData  = true;
-	chunk->dirty   = true;
+	chunk->pending = false;
+	chunk->loaded  = false;
+	chunk->occluded  = false;
+	chunk->dirtyMinY = 0;
+	chunk->dirtyMaxY = CHUNK_MAX;
+	chunk->visFlags  = CHUNK_VIS_ALL;
 
 	chunk->drawXMin = false; chunk->drawXMax = false; chunk->drawZMin = false;
 	chunk->drawZMax = false; chunk->drawYMin = false; chunk->drawYMax = false;
+	chunk->evicted     = false;
+	chunk->queued      = false;
+	chunk->lod         = 0;
+	chunk->meshBytes   = 0;
+	chunk->lastVisible = 0;
 
 	chunk->normalParts      = NULL;
 	chunk->translucentParts = NULL;
+	ChunkInfo_MarkDirty(chunk);
 }
 
 static CC_INLINE void ChunkInfo_Refresh(struct ChunkInfo* chunk) {
 	if (chunk->allAir) return; /* do not recreate chunks completely air */
 
 	chunk->empty = false;
-	chunk->dirty = true;
+	ChunkInfo_MarkDirty(chunk);
+	chunk->dirtyMinY = 0;
+	chunk->dirtyMaxY = CHUNK_MAX;
+}
+
+/* Marks the given range of y slices (relative to the chunk) as needing to be rebuilt */
+static void ChunkInfo_RefreshSlices(struct ChunkInfo* chunk, int minY, int maxY) {
+	if (chunk->allAir) return; /* do not recreate chunks completely air */
+
+	if (!chunk->dirty) {
+		chunk->dirtyMinY = minY;
+		chunk->dirtyMaxY = maxY;
+	} else {
+		chunk->dirtyMinY = min(chunk->dirtyMinY, minY);
+		chunk->dirtyMaxY = max(chunk->dirtyMaxY, maxY);
+	}
+	chunk->empty = false;
+	ChunkInfo_MarkDirty(chunk);
 }
 
 /* Index of maximum used 1D atlas + 1 */
@@ -106,61 +214,211 @@ static void CheckWeather(float delta) {
 	Gfx_SetAlphaBlending(false);
 }
 
+/* Whether chunk meshes are in the compact VERTEX_FORMAT_CHUNK layout for the current frame */
+static cc_bool chunkVertices;
+/* Whether chunk meshes contain greedy meshed faces that need tile wrapping for the current frame */
+static cc_bool tileWrap;
+#ifndef CC_BUILD_GL11
+/* Vertex buffer that was last bound, as many chunks may share the same vertex buffer */
+static GfxResourceID boundChunkVb;
+#endif
+
+static void BeginChunks(void) {
+#ifndef CC_BUILD_GL11
+	boundChunkVb  = 0;
+#endif
+	chunkVertices = Builder_UseChunkVertices();
+	Gfx_SetVertexFormat(chunkVertices ? VERTEX_FORMAT_CHUNK : VERTEX_FORMAT_TEXTURED);
+
+	tileWrap = Builder_UseTileWrap();
+	if (tileWrap) Gfx_EnableTileWrap(Atlas1D.InvTileSize);
+}
+
+#ifndef CC_BUILD_GL11
+/* Compact chunk vertices are relative to the chunk's origin, so need a per chunk view matrix */
+static void BindChunk(struct ChunkInfo* info) {
+	struct Matrix m;
+	if (info->vb != boundChunkVb) {
+		Gfx_BindVb_Textured(info->vb);
+		boundChunkVb = info->vb;
+	}
+	if (!chunkVertices) return;
+
+	m = Matrix_Identity;
+	m.row1.x = 1.0f / VERTEX_CHUNK_POS_SCALE;
+	m.row2.y = 1.0f / VERTEX_CHUNK_POS_SCALE;
+	m.row3.z = 1.0f / VERTEX_CHUNK_POS_SCALE;
+	m.row4.x = (float)(info->centreX - 8);
+	m.row4.y = (float)(info->centreY - 8);
+	m.row4.z = (float)(info->centreZ - 8);
+
+	Matrix_Mul(&m, &m, &Gfx.View);
+	Gfx_LoadMatrix(MATRIX_VIEW, &m);
+}
+#endif
+
+static void EndChunks(void) {
+	if (chunkVertices) Gfx_LoadMatrix(MATRIX_VIEW, &Gfx.View);
+	if (tileWrap)      Gfx_DisableTileWrap();
+}
+
+/* Counts how many visible chunks are in each draw list, or adds the visible chunks to the draw lists */
+/* NOTE: Adding advances the start of each list to the start of the next list */
+static void FillDrawLists(const int* batches, int batchesCount, cc_bool add) {
+	struct ChunkInfo* info;
+	int i, j, batch;
+
+	for (i = 0; i < renderChunksCount; i++) 
+	{
+		info = renderChunks[i];
+
+		for (j = 0; j < batchesCount; j++) 
+		{
+			batch = batches[j];
+			if (info->normalParts && info->normalParts[chunksCount * batch].offset >= 0) {
+				if (add) { drawList[normListStarts[batch]++] = info; } else { normListStarts[batch + 1]++; }
+			}
+			if (info->translucentParts && info->translucentParts[chunksCount * batch].offset >= 0) {
+				if (add) { drawList[tranListStarts[batch]++] = info; } else { tranListStarts[batch + 1]++; }
+			}
+		}
+	}
+}
+
+/* Rebuilds the lists of visible chunks for each 1D atlas batch */
+/* NOTE: Only 1D atlas batches that any chunks have parts in are checked */
+static void BuildDrawLists(void) {
+	int batches[ATLAS1D_MAX_ATLASES];
+	int batch, batchesCount = 0, total = 0;
+	int usedCount = MapRenderer_1DUsedCount;
+	drawListsDirty = false;
+
+	for (batch = 0; batch < usedCount; batch++) 
+	{
+		if (normPartsCount[batch] > 0 || tranPartsCount[batch] > 0) batches[batchesCount++] = batch;
+	}
+
+	Mem_Set(normListStarts, 0, sizeof(normListStarts));
+	Mem_Set(tranListStarts, 0, sizeof(tranListStarts));
+	/* All lists are empty when no chunks have any parts */
+	if (!batchesCount) return;
+	FillDrawLists(batches, batchesCount, false);
+
+	/* Translucent lists are stored after all the normal lists */
+	for (batch = 0; batch <= usedCount; batch++) 
+	{
+		total += normListStarts[batch];
+		normListStarts[batch] = total;
+	}
+	for (batch = 0; batch <= usedCount; batch++) 
+	{
+		total += tranListStarts[batch];
+		tranListStarts[batch] = total;
+	}
+
+	if (total > drawListCapacity) {
+		drawListCapacity = total + 256;
+		drawList = (struct ChunkInfo**)Mem_Realloc(drawList, drawListCapacity, 
+											sizeof(struct ChunkInfo*), "chunk draw lists");
+	}
+	FillDrawLists(batches, batchesCount, true);
+
+	/* Undo the advancing of list starts from adding chunks */
+	for (batch = usedCount; batch > 0; batch--) 
+	{
+		normListStarts[batch] = normListStarts[batch - 1];
+		tranListStarts[batch] = tranListStarts[batch - 1];
+	}
+	tranListStarts[0] = normListStarts[usedCount];
+	normListStarts[0] = 0;
+}
+
+static void InvalidateDrawLists(void) { drawListsDirty = true; }
+
+/* Draws the given faces of a chunk part, merging faces next to each other in the vertex buffer into one draw call */
+/* NOTE: If cullPairs is true, face culling is used for pairs of opposite faces that are both drawn */
+static void DrawPartFaces(struct ChunkPartInfo* part, int faces, cc_bool cullPairs) {
+	int face, count, cull = 0;
+#ifndef CC_BUILD_GL11
+	int offset = part->offset + part->spriteCount;
+	int runOffset = offset, runCount = 0;
+	cc_bool runCull = false;
+#endif
+
+	for (face = 0; face < FACE_COUNT; face++) 
+	{
+		if (!part->counts[face]) faces &= ~(1 << face);
+	}
+	/* e.g. both XMin and XMax faces drawn when camera is inside chunk's X range */
+	if (cullPairs) {
+		for (face = 0; face < FACE_COUNT; face += 2) 
+		{
+			if (((faces >> face) & 3) == 3) cull |= 3 << face;
+		}
+	}
+
+	for (face = 0; face < FACE_COUNT; face++) 
+	{
+		count = part->counts[face];
 #ifdef CC_BUILD_GL11
-#define DrawFace(face, ign)    Gfx_BindVb(part.vbs[face]); Gfx_DrawIndexedTris_T2fC4b(0, 0);
-#define DrawFaces(f1, f2, ign) DrawFace(f1, ign); DrawFace(f2, ign);
+		if (!(faces & (1 << face))) continue;
+		if (cull & (1 << face)) Gfx_SetFaceCulling(true);
+		Gfx_BindVb(part->vbs[face]); 
+		Gfx_DrawIndexedTris_T2fC4b(0, 0);
+		if (cull & (1 << face)) Gfx_SetFaceCulling(false);
+		Game_Vertices += count;
 #else
-#define DrawFace(face, offset)    Gfx_DrawIndexedTris_T2fC4b(part.counts[face], offset);
-#define DrawFaces(f1, f2, offset) Gfx_DrawIndexedTris_T2fC4b(part.counts[f1] + part.counts[f2], offset);
+		if (faces & (1 << face)) {
+			runCount += count;
+			runCull  |= (cull >> face) & 1;
+		} else if (count) {
+			/* Face isn't drawn, so draw the faces before it */
+			if (runCount) {
+				if (runCull) Gfx_SetFaceCulling(true);
+				Gfx_DrawIndexedTris_T2fC4b(runCount, runOffset);
+				if (runCull) Gfx_SetFaceCulling(false);
+				Game_Vertices += runCount;
+			}
+			runOffset = offset + count;
+			runCount  = 0;
+			runCull   = false;
+		}
+		offset += count;
 #endif
+	}
 
-#define DrawNormalFaces(minFace, maxFace) \
-if (drawMin && drawMax) { \
-	Gfx_SetFaceCulling(true); \
-	DrawFaces(minFace, maxFace, offset); \
-	Gfx_SetFaceCulling(false); \
-	Game_Vertices += (part.counts[minFace] + part.counts[maxFace]); \
-} else if (drawMin) { \
-	DrawFace(minFace, offset); \
-	Game_Vertices += part.counts[minFace]; \
-} else if (drawMax) { \
-	DrawFace(maxFace, offset + part.counts[minFace]); \
-	Game_Vertices += part.counts[maxFace]; \
+#ifndef CC_BUILD_GL11
+	if (!runCount) return;
+	if (runCull) Gfx_SetFaceCulling(true);
+	Gfx_DrawIndexedTris_T2fC4b(runCount, runOffset);
+	if (runCull) Gfx_SetFaceCulling(false);
+	Game_Vertices += runCount;
+#endif
 }
 
+#define ChunkFacesMask(info) \
+	((info->drawXMin << FACE_XMIN) | (info->drawXMax << FACE_XMAX) | \
+	 (info->drawZMin << FACE_ZMIN) | (info->drawZMax << FACE_ZMAX) | \
+	 (info->drawYMin << FACE_YMIN) | (info->drawYMax << FACE_YMAX))
+
 static void RenderNormalBatch(int batch) {
 	int batchOffset = chunksCount * batch;
 	struct ChunkInfo* info;
 	struct ChunkPartInfo part;
-	cc_bool drawMin, drawMax;
 	int i, offset, count;
 
-	for (i = 0; i < renderChunksCount; i++) {
-		info = renderChunks[i];
+	for (i = normListStarts[batch]; i < normListStarts[batch + 1]; i++) {
+		info = drawList[i];
 		if (!info->normalParts) continue;
 
 		part = info->normalParts[batchOffset];
 		if (part.offset < 0) continue;
-		hasNormParts[batch] = true;
 
 #ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->vb);
+		BindChunk(info);
+		part.offset += info->vbOffset;
 #endif
-
-		offset  = part.offset + part.spriteCount;
-		drawMin = info->drawXMin && part.counts[FACE_XMIN];
-		drawMax = info->drawXMax && part.counts[FACE_XMAX];
-		DrawNormalFaces(FACE_XMIN, FACE_XMAX);
-
-		offset  += part.counts[FACE_XMIN] + part.counts[FACE_XMAX];
-		drawMin = info->drawZMin && part.counts[FACE_ZMIN];
-		drawMax = info->drawZMax && part.counts[FACE_ZMAX];
-		DrawNormalFaces(FACE_ZMIN, FACE_ZMAX);
-
-		offset  += part.counts[FACE_ZMIN] + part.counts[FACE_ZMAX];
-		drawMin = info->drawYMin && part.counts[FACE_YMIN];
-		drawMax = info->drawYMax && part.counts[FACE_YMAX];
-		DrawNormalFaces(FACE_YMIN, FACE_YMAX);
+		DrawPartFaces(&part, ChunkFacesMask(info), true);
 
 		if (!part.spriteCount) continue;
 		offset = part.offset;
@@ -198,93 +456,63 @@ void MapRenderer_RenderNormal(float delta) {
 	int batch;
 	if (!mapChunks) return;
 
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	if (drawListsDirty) BuildDrawLists();
+
+	BeginChunks();
 	Gfx_SetAlphaTest(true);
 	
 	Gfx_EnableMipmaps();
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) 
 	{
-		if (normPartsCount[batch] <= 0) continue;
-		if (hasNormParts[batch] || checkNormParts[batch]) {
-			Atlas1D_Bind(batch);
-			RenderNormalBatch(batch);
-			checkNormParts[batch] = false;
-		}
+		if (normListStarts[batch] == normListStarts[batch + 1]) continue;
+
+		Atlas1D_Bind(batch);
+		RenderNormalBatch(batch);
 	}
 	Gfx_DisableMipmaps();
+	EndChunks();
 
 	CheckWeather(delta);
 	Gfx_SetAlphaTest(false);
-#if DEBUG_OCCLUSION
-	DebugPickedPos();
-#endif
-}
-
-#define DrawTranslucentFaces(minFace, maxFace) \
-if (drawMin && drawMax) { \
-	DrawFaces(minFace, maxFace, offset); \
-	Game_Vertices += (part.counts[minFace] + part.counts[maxFace]); \
-} else if (drawMin) { \
-	DrawFace(minFace, offset); \
-	Game_Vertices += part.counts[minFace]; \
-} else if (drawMax) { \
-	DrawFace(maxFace, offset + part.counts[minFace]); \
-	Game_Vertices += part.counts[maxFace]; \
 }
 
 static void RenderTranslucentBatch(int batch) {
 	int batchOffset = chunksCount * batch;
 	struct ChunkInfo* info;
 	struct ChunkPartInfo part;
-	cc_bool drawMin, drawMax;
-	int i, offset;
+	int i, faces;
 
-	for (i = 0; i < renderChunksCount; i++) {
-		info = renderChunks[i];
+	for (i = tranListStarts[batch]; i < tranListStarts[batch + 1]; i++) {
+		info = drawList[i];
 		if (!info->translucentParts) continue;
 
 		part = info->translucentParts[batchOffset];
 		if (part.offset < 0) continue;
-		hasTranParts[batch] = true;
 
 #ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->vb);
+		BindChunk(info);
+		part.offset += info->vbOffset;
 #endif
-
-		offset  = part.offset;
-		drawMin = (inTranslucent || info->drawXMin) && part.counts[FACE_XMIN];
-		drawMax = (inTranslucent || info->drawXMax) && part.counts[FACE_XMAX];
-		DrawTranslucentFaces(FACE_XMIN, FACE_XMAX);
-
-		offset  += part.counts[FACE_XMIN] + part.counts[FACE_XMAX];
-		drawMin = (inTranslucent || info->drawZMin) && part.counts[FACE_ZMIN];
-		drawMax = (inTranslucent || info->drawZMax) && part.counts[FACE_ZMAX];
-		DrawTranslucentFaces(FACE_ZMIN, FACE_ZMAX);
-
-		offset  += part.counts[FACE_ZMIN] + part.counts[FACE_ZMAX];
-		drawMin = (inTranslucent || info->drawYMin) && part.counts[FACE_YMIN];
-		drawMax = (inTranslucent || info->drawYMax) && part.counts[FACE_YMAX];
-		DrawTranslucentFaces(FACE_YMIN, FACE_YMAX);
+		faces = inTranslucent ? (1 << FACE_COUNT) - 1 : ChunkFacesMask(info);
+		DrawPartFaces(&part, faces, false);
 	}
 }
 
 void MapRenderer_RenderTranslucent(float delta) {
 	int vertices, batch;
 	if (!mapChunks) return;
+	if (drawListsDirty) BuildDrawLists();
 
 	/* First fill depth buffer */
 	vertices = Game_Vertices;
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	BeginChunks();
 	Gfx_SetAlphaBlending(false);
 	Gfx_DepthOnlyRendering(true);
 
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) 
 	{
-		if (tranPartsCount[batch] <= 0) continue;
-		if (hasTranParts[batch] || checkTranParts[batch]) {
-			RenderTranslucentBatch(batch);
-			checkTranParts[batch] = false;
-		}
+		if (tranListStarts[batch] == tranListStarts[batch + 1]) continue;
+		RenderTranslucentBatch(batch);
 	}
 	Game_Vertices = vertices;
 
@@ -296,13 +524,13 @@ void MapRenderer_RenderTranslucent(float delta) {
 	Gfx_EnableMipmaps();
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) 
 	{
-		if (tranPartsCount[batch] <= 0) continue;
-		if (!hasTranParts[batch]) continue;
+		if (tranListStarts[batch] == tranListStarts[batch + 1]) continue;
 
 		Atlas1D_Bind(batch);
 		RenderTranslucentBatch(batch);
 	}
 	Gfx_DisableMipmaps();
+	EndChunks();
 
 	Gfx_SetDepthWrite(true);
 	/* If we weren't under water, render weather after to blend properly */
@@ -315,6 +543,237 @@ void MapRenderer_RenderTranslucent(float delta) {
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Chunk mesh arenas----------------------------------------------------*
+*#########################################################################################################################*/
+#ifndef CC_BUILD_GL11
+/* Chunk meshes are sub-allocated from a few large vertex buffers shared by many chunks, */
+/*  which avoids creating/deleting a vertex buffer every time a chunk is rebuilt */
+#define ARENA_VERTICES (256 * 1024)
+#define MAX_ARENAS 32
+/* Maximum number of separate free ranges of vertices an arena can track */
+#define MAX_ARENA_RANGES 256
+/* Arena is considered too fragmented when it has this many separate free ranges */
+#define ARENA_FRAGMENTED_RANGES 64
+/* Vertices are allocated in multiples of this, to avoid lots of tiny free ranges */
+#define ARENA_GRANULARITY 64
+/* Chunks with more vertices than this are given their own vertex buffer instead */
+#define ARENA_MAX_MESH (ARENA_VERTICES / 8)
+
+struct ArenaRange { int offset, count; };
+struct MeshArena {
+	GfxResourceID vb;
+	VertexFormat fmt;
+	int used;         /* Number of vertices currently allocated to chunks */
+	cc_bool draining; /* Whether chunks in this arena are being rebuilt into other arenas */
+	int rangesCount;  /* Number of free ranges of vertices, sorted by offset */
+	struct ArenaRange ranges[MAX_ARENA_RANGES];
+};
+static struct MeshArena* arenas[MAX_ARENAS];
+
+static struct MeshArena* CreateArena(VertexFormat fmt) {
+	struct MeshArena* arena = (struct MeshArena*)Mem_TryAlloc(1, sizeof(struct MeshArena));
+	if (!arena) return NULL;
+
+	arena->vb = Gfx_CreateRangedVb(fmt, ARENA_VERTICES);
+	if (!arena->vb) { Mem_Free(arena); return NULL; }
+
+	arena->fmt      = fmt;
+	arena->used     = 0;
+	arena->draining = false;
+	arena->rangesCount      = 1;
+	arena->ranges[0].offset = 0;
+	arena->ranges[0].count  = ARENA_VERTICES;
+	return arena;
+}
+
+static void FreeArena(int i) {
+	Gfx_DeleteVb(&arenas[i]->vb);
+	Mem_Free(arenas[i]);
+	arenas[i] = NULL;
+}
+
+static void Arena_RemoveRange(struct MeshArena* arena, int i) {
+	arena->rangesCount--;
+	Mem_Move(&arena->ranges[i], &arena->ranges[i + 1], (arena->rangesCount - i) * sizeof(struct ArenaRange));
+}
+
+/* Returns offset of the first free range of vertices that is large enough, or -1 if none are */
+static int Arena_Alloc(struct MeshArena* arena, int count) {
+	struct ArenaRange* range;
+	int i, offset;
+
+	for (i = 0; i < arena->rangesCount; i++) 
+	{
+		range = &arena->ranges[i];
+		if (range->count < count) continue;
+
+		offset         = range->offset;
+		range->offset += count;
+		range->count  -= count;
+
+		if (!range->count) Arena_RemoveRange(arena, i);
+		arena->used += count;
+		return offset;
+	}
+	return -1;
+}
+
+/* Returns false if the free range couldn't be tracked (i.e. too many free ranges) */
+static cc_bool Arena_Free(struct MeshArena* arena, int offset, int count) {
+	struct ArenaRange* ranges = arena->ranges;
+	cc_bool mergePrev, mergeNext;
+	int i;
+	arena->used -= count;
+
+	/* Find the first free range after the freed range */
+	for (i = 0; i < arena->rangesCount && ranges[i].offset < offset; i++) { }
+	mergePrev = i > 0 && ranges[i - 1].offset + ranges[i - 1].count == offset;
+	mergeNext = i < arena->rangesCount && offset + count == ranges[i].offset;
+
+	if (mergePrev && mergeNext) {
+		ranges[i - 1].count += count + ranges[i].count;
+		Arena_RemoveRange(arena, i);
+	} else if (mergePrev) {
+		ranges[i - 1].count += count;
+	} else if (mergeNext) {
+		ranges[i].offset = offset;
+		ranges[i].count += count;
+	} else {
+		if (arena->rangesCount == MAX_ARENA_RANGES) return false;
+
+		Mem_Move(&ranges[i + 1], &ranges[i], (arena->rangesCount - i) * sizeof(struct ArenaRange));
+		ranges[i].offset = offset;
+		ranges[i].count  = count;
+		arena->rangesCount++;
+	}
+	return true;
+}
+
+static cc_bool AnyArenaDraining(void) {
+	int i;
+	for (i = 0; i < MAX_ARENAS; i++) 
+	{
+		if (arenas[i] && arenas[i]->draining) return true;
+	}
+	return false;
+}
+
+/* Stops draining the given arena when none of the chunks still in it are queued to be rebuilt */
+/*  (e.g. they are all beyond build distance), as otherwise the arena would stay draining */
+/*  forever and so prevent any other arenas from being compacted */
+static void CheckArenaDraining(int index) {
+	int i;
+	for (i = 0; i < chunksCount; i++) 
+	{
+		if (mapChunks[i].vbArena == index && mapChunks[i].queued) return;
+	}
+	arenas[index]->draining = false;
+}
+
+static void CheckArenasDraining(void) {
+	int i;
+	for (i = 0; i < MAX_ARENAS; i++) 
+	{
+		if (arenas[i] && arenas[i]->draining) CheckArenaDraining(i);
+	}
+}
+
+/* Compacts a fragmented arena by rebuilding the meshes of all chunks in it, */
+/*  which are then allocated compactly from other arenas instead */
+/* NOTE: The arena is freed once all the chunks in it have been rebuilt */
+static void DrainArena(int index) {
+	int i;
+	arenas[index]->draining = true;
+
+	for (i = 0; i < chunksCount; i++) 
+	{
+		if (mapChunks[i].vbArena == index) ChunkInfo_Refresh(&mapChunks[i]);
+	}
+	/* Otherwise checked once the build queue has been recreated */
+	if (!buildQueueStale) CheckArenaDraining(index);
+}
+
+static VertexFormat ChunkVertexFormat(void) {
+	return Builder_UseChunkVertices() ? VERTEX_FORMAT_CHUNK : VERTEX_FORMAT_TEXTURED;
+}
+
+/* Attempts to allocate the vertices for the given chunk from one of the arenas */
+static cc_bool AllocFromArenas(struct ChunkInfo* info, VertexFormat fmt, int count) {
+	struct MeshArena* arena;
+	int i, offset, freeSlot = -1;
+	count = (count + (ARENA_GRANULARITY - 1)) & ~(ARENA_GRANULARITY - 1);
+
+	for (i = 0; i < MAX_ARENAS; i++) 
+	{
+		arena = arenas[i];
+		if (!arena) { if (freeSlot < 0) freeSlot = i; continue; }
+		if (arena->fmt != fmt || arena->draining) continue;
+
+		if ((offset = Arena_Alloc(arena, count)) >= 0) break;
+	}
+
+	if (i == MAX_ARENAS) {
+		if (freeSlot < 0 || !(arena = CreateArena(fmt))) return false;
+
+		i = freeSlot;
+		arenas[i] = arena;
+		offset    = Arena_Alloc(arena, count);
+	}
+
+	info->vb       = arena->vb;
+	info->vbArena  = i;
+	info->vbOffset = offset;
+	info->vbCount  = count;
+	return true;
+}
+
+void* MapRenderer_LockChunkVb(struct ChunkInfo* info, int count) {
+	VertexFormat fmt = ChunkVertexFormat();
+
+	if (Gfx.SupportsRangedVbs && count <= ARENA_MAX_MESH && AllocFromArenas(info, fmt, count)) {
+		return Gfx_LockVbRange(info->vb, fmt, info->vbOffset, count);
+	}
+
+	info->vb       = Gfx_CreateVb(fmt, count);
+	info->vbArena  = CHUNK_NO_ARENA;
+	info->vbOffset = 0;
+	info->vbCount  = count;
+	return Gfx_LockVb(info->vb, fmt, count);
+}
+
+void MapRenderer_UnlockChunkVb(struct ChunkInfo* info) {
+	if (info->vbArena == CHUNK_NO_ARENA) {
+		Gfx_UnlockVb(info->vb);
+	} else {
+		Gfx_UnlockVbRange(info->vb);
+	}
+}
+
+static void FreeChunkVb(struct ChunkInfo* info) {
+	struct MeshArena* arena;
+	int index = info->vbArena;
+	cc_bool tracked;
+
+	if (index == CHUNK_NO_ARENA) { Gfx_DeleteVb(&info->vb); return; }
+	arena   = arenas[index];
+	tracked = Arena_Free(arena, info->vbOffset, info->vbCount);
+
+	info->vb       = 0;
+	info->vbArena  = CHUNK_NO_ARENA;
+	info->vbOffset = 0;
+	info->vbCount  = 0;
+
+	if (!arena->used) {
+		FreeArena(index);
+	} else if (!arena->draining && (!tracked || (arena->rangesCount >= ARENA_FRAGMENTED_RANGES 
+			&& arena->used < ARENA_VERTICES / 2 && !AnyArenaDraining()))) {
+		DrainArena(index);
+	}
+}
+#endif
+
+
 /*########################################################################################################################*
 *---------------------------------------------------Chunk functionality---------------------------------------------------*
 *#########################################################################################################################*/
@@ -325,18 +784,15 @@ static void DeleteChunk(struct ChunkInfo* info) {
 #ifdef CC_BUILD_GL11
 	int j;
 #else
-	Gfx_DeleteVb(&info->vb);
+	FreeChunkVb(info);
 #endif
+	MapRenderer_MeshBytes -= info->meshBytes;
+	info->meshBytes = 0;
 
 	info->empty  = false; 
 	info->allAir = false;
 	info->noData = true;
-	info->dirty  = true;
-
-#ifdef OCCLUSION
-	info.OcclusionFlags = 0;
-	info.OccludedFlags = 0;
-#endif
+	ChunkInfo_MarkDirty(info);
 
 	if (info->normalParts) {
 		ptr = info->normalParts;
@@ -363,19 +819,84 @@ static void DeleteChunk(struct ChunkInfo* info) {
 	}
 }
 
-/* Builds the mesh (hence vertex buffer) for the given chunk, and updates internal state */
-static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
-	struct ChunkPartInfo* ptr;
-	int i;
+/* Chunks which need to have their meshes built this frame */
+static struct ChunkInfo* buildQueue[MAX_CHUNK_UPDATES];
+static int buildQueueCount;
+
+int MapRenderer_LodDistance;
+
+/* Returns the level of detail the mesh of the given chunk should be built with */
+static int CalcChunkLod(struct ChunkInfo* info) {
+	int dx = info->centreX - chunkPos.x, dy = info->centreY - chunkPos.y, dz = info->centreZ - chunkPos.z;
+	int dist, lod = 0;
+	if (!MapRenderer_LodDistance) return 0;
 
+	dist = (int)Math_SqrtF((float)(dx * dx + dy * dy + dz * dz));
+	if (dist >= MapRenderer_LodDistance * 2) {
+		lod = 2;
+	} else if (dist >= MapRenderer_LodDistance) {
+		lod = 1;
+	}
+
+	/* Only switch back to more detail once a chunk is well inside the boundary, */
+	/*  so chunks on the boundary aren't rebuilt every time the camera moves back and forth */
+	if (lod < info->lod && dist + CHUNK_SIZE >= MapRenderer_LodDistance * info->lod) lod = info->lod;
+	return lod;
+}
+
+/* Queues the mesh (hence vertex buffer) for the given chunk to be built */
+static void QueueChunk(struct ChunkInfo* info, int* chunkUpdates) {
+	DeleteChunk(info);
+	info->lod = CalcChunkLod(info);
 	Game.ChunkUpdates++;
 	(*chunkUpdates)++;
-	Builder_MakeChunk(info);
+	buildQueue[buildQueueCount++] = info;
+}
+
+#ifdef CC_BUILD_GL11
+static cc_uint32 CountPartsVertices(struct ChunkPartInfo* ptr) {
+	cc_uint32 vertices = 0;
+	int i, face;
+	if (!ptr) return 0;
+
+	for (i = 0; i < MapRenderer_1DUsedCount; i++, ptr += chunksCount) {
+		if (ptr->offset < 0) continue;
+		vertices += ptr->spriteCount;
+		for (face = 0; face < FACE_COUNT; face++) vertices += ptr->counts[face];
+	}
+	return vertices;
+}
+#endif
+
+static cc_uint32 CalcMeshBytes(struct ChunkInfo* info) {
+#ifndef CC_BUILD_GL11
+	return info->vbCount * (Builder_UseChunkVertices() ? SIZEOF_VERTEX_CHUNK : SIZEOF_VERTEX_TEXTURED);
+#else
+	return (CountPartsVertices(info->normalParts) + CountPartsVertices(info->translucentParts)) * SIZEOF_VERTEX_TEXTURED;
+#endif
+}
+
+/* Updates internal state after the mesh for the given chunk has been built */
+static void OnChunkBuilt(struct ChunkInfo* info) {
+	struct ChunkPartInfo* ptr;
+	int i;
 
 	info->dirty  = false;
+	info->evicted   = false;
+	info->queued    = false;
+	visGraphChanged = true;
+	info->dirtyMinY = 0;
+	info->dirtyMaxY = CHUNK_MAX;
 	info->noData = !info->normalParts && !info->translucentParts;
 	info->empty  = info->noData;
 	if (info->empty) return;
+
+	if (!info->loaded) {
+		info->loaded = true;
+		loadedChunks[loadedChunksCount++] = info;
+	}
+	info->meshBytes = CalcMeshBytes(info);
+	MapRenderer_MeshBytes += info->meshBytes;
 	
 	if (info->normalParts) {
 		ptr = info->normalParts;
@@ -392,6 +913,19 @@ static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
 	}
 }
 
+/* Builds the meshes for all queued chunks */
+static void BuildQueuedChunks(void) {
+	int i;
+	if (!buildQueueCount) return;
+
+	Builder_MakeChunks(buildQueue, buildQueueCount);
+	for (i = 0; i < buildQueueCount; i++) 
+	{
+		OnChunkBuilt(buildQueue[i]);
+	}
+	buildQueueCount = 0;
+}
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Chunks mangagement---------------------------------------------------*
@@ -407,11 +941,33 @@ static void FreeChunks(void) {
 	Mem_Free(sortedChunks);
 	Mem_Free(renderChunks);
 	Mem_Free(distances);
+	Mem_Free(visQueue);
+	Mem_Free(dirtyChunks);
+	Mem_Free(buildHeap);
+	Mem_Free(loadedChunks);
+	Mem_Free(regionStates);
+	Mem_Free(drawList);
+	FreeShell();
 
 	mapChunks    = NULL;
 	sortedChunks = NULL;
 	renderChunks = NULL;
 	distances    = NULL;
+	visQueue     = NULL;
+	dirtyChunks  = NULL;
+	buildHeap    = NULL;
+	loadedChunks = NULL;
+	regionStates = NULL;
+	drawList     = NULL;
+
+	drawListCapacity  = 0;
+	renderChunksCount = 0;
+	drawListsDirty    = true;
+	dirtyChunksCount  = 0;
+	buildHeapCount    = 0;
+	buildQueueStale   = true;
+	loadedChunksCount = 0;
+	sortedChunksCount = 0;
 }
 
 static void AllocateParts(void) {
@@ -428,16 +984,17 @@ static void AllocateChunks(void) {
 	sortedChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	renderChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	distances    = (cc_uint32*)Mem_Alloc(chunksCount, 4, "chunk distances");
-}
-
-static void ResetPartFlags(void) {
-	int i;
-	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
-		checkNormParts[i] = true;
-		hasNormParts[i]   = false;
-		checkTranParts[i] = true;
-		hasTranParts[i]   = false;
-	}
+	visQueue     = (struct VisEntry*)Mem_Alloc(chunksCount, sizeof(struct VisEntry), "chunk visibility queue");
+	dirtyChunks  = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "dirty chunk info");
+	buildHeap    = (struct BuildEntry*)Mem_Alloc(chunksCount, sizeof(struct BuildEntry), "chunk build queue");
+	loadedChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "loaded chunk info");
+
+	regionsX = (World.ChunksX + (REGION_SIZE - 1)) >> REGION_SHIFT;
+	regionsY = (World.ChunksY + (REGION_SIZE - 1)) >> REGION_SHIFT;
+	regionsZ = (World.ChunksZ + (REGION_SIZE - 1)) >> REGION_SHIFT;
+	regionsCount = regionsX * regionsY * regionsZ;
+	regionStates = (cc_uint8*)Mem_Alloc(regionsCount, 1, "chunk region states");
+	Mem_Set(regionStates, REGION_UNTESTED, regionsCount);
 }
 
 static void ResetPartCounts(void) {
@@ -450,6 +1007,11 @@ static void ResetPartCounts(void) {
 
 static void InitChunks(void) {
 	int x, y, z, index = 0;
+	dirtyChunksCount  = 0;
+	buildHeapCount    = 0;
+	buildQueueStale   = true;
+	loadedChunksCount = 0;
+	sortedChunksCount = chunksCount;
 	for (z = 0; z < World.Length; z += CHUNK_SIZE) {
 		for (y = 0; y < World.Height; y += CHUNK_SIZE) {
 			for (x = 0; x < World.Width; x += CHUNK_SIZE) {
@@ -480,6 +1042,9 @@ static void DeleteChunks(void) {
 	for (i = 0; i < chunksCount; i++) 
 	{
 		DeleteChunk(&mapChunks[i]);
+		/* Chunks must be fully rebuilt, as any retained meshes may now be out of date */
+		mapChunks[i].dirtyMinY = 0;
+		mapChunks[i].dirtyMaxY = CHUNK_MAX;
 	}
 	ResetPartCounts();
 }
@@ -524,11 +1089,217 @@ static void RefreshBorderChunks(int maxHeight) {
 }
 
 
+/*########################################################################################################################*
+*-----------------------------------------------------Frustum culling-----------------------------------------------------*
+*#########################################################################################################################*/
+/* 14 ~ sqrt(3 * 8^2), i.e. radius of sphere that encloses a chunk */
+#define CHUNK_RADIUS 14
+
+static void ResetRegionStates(void) {
+	if (regionStates) Mem_Set(regionStates, REGION_UNTESTED, regionsCount);
+}
+
+/* Tests the box enclosing the bounding spheres of all chunks in the given region against the frustum */
+static int TestRegion(int rx, int ry, int rz) {
+	int maxCX = min((rx + 1) << REGION_SHIFT, World.ChunksX) - 1;
+	int maxCY = min((ry + 1) << REGION_SHIFT, World.ChunksY) - 1;
+	int maxCZ = min((rz + 1) << REGION_SHIFT, World.ChunksZ) - 1;
+	/* Centre of the first and last chunks in the region */
+	int minX = (rx << (REGION_SHIFT + CHUNK_SHIFT)) + HALF_CHUNK_SIZE, maxX = (maxCX << CHUNK_SHIFT) + HALF_CHUNK_SIZE;
+	int minY = (ry << (REGION_SHIFT + CHUNK_SHIFT)) + HALF_CHUNK_SIZE, maxY = (maxCY << CHUNK_SHIFT) + HALF_CHUNK_SIZE;
+	int minZ = (rz << (REGION_SHIFT + CHUNK_SHIFT)) + HALF_CHUNK_SIZE, maxZ = (maxCZ << CHUNK_SHIFT) + HALF_CHUNK_SIZE;
+
+	return FrustumCulling_BoxInFrustum(
+		(float)(minX - CHUNK_RADIUS), (float)(minY - CHUNK_RADIUS), (float)(minZ - CHUNK_RADIUS),
+		(float)(maxX + CHUNK_RADIUS), (float)(maxY + CHUNK_RADIUS), (float)(maxZ + CHUNK_RADIUS));
+}
+
+/* Returns whether the given chunk is inside the frustum, only testing the chunk itself */
+/*  when the region it is in is only partially inside the frustum */
+/* NOTE: Gives the same results as testing the chunk directly, since a region's box encloses */
+/*  the bounding spheres of all its chunks */
+static cc_bool ChunkInFrustum(struct ChunkInfo* info) {
+	int rx = info->centreX >> (CHUNK_SHIFT + REGION_SHIFT);
+	int ry = info->centreY >> (CHUNK_SHIFT + REGION_SHIFT);
+	int rz = info->centreZ >> (CHUNK_SHIFT + REGION_SHIFT);
+	int index = (ry * regionsZ + rz) * regionsX + rx;
+	int state = regionStates[index];
+
+	if (state == REGION_UNTESTED) {
+		state = TestRegion(rx, ry, rz);
+		regionStates[index] = state;
+	}
+
+	if (state == FRUSTUM_BOX_OUTSIDE) return false;
+	if (state == FRUSTUM_BOX_INSIDE)  return true;
+	return FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, CHUNK_RADIUS);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Occlusion culling-----------------------------------------------------*
+*#########################################################################################################################*/
+cc_bool MapRenderer_OcclusionCulling;
+int MapRenderer_OccludedChunks;
+
+static cc_bool CanSeeThrough(struct ChunkInfo* info, int entryFace, int exitFace) {
+	/* Chunk is not built yet, so can't know if the chunk will be see through */
+	if (info->dirty) return true;
+
+	if (entryFace == FACE_COUNT) return true;
+	if (entryFace == exitFace)   return false;
+
+	if (entryFace < exitFace) return (info->visFlags & CHUNK_VIS_BIT(entryFace, exitFace)) != 0;
+	return (info->visFlags & CHUNK_VIS_BIT(exitFace, entryFace)) != 0;
+}
+
+static void MarkAllVisible(void) {
+	int i;
+	for (i = 0; i < chunksCount; i++) { mapChunks[i].occluded = false; }
+}
+
+/* Flood fills outwards from the chunk the camera is in, only through faces of chunks that */
+/*  are connected by non-opaque blocks. Chunks which aren't reached can't be seen. */
+/* NOTE: Chunks are only travelled through in directions away from the camera */
+static void CalcOcclusion(int maxDistSqr) {
+	static const cc_int8 faceDirs[FACE_COUNT][3] = { 
+		{ -1,0,0 }, { 1,0,0 }, { 0,0,-1 }, { 0,0,1 }, { 0,-1,0 }, { 0,1,0 } 
+	};
+	struct ChunkInfo* info;
+	struct ChunkInfo* next;
+	struct VisEntry entry;
+	int i, face, head, tail;
+	int cx, cy, cz, dx, dy, dz;
+	IVec3 pos;
+
+	IVec3_Floor(&pos, &Camera.CurrentPos);
+	if (!World_Contains(pos.x, pos.y, pos.z)) { MarkAllVisible(); return; }
+
+	for (i = 0; i < chunksCount; i++) { mapChunks[i].occluded = true; }
+	cx = pos.x >> CHUNK_SHIFT; cy = pos.y >> CHUNK_SHIFT; cz = pos.z >> CHUNK_SHIFT;
+
+	entry.index     = World_ChunkPack(cx, cy, cz);
+	entry.entryFace = FACE_COUNT;
+	entry.travelled = 0;
+	mapChunks[entry.index].occluded = false;
+
+	visQueue[0] = entry;
+	head = 0; tail = 1;
+
+	while (head < tail) {
+		entry = visQueue[head++];
+		info  = &mapChunks[entry.index];
+
+		for (face = 0; face < FACE_COUNT; face++) 
+		{
+			/* Never travel back towards the camera */
+			if (entry.travelled & (1 << (face ^ 1))) continue;
+			if (!CanSeeThrough(info, entry.entryFace, face)) continue;
+
+			cx = (info->centreX >> CHUNK_SHIFT) + faceDirs[face][0];
+			cy = (info->centreY >> CHUNK_SHIFT) + faceDirs[face][1];
+			cz = (info->centreZ >> CHUNK_SHIFT) + faceDirs[face][2];
+			if (cx < 0 || cy < 0 || cz < 0 || cx >= World.ChunksX || cy >= World.ChunksY || cz >= World.ChunksZ) continue;
+
+			i    = World_ChunkPack(cx, cy, cz);
+			next = &mapChunks[i];
+			if (!next->occluded) continue;
+
+			dx = next->centreX - chunkPos.x; dy = next->centreY - chunkPos.y; dz = next->centreZ - chunkPos.z;
+			if (dx * dx + dy * dy + dz * dz > maxDistSqr) continue;
+			if (!ChunkInFrustum(next)) continue;
+
+			next->occluded = false;
+			visQueue[tail].index     = i;
+			visQueue[tail].entryFace = face ^ 1;
+			visQueue[tail].travelled = entry.travelled | (1 << face);
+			tail++;
+		}
+	}
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Mesh memory budget----------------------------------------------------*
+*#########################################################################################################################*/
+cc_uint32 MapRenderer_MeshBytes;
+cc_uint32 MapRenderer_MeshBudget;
+/* Incremented every time chunk visibility is recalculated (see ChunkInfo.lastVisible) */
+static cc_uint32 visibilityCounter;
+
+static struct ChunkInfo** evictChunks;
+static cc_uint32* evictKeys;
+
+static void SortEvictChunks(int left, int right) {
+	struct ChunkInfo** values = evictChunks; struct ChunkInfo* value;
+	cc_uint32* keys = evictKeys; cc_uint32 key;
+
+	while (left < right) {
+		int i = left, j = right;
+		cc_uint32 pivot = keys[(i + j) >> 1];
+
+		/* partition the list */
+		while (i <= j) {
+			while (pivot > keys[i]) i++;
+			while (pivot < keys[j]) j--;
+			QuickSort_Swap_KV_Maybe();
+		}
+		/* recurse into the smaller subset */
+		QuickSort_Recurse(SortEvictChunks)
+	}
+}
+
+/* Deletes the meshes of chunks that have gone the longest without being visible, */
+/*  until mesh memory usage is comfortably below the budget again */
+/* NOTE: Meshes of currently visible chunks are never deleted */
+static void EvictChunkMeshes(void) {
+	/* Evict a bit more than needed, to avoid evicting again after every chunk built */
+	cc_uint32 target = MapRenderer_MeshBudget - (MapRenderer_MeshBudget >> 3);
+	struct ChunkInfo* info;
+	int i, count = 0;
+
+	for (i = 0; i < loadedChunksCount; i++) 
+	{
+		info = loadedChunks[i];
+		if (!info->noData && info->lastVisible != visibilityCounter) count++;
+	}
+	/* Avoid allocating and sorting every frame when all meshes are visible */
+	if (!count) return;
+
+	evictChunks = (struct ChunkInfo**)Mem_TryAlloc(count, sizeof(struct ChunkInfo*));
+	evictKeys   = (cc_uint32*)Mem_TryAlloc(count, sizeof(cc_uint32));
+	count       = 0;
+
+	if (evictChunks && evictKeys) {
+		for (i = 0; i < loadedChunksCount; i++) 
+		{
+			info = loadedChunks[i];
+			if (info->noData || info->lastVisible == visibilityCounter) continue;
+
+			evictChunks[count] = info;
+			evictKeys[count]   = info->lastVisible;
+			count++;
+		}
+		SortEvictChunks(0, count - 1);
+
+		for (i = 0; i < count && MapRenderer_MeshBytes > target; i++) 
+		{
+			/* Set beforehand so DeleteChunk doesn't add chunk back into the build queue */
+			evictChunks[i]->evicted = true;
+			DeleteChunk(evictChunks[i]);
+		}
+	}
+
+	Mem_Free(evictChunks);
+	Mem_Free(evictKeys);
+	evictChunks = NULL;
+	evictKeys   = NULL;
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------Chunks updating/sorting------------------------------------------------*
 *#########################################################################################################################*/
-#define CHUNK_TARGET_TIME ((1.0f/30) + 0.01f)
-static int chunksTarget = 12;
 static Vec3 lastCamPos;
 static float lastYaw, lastPitch;
 /* Max distance from camera that chunks are rendered within */
@@ -547,67 +1318,222 @@ static int AdjustDist(int dist) {
 static void CalcViewDists(void) {
 	buildDistSquared  = AdjustDist(Game_UserViewDistance);
 	renderDistSquared = AdjustDist(Game_ViewDistance);
+	buildQueueStale   = true;
 }
 
-static int UpdateChunksAndVisibility(int* chunkUpdates) {
-	int renderDistSqr = renderDistSquared;
-	int buildDistSqr  = buildDistSquared;
+/* Max time (in microseconds) spent building chunk meshes each frame */
+static int buildTimeBudget;
+/* Estimated time (in microseconds) it takes to build the mesh of one chunk */
+static int avgChunkBuildTime = 1000;
+/* Max number of chunks built together in one batch */
+#define MAX_BUILD_BATCH 64
+
+static void BuildHeap_SiftDown(int i) {
+	struct BuildEntry* heap = buildHeap;
+	struct BuildEntry entry = heap[i];
+	int child;
+
+	for (;;) {
+		child = i * 2 + 1;
+		if (child >= buildHeapCount) break;
+		if (child + 1 < buildHeapCount && heap[child + 1].priority < heap[child].priority) child++;
+		if (entry.priority <= heap[child].priority) break;
+
+		heap[i] = heap[child]; i = child;
+	}
+	heap[i] = entry;
+}
+
+static void BuildHeap_SiftUp(int i) {
+	struct BuildEntry* heap = buildHeap;
+	struct BuildEntry entry = heap[i];
+	int parent;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (heap[parent].priority <= entry.priority) break;
+
+		heap[i] = heap[parent]; i = parent;
+	}
+	heap[i] = entry;
+}
+
+static struct ChunkInfo* BuildHeap_Pop(void) {
+	struct ChunkInfo* info = buildHeap[0].info;
+
+	buildHeap[0] = buildHeap[--buildHeapCount];
+	if (buildHeapCount) BuildHeap_SiftDown(0);
+	return info;
+}
+
+/* Calculates how urgently the given chunk needs to be built (lower is more urgent) */
+static cc_uint32 CalcBuildPriority(struct ChunkInfo* info, int dx, int dy, int dz, Vec3 dir) {
+	int distSqr = dx * dx + dy * dy + dz * dz;
+	float dist  = Math_SqrtF((float)distSqr);
+	float scale = 1.0f;
+
+	/* Chunks in front of the camera are built before chunks beside or behind the camera */
+	if (dist > 0.0f) scale = 2.0f - (dx * dir.x + dy * dir.y + dz * dir.z) / dist;
+
+	/* Chunks that can't be seen are built after chunks that can be seen */
+	if (!FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14)) scale *= 4.0f;
+	return (cc_uint32)(distSqr * scale);
+}
 
+static Vec3 BuildQueue_CameraDir(void) {
+	struct LocalPlayer* p = Entities.CurPlayer;
+	return Vec3_GetDirVector(p->Base.Yaw * MATH_DEG2RAD, p->Base.Pitch * MATH_DEG2RAD);
+}
+
+/* Whether the given dirty chunk should be built now */
+static cc_bool BuildQueue_Wanted(struct ChunkInfo* info, int dx, int dy, int dz) {
+	if (dx * dx + dy * dy + dz * dz > buildDistSquared) return false;
+	/* Rebuilding evicted chunks before they're needed would just cause them to be evicted again */
+	return !info->evicted || info->visible;
+}
+
+/* Adds a chunk that just became dirty to the priority queue, if it is within build distance */
+static void BuildQueue_Add(struct ChunkInfo* info) {
+	int dx, dy, dz;
+	/* Will be added anyways when the queue is recreated */
+	if (buildQueueStale) return;
+
+	dx = info->centreX - chunkPos.x; dy = info->centreY - chunkPos.y; dz = info->centreZ - chunkPos.z;
+	if (!BuildQueue_Wanted(info, dx, dy, dz)) return;
+
+	buildHeap[buildHeapCount].priority = CalcBuildPriority(info, dx, dy, dz, BuildQueue_CameraDir());
+	buildHeap[buildHeapCount].info     = info;
+	info->queued = true;
+	BuildHeap_SiftUp(buildHeapCount++);
+}
+
+/* Returns the most urgent chunk that still needs to be built, or NULL if there are none */
+static struct ChunkInfo* BuildQueue_Next(void) {
 	struct ChunkInfo* info;
-	int i, j = 0, distSqr;
+	int dx, dy, dz;
 
-	for (i = 0; i < chunksCount; i++) 
+	while (buildHeapCount) {
+		info = BuildHeap_Pop();
+		dx = info->centreX - chunkPos.x; dy = info->centreY - chunkPos.y; dz = info->centreZ - chunkPos.z;
+		if (info->dirty && BuildQueue_Wanted(info, dx, dy, dz)) return info;
+		info->queued = false;
+	}
+	return NULL;
+}
+
+/* Recreates the priority queue from the dirty chunks which are within build distance */
+/* NOTE: This checks every dirty chunk, so is only done when the camera moves to another chunk */
+static void UpdateBuildQueue(void) {
+	struct ChunkInfo* info;
+	int i, dx, dy, dz;
+	Vec3 dir = BuildQueue_CameraDir();
+
+	for (i = 0; i < buildHeapCount; i++) buildHeap[i].info->queued = false;
+	buildHeapCount  = 0;
+	buildQueueStale = false;
+
+	for (i = 0; i < dirtyChunksCount; ) 
 	{
-		info = sortedChunks[i];
-		if (info->empty) continue;
-		distSqr = distances[i];
-		
-		/* Auto unload chunks far away chunks */
-		if (!info->noData && distSqr >= buildDistSqr + 32 * 16) {
-			DeleteChunk(info); continue;
+		info = dirtyChunks[i];
+		/* Chunk has already been built, so remove it from the list */
+		if (!info->dirty) {
+			info->pending  = false;
+			dirtyChunks[i] = dirtyChunks[--dirtyChunksCount];
+			continue;
 		}
+		i++;
+
+		dx = info->centreX - chunkPos.x; dy = info->centreY - chunkPos.y; dz = info->centreZ - chunkPos.z;
+		if (!BuildQueue_Wanted(info, dx, dy, dz)) continue;
+
+		buildHeap[buildHeapCount].priority = CalcBuildPriority(info, dx, dy, dz, dir);
+		buildHeap[buildHeapCount].info     = info;
+		info->queued = true;
+		buildHeapCount++;
+	}
 
-		if (info->dirty && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(info);
-			BuildChunk(info, chunkUpdates);
+	for (i = buildHeapCount / 2 - 1; i >= 0; i--) BuildHeap_SiftDown(i);
+#ifndef CC_BUILD_GL11
+	CheckArenasDraining();
+#endif
+}
+
+/* Builds the most urgent dirty chunks, until the time budget for this frame is used up */
+/* Returns the number of chunks built */
+static int BuildDirtyChunks(void) {
+	cc_uint64 beg, batchBeg, end;
+	struct ChunkInfo* info;
+	int i, batch, elapsed = 0, chunkUpdates = 0;
+
+	if (!dirtyChunksCount) return 0;
+	if (buildQueueStale) UpdateBuildQueue();
+	beg = Stopwatch_Measure();
+
+	while (buildHeapCount && chunkUpdates < maxChunkUpdates) {
+		/* Build as many chunks together as are expected to fit in the remaining budget */
+		/*  (so that the chunks can be built in parallel by the builder worker threads) */
+		batch = (buildTimeBudget - elapsed) / avgChunkBuildTime;
+		batch = min(batch, MAX_BUILD_BATCH);
+		batch = min(batch, buildHeapCount);
+		batch = min(batch, maxChunkUpdates - chunkUpdates);
+		batch = max(batch, 1);
+
+		batchBeg = Stopwatch_Measure();
+		for (i = 0; i < batch; i++) 
+		{
+			if (!(info = BuildQueue_Next())) break;
+			QueueChunk(info, &chunkUpdates);
 		}
+		if (!(batch = i)) break;
+
+		BuildQueuedChunks();
+		end = Stopwatch_Measure();
 
-		info->visible = distSqr <= renderDistSqr &&
-			FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
-		if (info->visible && !info->empty) { renderChunks[j] = info; j++; }
+		/* Average over recent batches, so one slow chunk doesn't stall building */
+		i = (int)Stopwatch_ElapsedMicroseconds(batchBeg, end) / batch;
+		avgChunkBuildTime = max(1, (avgChunkBuildTime * 3 + i) / 4);
+
+		elapsed = (int)Stopwatch_ElapsedMicroseconds(beg, end);
+		if (elapsed >= buildTimeBudget) break;
 	}
-	return j;
+	return chunkUpdates;
 }
 
-static int UpdateChunksStill(int* chunkUpdates) {
+static int UpdateChunksAndVisibility(void) {
 	int renderDistSqr = renderDistSquared;
-	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
 	int i, j = 0, distSqr;
+	visibilityCounter++;
 
-	for (i = 0; i < chunksCount; i++) 
+	for (i = 0; i < sortedChunksCount; i++) 
 	{
 		info = sortedChunks[i];
 		if (info->empty) continue;
 		distSqr = distances[i];
 
-		/* Auto unload chunks far away chunks */
-		if (!info->noData && distSqr >= buildDistSqr + 32 * 16) {
-			DeleteChunk(info); continue;
-		}
+		info->visible = distSqr <= renderDistSqr && ChunkInFrustum(info);
+		if (info->visible && info->occluded) { info->visible = false; MapRenderer_OccludedChunks++; }
+		if (!info->visible) continue;
+		/* Evicted chunks are only rebuilt once they become visible again */
+		if (info->evicted && !info->queued) BuildQueue_Add(info);
 
-		if (info->dirty && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
-			DeleteChunk(info);
-			BuildChunk(info, chunkUpdates);
+		info->lastVisible = visibilityCounter;
+		renderChunks[j]   = info; j++;
+	}
+	return j;
+}
 
-			/* only need to update the visibility of chunks in range. */
-			info->visible = distSqr <= renderDistSqr &&
-				FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
-			if (info->visible && !info->empty) { renderChunks[j] = info; j++; }
-		} else if (info->visible) {
-			renderChunks[j] = info; j++;
-		}
+static int UpdateChunksStill(void) {
+	struct ChunkInfo* info;
+	int i, j = 0;
+
+	for (i = 0; i < sortedChunksCount; i++) 
+	{
+		info = sortedChunks[i];
+		if (info->empty) continue;
+
+		if (info->visible) { renderChunks[j] = info; j++; }
 	}
 	return j;
 }
@@ -615,25 +1541,38 @@ static int UpdateChunksStill(int* chunkUpdates) {
 static void UpdateChunks(float delta) {
 	struct LocalPlayer* p;
 	cc_bool samePos;
-	int chunkUpdates = 0;
+	int chunkUpdates;
 
-	/* Build more chunks if 30 FPS or over, otherwise slowdown */
-	chunksTarget += delta < CHUNK_TARGET_TIME ? 1 : -1; 
-	Math_Clamp(chunksTarget, 4, maxChunkUpdates);
+	/* Chunks are built first, so rebuilt chunks are never missing from the frame */
+	chunkUpdates = BuildDirtyChunks();
 
 	p = Entities.CurPlayer;
 	samePos = Vec3_Equals(&Camera.CurrentPos, &lastCamPos)
 		&& p->Base.Pitch == lastPitch && p->Base.Yaw == lastYaw;
+	/* Built chunks may have become visible, or turned out to be empty */
+	/* Camera moved, so regions need to be tested against the new frustum */
+	if (!samePos) ResetRegionStates();
+	if (chunkUpdates) samePos = false;
+
+	/* Newly built chunks may reveal or hide other chunks */
+	if (MapRenderer_OcclusionCulling && (!samePos || visGraphChanged)) {
+		CalcOcclusion(renderDistSquared);
+		visGraphChanged = false;
+		samePos         = false;
+		MapRenderer_OccludedChunks = 0;
+	}
 
 	renderChunksCount = samePos ?
-		UpdateChunksStill(&chunkUpdates) :
-		UpdateChunksAndVisibility(&chunkUpdates);
+		UpdateChunksStill() :
+		UpdateChunksAndVisibility();
 
 	lastCamPos = Camera.CurrentPos;
 	lastPitch  = p->Base.Pitch;
 	lastYaw    = p->Base.Yaw;
 
-	if (!samePos || chunkUpdates) ResetPartFlags();
+	if (MapRenderer_MeshBudget && MapRenderer_MeshBytes > MapRenderer_MeshBudget) EvictChunkMeshes();
+
+	if (!samePos) InvalidateDrawLists();
 }
 
 static void SortMapChunks(int left, int right) {
@@ -655,11 +1594,160 @@ static void SortMapChunks(int left, int right) {
 	}
 }
 
-static void UpdateSortOrder(void) {
+/* Consider these 3 chunks: */
+/* |       X-1      |        X        |       X+1      | */
+/* |################|########@########|################| */
+/* Assume the player is standing at @, then DrawXMin/XMax is calculated as this */
+/*    X-1: DrawXMin = false, DrawXMax = true  */
+/*    X  : DrawXMin = true,  DrawXMax = true  */
+/*    X+1: DrawXMin = true,  DrawXMax = false */
+static CC_INLINE void SetDrawFlags(struct ChunkInfo* info, int dx, int dy, int dz) {
+	info->drawXMin = dx >= 0; info->drawXMax = dx <= 0;
+	info->drawZMin = dz >= 0; info->drawZMax = dz <= 0;
+	info->drawYMin = dy >= 0; info->drawYMax = dy <= 0;
+}
+
+static void SortShellOffsets(int left, int right) {
+	struct ChunkOffset* values = shellOffsets; struct ChunkOffset value;
+	cc_uint32* keys = shellDistances; cc_uint32 key;
+
+	while (left < right) {
+		int i = left, j = right;
+		cc_uint32 pivot = keys[(i + j) >> 1];
+
+		/* partition the list */
+		while (i <= j) {
+			while (pivot > keys[i]) i++;
+			while (pivot < keys[j]) j--;
+			QuickSort_Swap_KV_Maybe();
+		}
+		/* recurse into the smaller subset */
+		QuickSort_Recurse(SortShellOffsets)
+	}
+}
+
+/* Calculates the offsets of all the chunks within view distance of the camera's chunk, sorted by distance */
+/*  (so that chunks can be sorted just by looking up the chunks at those offsets) */
+static void CalcShellOffsets(void) {
+	int maxDistSqr = max(buildDistSquared, renderDistSquared);
+	int radius = (int)Math_SqrtF((float)maxDistSqr) / CHUNK_SIZE + 1;
+	int maxX = min(radius, World.ChunksX - 1);
+	int maxY = min(radius, World.ChunksY - 1);
+	int maxZ = min(radius, World.ChunksZ - 1);
+	int x, y, z, distSqr, count = 0;
+
+	FreeShell();
+	shellDirty = false;
+
+	for (y = -maxY; y <= maxY; y++)
+		for (z = -maxZ; z <= maxZ; z++)
+			for (x = -maxX; x <= maxX; x++)
+	{
+		distSqr = (x * x + y * y + z * z) * CHUNK_SIZE * CHUNK_SIZE;
+		if (distSqr <= maxDistSqr) count++;
+	}
+
+	/* Not worth it when view distance covers most of the world */
+	if (count > chunksCount) return;
+	shellOffsets   = (struct ChunkOffset*)Mem_TryAlloc(count, sizeof(struct ChunkOffset));
+	shellDistances = (cc_uint32*)Mem_TryAlloc(count, sizeof(cc_uint32));
+	if (!shellOffsets || !shellDistances) { FreeShell(); shellDirty = false; return; }
+
+	for (y = -maxY; y <= maxY; y++)
+		for (z = -maxZ; z <= maxZ; z++)
+			for (x = -maxX; x <= maxX; x++)
+	{
+		distSqr = (x * x + y * y + z * z) * CHUNK_SIZE * CHUNK_SIZE;
+		if (distSqr > maxDistSqr) continue;
+
+		shellOffsets[shellCount].x = x;
+		shellOffsets[shellCount].y = y;
+		shellOffsets[shellCount].z = z;
+		shellDistances[shellCount] = distSqr;
+		shellCount++;
+	}
+	SortShellOffsets(0, shellCount - 1);
+}
+
+/* Sorts only the chunks within view distance, using the precalculated sorted offsets */
+static void SortChunksByShell(void) {
+	int cx = chunkPos.x >> CHUNK_SHIFT, cy = chunkPos.y >> CHUNK_SHIFT, cz = chunkPos.z >> CHUNK_SHIFT;
+	struct ChunkOffset* offset;
+	struct ChunkInfo* info;
+	int i, j = 0, x, y, z;
+
+	for (i = 0; i < shellCount; i++) 
+	{
+		offset = &shellOffsets[i];
+		x = cx + offset->x; y = cy + offset->y; z = cz + offset->z;
+		if (x < 0 || y < 0 || z < 0 || x >= World.ChunksX || y >= World.ChunksY || z >= World.ChunksZ) continue;
+
+		info = &mapChunks[World_ChunkPack(x, y, z)];
+		SetDrawFlags(info, offset->x * CHUNK_SIZE, offset->y * CHUNK_SIZE, offset->z * CHUNK_SIZE);
+		sortedChunks[j] = info;
+		distances[j]    = shellDistances[i];
+		j++;
+	}
+	sortedChunksCount = j;
+}
+
+/* Sorts every chunk in the world by distance from the camera */
+static void SortAllChunks(void) {
 	struct ChunkInfo* info;
-	IVec3 pos;
 	int i, dx, dy, dz;
 
+	for (i = 0; i < chunksCount; i++) {
+		info = &mapChunks[i];
+		/* Calculate distance to chunk centre */
+		dx = info->centreX - chunkPos.x; dy = info->centreY - chunkPos.y; dz = info->centreZ - chunkPos.z;
+		distances[i]    = dx * dx + dy * dy + dz * dz;
+		sortedChunks[i] = info;
+		SetDrawFlags(info, dx, dy, dz);
+	}
+
+	sortedChunksCount = chunksCount;
+	SortMapChunks(0, chunksCount - 1);
+}
+
+/* Deletes the meshes of chunks which are now too far away from the camera */
+static void UnloadFarChunks(void) {
+	int unloadDistSqr = buildDistSquared + 32 * 16;
+	struct ChunkInfo* info;
+	int i, dx, dy, dz;
+
+	for (i = 0; i < loadedChunksCount; ) 
+	{
+		info = loadedChunks[i];
+		dx = info->centreX - chunkPos.x; dy = info->centreY - chunkPos.y; dz = info->centreZ - chunkPos.z;
+
+		if (!info->noData && dx * dx + dy * dy + dz * dz < unloadDistSqr) { i++; continue; }
+		if (!info->noData) DeleteChunk(info);
+
+		info->loaded    = false;
+		loadedChunks[i] = loadedChunks[--loadedChunksCount];
+	}
+}
+
+/* Rebuilds the meshes of chunks which are now closer or further away than their level of detail is for */
+static void UpdateChunkLods(void) {
+	struct ChunkInfo* info;
+	int i, lod;
+
+	for (i = 0; i < loadedChunksCount; i++) 
+	{
+		info = loadedChunks[i];
+		lod  = CalcChunkLod(info);
+		if (lod == info->lod) continue;
+
+		/* The old mesh is still drawn until the chunk has been rebuilt */
+		info->lod = lod;
+		ChunkInfo_Refresh(info);
+	}
+}
+
+static void UpdateSortOrder(void) {
+	IVec3 pos;
+
 	/* pos is centre coordinate of chunk camera is in */
 	IVec3_Floor(&pos, &Camera.CurrentPos);
 	pos.x = (pos.x & ~CHUNK_MASK) + HALF_CHUNK_SIZE;
@@ -669,30 +1757,19 @@ static void UpdateSortOrder(void) {
 	/* If in same chunk, don't need to recalculate sort order */
 	if (pos.x == chunkPos.x && pos.y == chunkPos.y && pos.z == chunkPos.z) return;
 	chunkPos = pos;
+	buildQueueStale = true;
 	if (!chunksCount) return;
 
-	for (i = 0; i < chunksCount; i++) {
-		info = sortedChunks[i];
-		/* Calculate distance to chunk centre */
-		dx = info->centreX - pos.x; dy = info->centreY - pos.y; dz = info->centreZ - pos.z;
-		distances[i] = dx * dx + dy * dy + dz * dz;
-
-		/* Consider these 3 chunks: */
-		/* |       X-1      |        X        |       X+1      | */
-		/* |################|########@########|################| */
-		/* Assume the player is standing at @, then DrawXMin/XMax is calculated as this */
-		/*    X-1: DrawXMin = false, DrawXMax = true  */
-		/*    X  : DrawXMin = true,  DrawXMax = true  */
-		/*    X+1: DrawXMin = true,  DrawXMax = false */
-
-		info->drawXMin = dx >= 0; info->drawXMax = dx <= 0;
-		info->drawZMin = dz >= 0; info->drawZMax = dz <= 0;
-		info->drawYMin = dy >= 0; info->drawYMax = dy <= 0;
+	if (shellDirty) CalcShellOffsets();
+	if (shellOffsets) {
+		SortChunksByShell();
+	} else {
+		SortAllChunks();
 	}
 
-	SortMapChunks(0, chunksCount - 1);
-	ResetPartFlags();
-	/*SimpleOcclusionCulling();*/
+	UnloadFarChunks();
+	UpdateChunkLods();
+	InvalidateDrawLists();
 }
 
 void MapRenderer_Update(float delta) {
@@ -713,14 +1790,48 @@ void MapRenderer_RefreshChunk(int cx, int cy, int cz) {
 	ChunkInfo_Refresh(chunk);
 }
 
+void MapRenderer_RefreshChunkSlices(int cx, int cy, int cz, int minY, int maxY) {
+	struct ChunkInfo* chunk;
+	if (cx < 0 || cy < 0 || cz < 0 || cx >= World.ChunksX || cy >= World.ChunksY || cz >= World.ChunksZ) return;
+
+	minY = max(minY - (cy << CHUNK_SHIFT), 0);
+	maxY = min(maxY - (cy << CHUNK_SHIFT), CHUNK_MAX);
+	if (minY > maxY) return;
+
+	chunk = &mapChunks[World_ChunkPack(cx, cy, cz)];
+	ChunkInfo_RefreshSlices(chunk, minY, maxY);
+}
+
 void MapRenderer_OnBlockChanged(int x, int y, int z, BlockID block) {
 	int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, cz = z >> CHUNK_SHIFT;
 	struct ChunkInfo* chunk;
+	int yy = y & CHUNK_MASK;
 
 	chunk = &mapChunks[World_ChunkPack(cx, cy, cz)];
 	chunk->allAir &= Blocks.Draw[block] == DRAW_GAS;
-	/* TODO: Don't lookup twice, refresh directly using chunk pointer */
-	ChunkInfo_Refresh(chunk);
+	/* Only faces of blocks in the slices directly above and below can be affected by the change */
+	ChunkInfo_RefreshSlices(chunk, max(yy - 1, 0), min(yy + 1, CHUNK_MAX));
+}
+
+void MapRenderer_OnBlocksChanged(const IVec3* coords, const BlockID* blocks, int count) {
+	struct ChunkInfo* chunk = NULL;
+	struct ChunkInfo* cur;
+	int i, yy, minY = 0, maxY = 0;
+
+	/* Slices of a chunk are only refreshed once for a run of changes in that chunk */
+	for (i = 0; i < count; i++) 
+	{
+		cur = &mapChunks[World_ChunkPack(coords[i].x >> CHUNK_SHIFT, coords[i].y >> CHUNK_SHIFT, coords[i].z >> CHUNK_SHIFT)];
+		cur->allAir &= Blocks.Draw[blocks[i]] == DRAW_GAS;
+		yy = coords[i].y & CHUNK_MASK;
+
+		if (cur == chunk) {
+			minY = min(minY, yy); maxY = max(maxY, yy); continue;
+		}
+		if (chunk) ChunkInfo_RefreshSlices(chunk, max(minY - 1, 0), min(maxY + 1, CHUNK_MAX));
+		chunk = cur; minY = yy; maxY = yy;
+	}
+	if (chunk) ChunkInfo_RefreshSlices(chunk, max(minY - 1, 0), min(maxY + 1, CHUNK_MAX));
 }
 
 static void OnEnvVariableChanged(void* obj, int envVar) {
@@ -745,17 +1856,19 @@ static void OnTerrainAtlasChanged(void* obj) {
 
 	MapRenderer_1DUsedCount = MapRenderer_UsedAtlases();
 	tilesPerAtlas = Atlas1D.TilesPerAtlas;
-	ResetPartFlags();
+	InvalidateDrawLists();
 }
 
 static void OnBlockDefinitionChanged(void* obj) {
 	MapRenderer_Refresh();
 	MapRenderer_1DUsedCount = MapRenderer_UsedAtlases();
-	ResetPartFlags();
+	InvalidateDrawLists();
 }
 
 static void OnVisibilityChanged(void* obj) {
 	lastCamPos = Vec3_BigPos();
+	chunkPos   = IVec3_MaxValue();
+	shellDirty = true;
 	CalcViewDists();
 }
 static void DeleteChunks_(void* obj) { DeleteChunks(); }
@@ -799,7 +1912,12 @@ static void OnInit(void) {
 	/* This = 87 fixes map being invisible when no textures */
 	MapRenderer_1DUsedCount = 87; /* Atlas1D_UsedAtlasesCount(); */
 	chunkPos   = IVec3_MaxValue();
-	maxChunkUpdates = Options_GetInt(OPT_MAX_CHUNK_UPDATES, 4, 1024, 30);
+	maxChunkUpdates = Options_GetInt(OPT_MAX_CHUNK_UPDATES, 4, MAX_CHUNK_UPDATES, 30);
+	buildTimeBudget = Options_GetInt(OPT_CHUNK_BUILD_TIME,  500, 100000, 8000);
+	MapRenderer_OcclusionCulling = Options_GetBool(OPT_OCCLUSION_CULLING, true);
+	/* NOTE: Limited to 4095 megabytes so budget still fits in 32 bits */
+	MapRenderer_MeshBudget = (cc_uint32)Options_GetInt(OPT_CHUNK_MEMORY, 0, 4095, 0) * 1024 * 1024;
+	MapRenderer_LodDistance = Options_GetInt(OPT_LOD_DISTANCE, 0, 32768, 512);
 	CalcViewDists();
 }
 
@@ -2,6 +2,7 @@
 #define CC_MAPRENDERER_H
 #include "Core.h"
 #include "Constants.h"
+#include "Vectors.h"
 CC_BEGIN_HEADER
 
 /* Renders the blocks of the world by subdividing it into chunks.
@@ -32,6 +33,13 @@ struct ChunkPartInfo {
 	cc_uint16 counts[FACE_COUNT]; /* Counts per face */
 };
 
+/* Bit in ChunkInfo.visFlags for whether face a can be seen from face b of a chunk (where a < b) */
+#define CHUNK_VIS_BIT(a, b) (1 << ((a) * 5 - (a) * ((a) - 1) / 2 + (b) - (a) - 1))
+/* All faces of the chunk can be seen from every other face */
+#define CHUNK_VIS_ALL 0x7FFF
+/* Chunk's vertex buffer isn't shared with any other chunks */
+#define CHUNK_NO_ARENA 0xFF
+
 /* Describes data necessary for rendering a chunk. */
 struct ChunkInfo {	
 	cc_uint16 centreX, centreY, centreZ; /* Centre coordinates of the chunk */
@@ -41,6 +49,9 @@ struct ChunkInfo {
 	cc_uint8 dirty : 1;   /* Whether chunk is pending being rebuilt */
 	cc_uint8 allAir : 1;  /* Whether chunk is completely air */
 	cc_uint8 noData : 1;  /* Whether the chunk is currently empty of data, but may have data if built */
+	cc_uint8 occluded : 1; /* Whether chunk can't be seen from the camera, due to chunks in front of it */
+	cc_uint8 pending : 1;  /* Whether chunk is in the list of chunks waiting to be rebuilt */
+	cc_uint8 loaded : 1;   /* Whether chunk is in the list of chunks that have meshes */
 	cc_uint8 : 0;         /* pad to next byte*/
 
 	cc_uint8 drawXMin : 1;
@@ -49,18 +60,44 @@ struct ChunkInfo {
 	cc_uint8 drawZMax : 1;
 	cc_uint8 drawYMin : 1;
 	cc_uint8 drawYMax : 1;
+	cc_uint8 evicted : 1;  /* Whether mesh was deleted to save memory, so shouldn't be rebuilt until visible */
+	cc_uint8 queued : 1;   /* Whether chunk is in the priority queue of chunks to build */
 	cc_uint8 : 0;          /* pad to next byte */
-#ifdef OCCLUSION
-	public cc_bool Visited = false, Occluded = false;
-	public byte OcclusionFlags, OccludedFlags, DistanceFlags;
-#endif
+	cc_uint8 lod : 2;      /* Level of detail the mesh is built with (0 = full detail, see MapRenderer_LodDistance) */
+	cc_uint8 : 0;          /* pad to next byte */
+	/* Range of y slices (relative to the chunk) that changed since the mesh was last built */
+	/* NOTE: When only some slices changed, the mesh can be incrementally rebuilt */
+	cc_uint8 dirtyMinY, dirtyMaxY;
+	/* Which pairs of faces of the chunk are connected by non-opaque blocks (see CHUNK_VIS_BIT) */
+	cc_uint16 visFlags;
+	/* Number of bytes used by the chunk's mesh */
+	cc_uint32 meshBytes;
+	/* Value of the visibility counter when the chunk was last visible (see MapRenderer_MeshBudget) */
+	cc_uint32 lastVisible;
 #ifndef CC_BUILD_GL11
 	GfxResourceID vb;
+	/* Index of the shared mesh arena the vertex buffer belongs to, or CHUNK_NO_ARENA */
+	cc_uint8 vbArena;
+	/* Range of vertices in the vertex buffer that are used by this chunk's mesh */
+	int vbOffset, vbCount;
 #endif
 	struct ChunkPartInfo* normalParts;
 	struct ChunkPartInfo* translucentParts;
 };
 
+/* Whether chunks hidden behind other chunks are skipped when rendering */
+extern cc_bool MapRenderer_OcclusionCulling;
+/* Number of chunks skipped due to occlusion culling in the last visibility update */
+extern int MapRenderer_OccludedChunks;
+/* Total number of bytes used by the meshes of all chunks */
+extern cc_uint32 MapRenderer_MeshBytes;
+/* Maximum number of bytes chunk meshes should use, or 0 for no limit */
+/* NOTE: When over budget, meshes of chunks that haven't been visible for longest are deleted */
+extern cc_uint32 MapRenderer_MeshBudget;
+/* Distance from camera beyond which chunk meshes are built with less detail, or 0 to always use full detail */
+/* NOTE: Beyond twice this distance, chunk meshes are built with even less detail */
+extern int MapRenderer_LodDistance;
+
 /* Renders the meshes of non-translucent blocks in visible chunks. */
 void MapRenderer_RenderNormal(float delta);
 /* Renders the meshes of translucent blocks in visible chunks. */
@@ -73,10 +110,23 @@ void MapRenderer_Update(float delta);
 /* Marks the given chunk as needing to be rebuilt/redrawn. */
 /* NOTE: Coordinates outside the map are simply ignored. */
 void MapRenderer_RefreshChunk(int cx, int cy, int cz);
+/* Marks only the blocks in the given chunk between minY and maxY as needing to be rebuilt/redrawn. */
+/* NOTE: minY and maxY are world coordinates, and are clamped to the chunk. */
+void MapRenderer_RefreshChunkSlices(int cx, int cy, int cz, int minY, int maxY);
 /* Called when a block is changed, to update internal state. */
 void MapRenderer_OnBlockChanged(int x, int y, int z, BlockID block);
+/* Called when multiple blocks are changed at once, to update internal state. */
+void MapRenderer_OnBlocksChanged(const IVec3* coords, const BlockID* blocks, int count);
 /* Deletes all chunks and resets internal state. */
 void MapRenderer_Refresh(void);
 
+#ifndef CC_BUILD_GL11
+/* Allocates vertices for the mesh of the given chunk, then acquires temp memory for changing them */
+/* NOTE: The vertices may be part of a vertex buffer shared with other chunks (see ChunkInfo.vbOffset) */
+void* MapRenderer_LockChunkVb(struct ChunkInfo* info, int count);
+/* Submits the changed vertices for the mesh of the given chunk */
+void  MapRenderer_UnlockChunkVb(struct ChunkInfo* info);
+#endif
+
 CC_END_HEADER
 #endif
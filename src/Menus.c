@@ -1818,7 +1818,7 @@ static void LoadLevelScreen_EntryClick(void* screen, void* widget) {
 	cc_string relPath = ListScreen_UNSAFE_GetCur(s, widget);
 	String_InitArray(path, pathBuffer);
 	String_Format1(&path, "maps/%s", &relPath);
-	res = Map_LoadFrom(&path);
+	res = Map_LoadFromAsync(&path);
 
 	/* FileNotFound error may be because user deleted maps from disc */
 	if (res != ReturnCode_FileNotFound) return;
@@ -1844,6 +1844,7 @@ static void LoadLevelScreen_LoadEntries(struct ListScreen* s) {
 	StringsBuffer_Sort(&s->entries);
 }
 
+/* NOTE: Uploaded files are deleted after the callback returns, so can't import asynchronously */
 static void LoadLevelScreen_UploadCallback(const cc_string* path) { Map_LoadFrom(path); }
 static void LoadLevelScreen_ActionFunc(void* s, void* w) {
 	static const char* const filters[] = { 
@@ -25,6 +25,7 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_ENTITY_SHADOW "entityshadow"
 #define OPT_RENDER_TYPE "normal"
 #define OPT_SMOOTH_LIGHTING "gfx-smoothlighting"
+#define OPT_GREEDY_MESHING "gfx-greedymeshing"
 #define OPT_LIGHTING_MODE "gfx-lightingmode"
 #define OPT_MIPMAPS "gfx-mipmaps"
 #define OPT_CHAT_LOGGING "chat-logging"
@@ -72,6 +73,11 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_CLASSIC_CHAT "nostalgia-classicchat"
 #define OPT_CLASSIC_INVENTORY "nostalgia-classicinventory"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_CHUNK_BUILD_TIME "gfx-chunkbuildtime"
+#define OPT_CHUNK_BUILD_THREADS "gfx-chunkbuildthreads"
+#define OPT_OCCLUSION_CULLING "gfx-occlusionculling"
+#define OPT_CHUNK_MEMORY "gfx-chunkmemory"
+#define OPT_LOD_DISTANCE "gfx-loddistance"
 #define OPT_CAMERA_MASS "cameramass"
 #define OPT_CAMERA_SMOOTH "camera-smooth"
 #define OPT_GRAB_CURSOR "win-grab-cursor"
@@ -81,6 +87,9 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_HTTP_ONLY "http-no-https"
 #define OPT_HTTPS_VERIFY "https-verify"
 #define OPT_SKIN_SERVER "http-skinserver"
+#define OPT_NET_CAPTURE "net-capture"
+#define OPT_NET_REPLAY "net-replay"
+#define OPT_NET_REPLAY_REALTIME "net-replayrealtime"
 #define OPT_RAW_INPUT "win-raw-input"
 #define OPT_DPI_SCALING "win-dpi-scaling"
 #define OPT_GAME_VERSION "game-version"
@@ -414,9 +414,8 @@ static cc_result MapState_Read(struct MapState* m) {
 		m->blocks = (BlockRaw*)Mem_TryAlloc(map_volume, 1);
 		/* unlikely but possible */
 		if (!m->blocks) {
-			Window_ShowDialog("Out of memory", "Not enough free memory to join that map.\nTry joining a different map.");
 			m->allocFailed = true;
-			return 0;
+			return ERR_OUT_OF_MEMORY;
 		}
 	}
 
@@ -558,14 +557,14 @@ static void Classic_LevelInit(cc_uint8* data) {
 #endif
 }
 
-static void Classic_LevelDataChunk(cc_uint8* data) {
+/* Used instead of the length of a LevelDataChunk packet once its map data has been decompressed */
+#define LEVEL_CHUNK_INFLATED 0xFFFF
+
+/* Decompresses the map data in the given LevelDataChunk packet */
+static cc_result Classic_InflateLevelChunk(cc_uint8* data) {
 	struct MapState* m;
 	int usedLength;
-	float progress;
 	cc_result res;
-
-	/* Workaround for some servers that send LevelDataChunk before LevelInit due to their async sending behaviour */
-	if (!map_begunLoading) Classic_StartLoading();
 	usedLength = Stream_GetU16_BE(data);
 
 	map_part.meta.mem.cur    = data + 2;
@@ -586,18 +585,56 @@ static void Classic_LevelDataChunk(cc_uint8* data) {
 
 	if (!m->gzHeader.done) {
 		res = GZipHeader_Read(&map_part, &m->gzHeader);
-		if (res && res != ERR_END_OF_STREAM) { DisconnectInvalidMap(res); return; }
+		if (res && res != ERR_END_OF_STREAM) return res;
 	}
 
-	if (m->gzHeader.done) {
-		res = MapState_Read(m);
-		if (res) { DisconnectInvalidMap(res); return; }
+	if (m->gzHeader.done) return MapState_Read(m);
+	return 0;
+}
+
+static void Classic_LevelDataChunk(cc_uint8* data) {
+	int index, volume;
+	float progress;
+	cc_result res;
+
+	/* Workaround for some servers that send LevelDataChunk before LevelInit due to their async sending behaviour */
+	if (!map_begunLoading) Classic_StartLoading();
+
+	if (Stream_GetU16_BE(data) == LEVEL_CHUNK_INFLATED) {
+		res    = Stream_GetU32_BE(data +  2);
+		index  = Stream_GetU32_BE(data +  6);
+		volume = Stream_GetU32_BE(data + 10);
+	} else {
+		res    = Classic_InflateLevelChunk(data);
+		index  = map1.index;
+		volume = map_volume;
+	}
+
+	if (res == ERR_OUT_OF_MEMORY) {
+		Window_ShowDialog("Out of memory", "Not enough free memory to join that map.\nTry joining a different map.");
+	} else if (res) {
+		DisconnectInvalidMap(res); return;
 	}
 
-	progress = !map_volume ? 0.0f : (float)map1.index / map_volume;
+	progress = !volume ? 0.0f : (float)index / volume;
 	Event_RaiseFloat(&WorldEvents.Loading, progress);
 }
 
+/* Decompresses the map data in the given LevelDataChunk packet on the network thread */
+/*  (the compressed data is then replaced with the result, for Classic_LevelDataChunk) */
+static cc_bool Classic_PrepareLevelChunk(cc_uint8* data) {
+	cc_result res;
+	/* Loading the map has to be started on the main thread first */
+	if (!map_begunLoading || Protocol.Handlers[OPCODE_LEVEL_DATA] != Classic_LevelDataChunk) return false;
+
+	res = Classic_InflateLevelChunk(data);
+	Stream_SetU16_BE(data +  0, LEVEL_CHUNK_INFLATED);
+	Stream_SetU32_BE(data +  2, res);
+	Stream_SetU32_BE(data +  6, map1.index);
+	Stream_SetU32_BE(data + 10, map_volume);
+	return true;
+}
+
 static void Classic_LevelFinalise(cc_uint8* data) {
 	int width, height, length, volume;
 	cc_uint64 end;
@@ -1286,8 +1323,9 @@ static void CPE_ExtAddEntity2(cc_uint8* data) {
 static void CPE_BulkBlockUpdate(cc_uint8* data) {
 	cc_int32 indices[BULK_MAX_BLOCKS];
 	BlockID blocks[BULK_MAX_BLOCKS];
-	int index, i;
-	int x, y, z;
+	BlockID oldBlocks[BULK_MAX_BLOCKS];
+	IVec3 coords[BULK_MAX_BLOCKS];
+	int index, i, changed = 0;
 	int count = 1 + *data++;
 
 	for (i = 0; i < count; i++) {
@@ -1314,14 +1352,16 @@ static void CPE_BulkBlockUpdate(cc_uint8* data) {
 	for (i = 0; i < count; i++) {
 		index = indices[i];
 		if (index < 0 || index >= World.Volume) continue;
-		World_Unpack(index, x, y, z);
+		World_Unpack(index, coords[changed].x, coords[changed].y, coords[changed].z);
 
 #ifdef EXTENDED_BLOCKS
-		Game_UpdateBlock(x, y, z, blocks[i] % BLOCK_COUNT);
+		blocks[changed] = blocks[i] % BLOCK_COUNT;
 #else
-		Game_UpdateBlock(x, y, z, blocks[i]);
+		blocks[changed] = blocks[i];
 #endif
+		changed++;
 	}
+	Game_UpdateBlocks(coords, blocks, oldBlocks, changed);
 }
 
 static void CPE_SetTextColor(cc_uint8* data) {
@@ -1942,6 +1982,22 @@ static void Protocol_Reset(void) {
 	WoM_Reset();
 }
 
+cc_bool Protocol_Prepare(cc_uint8 opcode, cc_uint8* data) {
+	switch (opcode) 
+	{
+	/* Handling these packets changes the size of later packets */
+	case OPCODE_EXT_INFO:
+	case OPCODE_EXT_ENTRY:
+	/* Handling these packets changes how later map data is decompressed */
+	case OPCODE_LEVEL_BEGIN:
+	case OPCODE_LEVEL_END:
+		return true;
+	case OPCODE_LEVEL_DATA:
+		return !Classic_PrepareLevelChunk(data);
+	}
+	return false;
+}
+
 void Protocol_Tick(void) {
 	cc_uint8 tmp[256];
 	cc_uint8* data = tmp;
@@ -71,6 +71,11 @@ struct IGameComponent;
 extern struct IGameComponent Protocol_Component;
 
 void Protocol_Tick(void);
+/* Prepares the given packet for being handled, as soon as it has been received */
+/*  (e.g. decompresses map data, so that handling the packet later is quick) */
+/* Returns whether handling this packet might change how later packets are read */
+/* NOTE: This is called on the network thread, and so must not use most game state */
+cc_bool Protocol_Prepare(cc_uint8 opcode, cc_uint8* data);
 
 extern cc_bool cpe_needD3Fix;
 void Classic_SendChat(const cc_string* text, cc_bool partial);
@@ -24,6 +24,8 @@
 #include "Options.h"
 #include "InputHandler.h"
 #include "Protocol.h"
+#include "MapRenderer.h"
+#include "Formats.h"
 
 #define CHAT_MAX_STATUS Array_Elems(Chat_Status)
 #define CHAT_MAX_BOTTOMRIGHT Array_Elems(Chat_BottomRight)
@@ -89,7 +91,7 @@ static struct HUDScreen {
 
 static void HUDScreen_RemakeLine1(struct HUDScreen* s) {
 	cc_string status; char statusBuffer[STRING_SIZE * 2];
-	int indices, ping, fps;
+	int indices, ping, fps, meshMB, budgetMB;
 	float real_fps;
 
 	String_InitArray(status, statusBuffer);
@@ -117,6 +119,17 @@ static void HUDScreen_RemakeLine1(struct HUDScreen* s) {
 
 		indices = ICOUNT(Game_Vertices);
 		String_Format1(&status, "%i vertices", &indices);
+		if (MapRenderer_OcclusionCulling) {
+			String_Format1(&status, ", %i chunks culled", &MapRenderer_OccludedChunks);
+		}
+
+		meshMB = (int)(MapRenderer_MeshBytes >> 20);
+		if (MapRenderer_MeshBudget) {
+			budgetMB = (int)(MapRenderer_MeshBudget >> 20);
+			String_Format2(&status, ", meshes %i/%i MB", &meshMB, &budgetMB);
+		} else {
+			String_Format1(&status, ", meshes %i MB", &meshMB);
+		}
 
 		ping = Ping_AveragePingMS();
 		if (ping) String_Format1(&status, ", ping %i ms", &ping);
@@ -2060,6 +2073,33 @@ void GeneratingScreen_Show(void) {
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------MapLoadingScreen-----------------------------------------------------*
+*#########################################################################################################################*/
+static void MapLoadingScreen_Render(void* screen, float delta) {
+	struct LoadingScreen* s = (struct LoadingScreen*)screen;
+	s->progress = Map_AsyncProgress();
+	LoadingScreen_Render(s, delta);
+	Map_CheckAsyncLoad();
+}
+
+static const struct ScreenVTABLE MapLoadingScreen_VTABLE = {
+	GeneratingScreen_Init,   Screen_NullUpdate, GeneratingScreen_Free,
+	MapLoadingScreen_Render, LoadingScreen_BuildMesh,
+	Screen_TInput,           Screen_InputUp,    Screen_TKeyPress,   Screen_TText,
+	Screen_TPointer,         Screen_PointerUp,  Screen_FPointer,    Screen_TMouseScroll,
+	LoadingScreen_Layout, LoadingScreen_ContextLost, LoadingScreen_ContextRecreated
+};
+void MapLoadingScreen_Show(const cc_string* path) {
+	static const cc_string title = String_FromConst("Loading level");
+	cc_string fileName = *path;
+	Utils_UNSAFE_GetFilename(&fileName);
+
+	LoadingScreen.VTABLE = &MapLoadingScreen_VTABLE;
+	LoadingScreen_ShowCommon(&title, &fileName);
+}
+
+
 /*########################################################################################################################*
 *----------------------------------------------------DisconnectScreen-----------------------------------------------------*
 *#########################################################################################################################*/
@@ -30,6 +30,8 @@ void InventoryScreen_Show(void);
 void HUDScreen_Show(void);
 void LoadingScreen_Show(const cc_string* title, const cc_string* message);
 void GeneratingScreen_Show(void);
+/* Shows a loading screen that finishes loading the map imported by Map_LoadFromAsync */
+void MapLoadingScreen_Show(const cc_string* path);
 void ChatScreen_Show(void);
 void DisconnectScreen_Show(const cc_string* title, const cc_string* message);
 #ifdef CC_BUILD_TOUCH
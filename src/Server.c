@@ -25,6 +25,10 @@
 #include "Input.h"
 #include "Errors.h"
 #include "Options.h"
+#include "Utils.h"
+#include "Deflate.h"
+#include "Stream.h"
+#include "ExtMath.h"
 
 static char nameBuffer[STRING_SIZE];
 static char motdBuffer[STRING_SIZE];
@@ -126,7 +130,7 @@ static void SPConnection_BeginConnect(void) {
 
 	/* For when user drops a map file onto ClassiCube.exe */
 	if (SP_AutoloadMap.length) {
-		Map_LoadFrom(&SP_AutoloadMap); return;
+		Map_LoadFromAsync(&SP_AutoloadMap); return;
 	}
 
 	Random_SeedFromCurrentTime(&rnd);
@@ -239,10 +243,62 @@ static cc_uint8  net_readBuffer[4096 * 5];
 static cc_uint8* net_readCurrent;
 static double net_lastPacket;
 static cc_uint8 lastOpcode;
+static struct ServerSendStats net_sendStats;
+/* Whether to track how many of and how long was spent handling each type of packet */
+static cc_bool net_timeHandlers;
+static int net_handledCounts[256];
+static cc_uint64 net_handledTimes[256];
 
 static cc_bool net_connecting;
 static float net_connectElapsed;
 #define NET_TIMEOUT_SECS 15
+static void MPConnection_StartReceiving(void);
+
+/* Network captures start with NET_CAPTURE_MAGIC, followed by records of when some data was */
+/*  received (in milliseconds since connecting) and how much was received, followed by that data */
+#define NET_CAPTURE_MAGIC "CCNETCAP"
+#define NET_CAPTURE_MAGIC_SIZE 8
+#define NET_RECORD_HEADER_SIZE 8
+static struct Stream net_capture;
+static cc_bool net_capturing;
+static cc_result net_captureResult;
+static cc_uint64 net_captureBeg;
+
+static void NetCapture_Begin(void) {
+	cc_string path;
+	cc_result res;
+	if (!Options_UNSAFE_Get(OPT_NET_CAPTURE, &path)) return;
+
+	res = Stream_CreateFile(&net_capture, &path);
+	if (res) { Logger_SysWarn2(res, "creating", &path); return; }
+
+	net_capturing     = true;
+	net_captureBeg    = Stopwatch_Measure();
+	net_captureResult = Stream_Write(&net_capture, (const cc_uint8*)NET_CAPTURE_MAGIC, NET_CAPTURE_MAGIC_SIZE);
+}
+
+/* NOTE: Called from the network thread when threaded receiving is used */
+static void NetCapture_Add(const cc_uint8* data, cc_uint32 len) {
+	cc_uint8 header[NET_RECORD_HEADER_SIZE];
+	if (!net_capturing || net_captureResult) return;
+
+	Stream_SetU32_BE(header + 0, Stopwatch_ElapsedMS(net_captureBeg, Stopwatch_Measure()));
+	Stream_SetU32_BE(header + 4, len);
+
+	net_captureResult = Stream_Write(&net_capture, header, NET_RECORD_HEADER_SIZE);
+	if (net_captureResult) return;
+	net_captureResult = Stream_Write(&net_capture, data, len);
+}
+
+static void NetCapture_End(void) {
+	cc_result res;
+	if (!net_capturing) return;
+	net_capturing = false;
+
+	res = net_capture.Close(&net_capture);
+	if (net_captureResult) res = net_captureResult;
+	if (res) Logger_SysWarn(res, "writing network capture");
+}
 
 static void MPConnection_FinishConnect(void) {
 	net_connecting = false;
@@ -251,6 +307,9 @@ static void MPConnection_FinishConnect(void) {
 
 	net_readCurrent = net_readBuffer;
 	net_lastPacket  = Game.Time;
+	Mem_Set(&net_sendStats, 0, sizeof(net_sendStats));
+	NetCapture_Begin();
+	MPConnection_StartReceiving();
 	Classic_SendLogin();
 }
 
@@ -377,17 +436,55 @@ static void DisconnectInvalidOpcode(cc_uint8 opcode) {
 	Game_Disconnect(&title, &tmp); return;
 }
 
-static void MPConnection_Tick(struct ScheduledTask* task) {
+/* Handles all of the packets in the given data, stopping early at a partially received packet */
+/*  or if the given time budget (if any) is used up. Returns where handling of packets stopped, */
+/*  or NULL if the connection was closed by one of the packets */
+static cc_uint8* MPConnection_HandlePackets(cc_uint8* readCur, cc_uint8* readEnd, cc_uint64 beg, int budget) {
 	Net_Handler handler;
+
+	while (readCur < readEnd) {
+		cc_uint8 opcode = readCur[0];
+
+		/* Workaround for older D3 servers which wrote one byte too many for HackControl packets */
+		if (cpe_needD3Fix && lastOpcode == OPCODE_HACK_CONTROL && (opcode == 0x00 || opcode == 0xFF)) {
+			Platform_LogConst("Skipping invalid HackControl byte from D3 server");
+			readCur++;
+			LocalPlayer_ResetJumpVelocity(Entities.CurPlayer);
+			continue;
+		}
+
+		if (readCur + Protocol.Sizes[opcode] > readEnd) break;
+		handler = Protocol.Handlers[opcode];
+		if (!handler) { DisconnectInvalidOpcode(opcode); return NULL; }
+
+		lastOpcode = opcode;
+		if (!net_timeHandlers) {
+			handler(readCur + 1); /* skip opcode */
+		} else {
+			cc_uint64 handlerBeg = Stopwatch_Measure();
+			handler(readCur + 1);
+			net_handledTimes[opcode] += Stopwatch_Measure() - handlerBeg;
+			net_handledCounts[opcode]++;
+		}
+		readCur += Protocol.Sizes[opcode];
+
+		if (Server.Disconnected) return NULL;
+		if (budget && Stopwatch_ElapsedMS(beg, Stopwatch_Measure()) >= budget) break;
+	}
+	return readCur;
+}
+
+#ifdef CC_BUILD_COOPTHREADED
+static void MPConnection_StartReceiving(void) { }
+static void MPConnection_StopReceiving(void)  { }
+
+static void MPConnection_Receive(void) {
 	cc_uint8* readEnd;
 	cc_uint8* readCur;
 	cc_uint32 read;
 	int i, remaining;
 	cc_result res;
 
-	if (Server.Disconnected) return;
-	if (net_connecting) { MPConnection_TickConnect(task); return; }
-
 	/* NOTE: using a read call that is a multiple of 4096 (appears to?) improve read performance */	
 	res = Socket_Read(net_socket, net_readCurrent, 4096 * 4, &read);
 	
@@ -403,29 +500,13 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		/* TODO: Should this be checked unconditonally instead of just when read = 0 ? */
 		if (net_lastPacket + 30 < Game.Time) { MPConnection_Disconnect(); return; }
 	} else {
+		NetCapture_Add(net_readCurrent, read);
 		readCur        = net_readBuffer;
 		readEnd        = net_readCurrent + read;
 		net_lastPacket = Game.Time;
 
-		while (readCur < readEnd) {
-			cc_uint8 opcode = readCur[0];
-
-			/* Workaround for older D3 servers which wrote one byte too many for HackControl packets */
-			if (cpe_needD3Fix && lastOpcode == OPCODE_HACK_CONTROL && (opcode == 0x00 || opcode == 0xFF)) {
-				Platform_LogConst("Skipping invalid HackControl byte from D3 server");
-				readCur++;
-				LocalPlayer_ResetJumpVelocity(Entities.CurPlayer);
-				continue;
-			}
-
-			if (readCur + Protocol.Sizes[opcode] > readEnd) break;
-			handler = Protocol.Handlers[opcode];
-			if (!handler) { DisconnectInvalidOpcode(opcode); return; }
-
-			lastOpcode = opcode;
-			handler(readCur + 1); /* skip opcode */
-			readCur += Protocol.Sizes[opcode];
-		}
+		readCur = MPConnection_HandlePackets(readCur, readEnd, 0, 0);
+		if (!readCur) return;
 
 		/* Protocol packets might be split up across TCP packets */
 		/* If so, copy last few unprocessed bytes back to beginning of buffer */
@@ -437,41 +518,294 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		}
 		net_readCurrent = net_readBuffer + remaining;
 	}
+}
+#else
+/* Packets are read from the socket and split up into whole packets on a separate thread, */
+/*  which then adds them to the 'received' buffer for the main thread to handle */
+#define NET_RECV_BUFFER_SIZE (64 * 1024)
+/* Milliseconds the main thread spends at most on handling received packets each tick */
+#define NET_TICK_BUDGET 5
+/* Milliseconds the network thread waits for more data to arrive on the socket */
+#define NET_POLL_INTERVAL 2
+
+enum NetThreadState { NET_THREAD_RUNNING, NET_THREAD_CLOSED, NET_THREAD_READ_FAILED, NET_THREAD_INVALID_OPCODE };
+static cc_uint8 net_recvBuffer[NET_RECV_BUFFER_SIZE];
+static int net_recvCount;
+static void* net_thread;
+static void* net_mutex;
+static void* net_threadWaitable;
+static void* net_mainWaitable;
+static cc_bool net_threadStopping, net_threadWaiting;
+static int net_threadState;
+static cc_result net_threadResult;
+
+/* Adds the given packets to the end of the 'received' buffer, */
+/*  waiting for the main thread to handle some packets first if the buffer is full */
+static void NetThread_AddPackets(const cc_uint8* data, int len) {
+	Mutex_Lock(net_mutex);
+	while (net_recvCount + len > NET_RECV_BUFFER_SIZE && !net_threadStopping) {
+		net_threadWaiting = true;
+		Mutex_Unlock(net_mutex);
+		Waitable_Wait(net_threadWaitable);
+		Mutex_Lock(net_mutex);
+	}
+	net_threadWaiting = false;
 
-	if (net_writeFailure) {
-		Platform_Log1("Error from send: %e", &net_writeFailure);
-		MPConnection_Disconnect(); return;
+	if (!net_threadStopping) {
+		Mem_Copy(net_recvBuffer + net_recvCount, data, len);
+		net_recvCount += len;
 	}
+	Mutex_Unlock(net_mutex);
+	Waitable_Signal(net_mainWaitable);
+}
 
-	/* Network is ticked 60 times a second. We only send position updates 20 times a second */
-	if ((ticks++ % 3) != 0) return;
+/* Waits until the main thread has handled all of the packets in the 'received' buffer */
+/*  (e.g. because handling the last packet changes the size of later packets) */
+static void NetThread_WaitHandled(void) {
+	Mutex_Lock(net_mutex);
+	while (net_recvCount && !net_threadStopping) {
+		net_threadWaiting = true;
+		Mutex_Unlock(net_mutex);
+		Waitable_Signal(net_mainWaitable);
+		Waitable_Wait(net_threadWaitable);
+		Mutex_Lock(net_mutex);
+	}
+	net_threadWaiting = false;
+	Mutex_Unlock(net_mutex);
+}
 
-	TexturePack_CheckPending();
-	Protocol_Tick();
+static void NetThread_Stop(int state, cc_result result) {
+	Mutex_Lock(net_mutex);
+	net_threadState  = state;
+	net_threadResult = result;
+	Mutex_Unlock(net_mutex);
+	Waitable_Signal(net_mainWaitable);
 }
 
-static void MPConnection_SendData(const cc_uint8* data, cc_uint32 len) {
+static void NetThread_Run(void) {
+	cc_uint8* readCur;
+	cc_uint8* readEnd;
+	cc_uint8* packetsBeg;
+	cc_uint8 opcode, prevOpcode = 0;
+	int size, remaining = 0;
+	cc_uint32 read;
+	cc_result res;
+
+	while (!net_threadStopping) {
+		/* NOTE: using a read call that is a multiple of 4096 (appears to?) improve read performance */	
+		res = Socket_Read(net_socket, net_readBuffer + remaining, 4096 * 4, &read);
+
+		/* 'no data available for non-blocking read' is an expected error */
+		if (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock) {
+			Waitable_WaitFor(net_threadWaitable, NET_POLL_INTERVAL); continue;
+		}
+		if (res) { NetThread_Stop(NET_THREAD_READ_FAILED, res); return; }
+		/* recv only returns 0 read when socket is closed.. probably? */
+		if (!read) { NetThread_Stop(NET_THREAD_CLOSED, 0); return; }
+		NetCapture_Add(net_readBuffer + remaining, read);
+
+		readCur    = net_readBuffer;
+		readEnd    = net_readBuffer + remaining + read;
+		packetsBeg = readCur;
+
+		while (readCur < readEnd) {
+			opcode = readCur[0];
+
+			/* Left for MPConnection_HandlePackets to skip */
+			if (cpe_needD3Fix && prevOpcode == OPCODE_HACK_CONTROL && (opcode == 0x00 || opcode == 0xFF)) {
+				readCur++; continue;
+			}
+
+			if (!Protocol.Handlers[opcode]) {
+				NetThread_AddPackets(packetsBeg, (int)(readCur - packetsBeg));
+				NetThread_Stop(NET_THREAD_INVALID_OPCODE, opcode); return;
+			}
+
+			size = Protocol.Sizes[opcode];
+			if (readCur + size > readEnd) break;
+
+			prevOpcode = opcode;
+			readCur   += size;
+			if (!Protocol_Prepare(opcode, readCur - size + 1)) continue;
+
+			/* Packets after this one can't be split up until this packet has been handled */
+			NetThread_AddPackets(packetsBeg, (int)(readCur - packetsBeg));
+			packetsBeg = readCur;
+			NetThread_WaitHandled();
+			if (net_threadStopping) return;
+		}
+		NetThread_AddPackets(packetsBeg, (int)(readCur - packetsBeg));
+
+		/* Protocol packets might be split up across TCP packets */
+		/* If so, move last few unprocessed bytes back to beginning of buffer */
+		remaining = (int)(readEnd - readCur);
+		Mem_Move(net_readBuffer, readCur, remaining);
+	}
+}
+
+static void MPConnection_StartReceiving(void) {
+	if (!net_mutex) {
+		net_mutex          = Mutex_Create("Network received");
+		net_threadWaitable = Waitable_Create("Network thread");
+		net_mainWaitable   = Waitable_Create("Network main");
+	}
+
+	net_recvCount      = 0;
+	net_threadStopping = false;
+	net_threadWaiting  = false;
+	net_threadState    = NET_THREAD_RUNNING;
+	Thread_Run(&net_thread, NetThread_Run, 128 * 1024, "Network");
+}
+
+static void MPConnection_StopReceiving(void) {
+	if (!net_thread) return;
+
+	Mutex_Lock(net_mutex);
+	net_threadStopping = true;
+	Mutex_Unlock(net_mutex);
+	Waitable_Signal(net_threadWaitable);
+
+	Thread_Join(net_thread);
+	net_thread    = NULL;
+	net_recvCount = 0;
+}
+
+static void MPConnection_Receive(void) {
+	cc_uint64 beg = Stopwatch_Measure();
+	cc_uint8* readCur;
+	cc_bool waiting;
+	int count, state, handled;
+	cc_result result;
+
+	for (;;) {
+		Mutex_Lock(net_mutex);
+		count  = net_recvCount;
+		state  = net_threadState;
+		result = net_threadResult;
+		Mutex_Unlock(net_mutex);
+		if (!count) break;
+
+		/* The network thread only ever adds packets after net_recvCount, */
+		/*  so the packets before that can be handled without holding the mutex */
+		readCur = MPConnection_HandlePackets(net_recvBuffer, net_recvBuffer + count, beg, NET_TICK_BUDGET);
+		if (!readCur) return;
+
+		net_lastPacket = Game.Time;
+		handled        = (int)(readCur - net_recvBuffer);
+
+		Mutex_Lock(net_mutex);
+		net_recvCount -= handled;
+		Mem_Move(net_recvBuffer, readCur, net_recvCount);
+		waiting = net_threadWaiting;
+		Mutex_Unlock(net_mutex);
+
+		if (waiting) Waitable_Signal(net_threadWaitable);
+		if (handled < count) return;
+
+		/* Give the network thread a chance to split up packets that were */
+		/*  received after a packet which had to be handled first */
+		if (!waiting || Stopwatch_ElapsedMS(beg, Stopwatch_Measure()) >= NET_TICK_BUDGET) return;
+		Waitable_WaitFor(net_mainWaitable, NET_POLL_INTERVAL);
+	}
+
+	if (state == NET_THREAD_READ_FAILED) {
+		DisconnectReadFailed(result);
+	} else if (state == NET_THREAD_INVALID_OPCODE) {
+		DisconnectInvalidOpcode((cc_uint8)result);
+	} else if (state == NET_THREAD_CLOSED && net_lastPacket + 30 < Game.Time) {
+		/* Over 30 seconds since last packet, connection probably dropped */
+		MPConnection_Disconnect();
+	}
+}
+#endif
+
+/* Data sent to the server is added to this buffer first, and then written to the socket */
+/*  each tick, so that many small packets (e.g. position updates) are sent in a few writes */
+#define NET_SEND_BUFFER_SIZE (16 * 1024)
+/* Server has stopped receiving data when this much data is waiting to be sent */
+#define NET_SEND_BUFFER_MAX  (4 * 1024 * 1024)
+static cc_uint8  net_sendDefault[NET_SEND_BUFFER_SIZE];
+static cc_uint8* net_sendBuffer = net_sendDefault;
+static int net_sendCapacity     = NET_SEND_BUFFER_SIZE;
+static int net_sendCount;
+
+/* Writes as much of the data waiting to be sent as the socket accepts without blocking */
+static void MPConnection_FlushSend(void) {
 	cc_uint32 wrote;
 	cc_result res;
-	int tries = 0;
-	if (Server.Disconnected) return;
+	int sent = 0;
 
-	while (len) {
-		res = Socket_Write(net_socket, data, len, &wrote);
-		/* If sending would block (send buffer full), retry for a bit up to 10 seconds */
-		/* TODO: Avoid doing this and manually buffer data when this happens */
-		if (res && tries < 1000 && (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock)) {
-			Thread_Sleep(10);
-			tries++;
-			continue;
+	while (sent < net_sendCount) {
+		res = Socket_Write(net_socket, net_sendBuffer + sent, net_sendCount - sent, &wrote);
+		/* Socket's send buffer is full, so try again next tick */
+		if (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock) {
+			net_sendStats.stalls++; break;
 		}
 
 		/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
-		if (res)    { net_writeFailure = res;                  return; }
-		if (!wrote) { net_writeFailure = ERR_INVALID_ARGUMENT; return; }
+		if (res)    { net_writeFailure = res;                  break; }
+		if (!wrote) { net_writeFailure = ERR_INVALID_ARGUMENT; break; }
+
+		sent += wrote;
+		net_sendStats.writes++;
+		net_sendStats.bytesSent += wrote;
+	}
+
+	net_sendCount -= sent;
+	Mem_Move(net_sendBuffer, net_sendBuffer + sent, net_sendCount);
+}
+
+static void MPConnection_SendData(const cc_uint8* data, cc_uint32 len) {
+	if (Server.Disconnected || net_writeFailure) return;
+
+	/* Server isn't receiving data fast enough, so try to make some space */
+	if (net_sendCount + len > net_sendCapacity) MPConnection_FlushSend();
+
+	if (net_sendCount + len > NET_SEND_BUFFER_MAX) {
+		net_writeFailure = ReturnCode_SocketWouldBlock; return;
+	}
+	while (net_sendCount + len > net_sendCapacity) {
+		Utils_Resize((void**)&net_sendBuffer, &net_sendCapacity, 1, NET_SEND_BUFFER_SIZE, net_sendCapacity);
+	}
+
+	Mem_Copy(net_sendBuffer + net_sendCount, data, len);
+	net_sendCount += len;
+	net_sendStats.peakQueued = max(net_sendStats.peakQueued, net_sendCount);
+}
+
+/* Tries to send any data still waiting to be sent, then resets the send buffer */
+static void MPConnection_StopSending(void) {
+	MPConnection_FlushSend();
+	net_sendCount = 0;
+
+	if (net_sendBuffer != net_sendDefault) Mem_Free(net_sendBuffer);
+	net_sendBuffer   = net_sendDefault;
+	net_sendCapacity = NET_SEND_BUFFER_SIZE;
+}
+
+void Server_GetSendStats(struct ServerSendStats* stats) {
+	*stats = net_sendStats;
+	stats->queued = net_sendCount;
+}
+
+static void MPConnection_Tick(struct ScheduledTask* task) {
+	if (Server.Disconnected) return;
+	if (net_connecting) { MPConnection_TickConnect(task); return; }
+
+	MPConnection_Receive();
+	if (Server.Disconnected) return;
 
-		data += wrote; len -= wrote;
+	if (net_writeFailure) {
+		Platform_Log1("Error from send: %e", &net_writeFailure);
+		MPConnection_Disconnect(); return;
+	}
+
+	/* Network is ticked 60 times a second. We only send position updates 20 times a second */
+	if ((ticks++ % 3) == 0) {
+		TexturePack_CheckPending();
+		Protocol_Tick();
 	}
+	MPConnection_FlushSend();
 }
 
 static void MPConnection_Init(void) {
@@ -487,6 +821,527 @@ static void MPConnection_Init(void) {
 }
 #else
 static void MPConnection_Init(void) { SPConnection_Init(); }
+static void MPConnection_StopReceiving(void) { }
+static void MPConnection_StopSending(void)   { }
+static void NetCapture_End(void) { }
+
+void Server_GetSendStats(struct ServerSendStats* stats) {
+	Mem_Set(stats, 0, sizeof(*stats));
+}
+#endif
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------Stand-in server-----------------------------------------------------*
+*#########################################################################################################################*/
+#ifdef CC_BUILD_NETWORKING
+/* Data of the capture being replayed */
+static cc_uint8* replay_data;
+static cc_uint32 replay_size;
+
+/* The stand-in server produces a capture of a session with it, where it sends a generated map */
+/*  and then scripted block changes and entity movement (at 20 ticks a second) for a while */
+#define STANDIN_WIDTH  256
+#define STANDIN_HEIGHT 64
+#define STANDIN_LENGTH 256
+#define STANDIN_BOTS   32
+#define STANDIN_TICKS  600
+#define STANDIN_SET_BLOCKS 16
+/* Milliseconds after connecting that the scripted block changes and entity movement begin */
+#define STANDIN_SCRIPT_BEG 1000
+
+struct StandInBuffer { cc_uint8* data; cc_uint32 size, capacity; };
+static struct StandInBuffer standin_session, standin_map;
+static cc_uint32 standin_record;
+static cc_result standin_result;
+
+static void StandIn_Append(struct StandInBuffer* buf, const void* data, cc_uint32 len) {
+	cc_uint32 capacity;
+	cc_uint8* resized;
+	if (standin_result) return;
+
+	if (buf->size + len > buf->capacity) {
+		capacity = max(buf->capacity * 2, buf->size + len);
+		capacity = max(capacity, 64 * 1024);
+
+		resized = (cc_uint8*)Mem_TryRealloc(buf->data, capacity, 1);
+		if (!resized) { standin_result = ERR_OUT_OF_MEMORY; return; }
+		buf->data     = resized;
+		buf->capacity = capacity;
+	}
+
+	Mem_Copy(buf->data + buf->size, data, len);
+	buf->size += len;
+}
+
+static cc_result StandIn_WriteMap(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	StandIn_Append(&standin_map, data, count);
+	*modified = count;
+	return standin_result;
+}
+
+static void StandIn_Send(const cc_uint8* data, cc_uint32 len) {
+	StandIn_Append(&standin_session, data, len);
+}
+
+static void StandIn_BeginRecord(cc_uint32 time) {
+	cc_uint8 header[NET_RECORD_HEADER_SIZE];
+	Stream_SetU32_BE(header + 0, time);
+	Stream_SetU32_BE(header + 4, 0); /* filled in by StandIn_EndRecord */
+
+	standin_record = standin_session.size;
+	StandIn_Send(header, NET_RECORD_HEADER_SIZE);
+}
+
+static void StandIn_EndRecord(void) {
+	cc_uint32 len = standin_session.size - standin_record - NET_RECORD_HEADER_SIZE;
+	if (standin_result) return;
+	Stream_SetU32_BE(standin_session.data + standin_record + 4, len);
+}
+
+static void StandIn_WriteString(cc_uint8* data, const cc_string* value) {
+	int i;
+	for (i = 0; i < STRING_SIZE; i++) 
+	{
+		data[i] = i < value->length ? value->buffer[i] : ' ';
+	}
+}
+
+static void StandIn_SendExtensions(void) {
+	static const cc_string appName = String_FromConst("Stand-in server");
+	static const char* const names[] = { "FastMap", "BulkBlockUpdate" };
+	cc_uint8 data[69];
+	cc_string name;
+	int i;
+
+	data[0] = OPCODE_EXT_INFO;
+	StandIn_WriteString(data + 1, &appName);
+	Stream_SetU16_BE(data + 65, Array_Elems(names));
+	StandIn_Send(data, 67);
+
+	for (i = 0; i < Array_Elems(names); i++) 
+	{
+		name    = String_FromReadonly(names[i]);
+		data[0] = OPCODE_EXT_ENTRY;
+		StandIn_WriteString(data + 1, &name);
+		Stream_SetU32_BE(data + 65, 1);
+		StandIn_Send(data, 69);
+	}
+}
+
+static void StandIn_SendHandshake(void) {
+	static const cc_string name = String_FromConst("Stand-in server");
+	static const cc_string motd = String_FromConst("Generated map with scripted block changes and movement");
+	cc_uint8 data[131];
+
+	data[0] = OPCODE_HANDSHAKE;
+	data[1] = PROTOCOL_0030;
+	StandIn_WriteString(data + 2,  &name);
+	StandIn_WriteString(data + 66, &motd);
+	data[130] = 0;
+	StandIn_Send(data, 131);
+}
+
+static int StandIn_GetHeight(int x, int z) {
+	return 32 + (int)(6 * Math_SinF(x * 0.05f) + 6 * Math_CosF(z * 0.07f));
+}
+
+static cc_result StandIn_CompressMap(void) {
+	struct DeflateState* state;
+	struct Stream sink, stream;
+	BlockRaw* blocks;
+	int x, y, z, height, volume = STANDIN_WIDTH * STANDIN_HEIGHT * STANDIN_LENGTH;
+	cc_result res;
+
+	blocks = (BlockRaw*)Mem_TryAlloc(volume, 1);
+	if (!blocks) return ERR_OUT_OF_MEMORY;
+	state = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!state) { Mem_Free(blocks); return ERR_OUT_OF_MEMORY; }
+
+	for (z = 0; z < STANDIN_LENGTH; z++)
+		for (x = 0; x < STANDIN_WIDTH; x++)
+	{
+		height = StandIn_GetHeight(x, z);
+
+		for (y = 0; y < STANDIN_HEIGHT; y++) 
+		{
+			BlockRaw block = BLOCK_AIR;
+			if (y < height - 3)    block = BLOCK_STONE;
+			else if (y < height)   block = BLOCK_DIRT;
+			else if (y == height)  block = BLOCK_GRASS;
+			else if (y <= 30)      block = BLOCK_STILL_WATER;
+
+			blocks[(y * STANDIN_LENGTH + z) * STANDIN_WIDTH + x] = block;
+		}
+	}
+
+	Stream_Init(&sink);
+	sink.Write = StandIn_WriteMap;
+	Deflate_MakeStream(&stream, state, &sink);
+
+	res = Stream_Write(&stream, blocks, volume);
+	if (!res) res = stream.Close(&stream);
+
+	Mem_Free(state);
+	Mem_Free(blocks);
+	return res;
+}
+
+/* Sends the map using FastMap (i.e. raw DEFLATE compressed blocks) */
+static void StandIn_SendMap(void) {
+	cc_uint8 data[1028];
+	cc_uint32 offset, len;
+	int i = 0;
+
+	data[0] = OPCODE_LEVEL_BEGIN;
+	Stream_SetU32_BE(data + 1, STANDIN_WIDTH * STANDIN_HEIGHT * STANDIN_LENGTH);
+	StandIn_Send(data, 5);
+	StandIn_EndRecord();
+
+	for (offset = 0; offset < standin_map.size; offset += len, i++) 
+	{
+		len = min(standin_map.size - offset, 1024);
+		data[0] = OPCODE_LEVEL_DATA;
+		Stream_SetU16_BE(data + 1, len);
+		Mem_Copy(data + 3, standin_map.data + offset, len);
+		Mem_Set(data + 3 + len, 0, 1024 - len);
+		data[1027] = (cc_uint8)(offset * 100 / standin_map.size);
+
+		/* Send map data in about the same sized pieces that are read from the socket */
+		if ((i % 16) == 0) { StandIn_EndRecord(); StandIn_BeginRecord(0); }
+		StandIn_Send(data, 1028);
+	}
+
+	data[0] = OPCODE_LEVEL_END;
+	Stream_SetU16_BE(data + 1, STANDIN_WIDTH);
+	Stream_SetU16_BE(data + 3, STANDIN_HEIGHT);
+	Stream_SetU16_BE(data + 5, STANDIN_LENGTH);
+	StandIn_Send(data, 7);
+}
+
+static void StandIn_AddEntity(EntityID id, const cc_string* name, const IVec3* pos) {
+	cc_uint8 data[74];
+	data[0] = OPCODE_ADD_ENTITY;
+	data[1] = id;
+	StandIn_WriteString(data + 2, name);
+
+	Stream_SetU16_BE(data + 66, pos->x);
+	Stream_SetU16_BE(data + 68, pos->y);
+	Stream_SetU16_BE(data + 70, pos->z);
+	data[72] = 0; data[73] = 0;
+	StandIn_Send(data, 74);
+}
+
+/* Calculates where the given bot is at the given tick (in fixed point 1/32 block units) */
+static void StandIn_GetBotPosition(int bot, int tick, IVec3* pos, cc_uint8* yaw) {
+	float angle  = tick * 0.05f + bot * (2 * MATH_PI / STANDIN_BOTS);
+	float radius = 16.0f + bot;
+	float x = STANDIN_WIDTH  / 2 + radius * Math_CosF(angle);
+	float z = STANDIN_LENGTH / 2 + radius * Math_SinF(angle);
+
+	pos->x = (int)(x * 32);
+	pos->z = (int)(z * 32);
+	pos->y = (StandIn_GetHeight((int)x, (int)z) + 1) * 32 + 51;
+	*yaw   = Math_Deg2Packed(angle * MATH_RAD2DEG + 180.0f);
+}
+
+static void StandIn_MoveBots(int tick) {
+	cc_uint8 data[10];
+	IVec3 prev, cur;
+	cc_uint8 yaw;
+	int i;
+
+	for (i = 0; i < STANDIN_BOTS; i++) 
+	{
+		StandIn_GetBotPosition(i, tick,     &prev, &yaw);
+		StandIn_GetBotPosition(i, tick + 1, &cur,  &yaw);
+		data[1] = i;
+
+		/* Half of the bots teleport, while the other half move relatively */
+		if ((i & 1) == 0) {
+			data[0] = OPCODE_ENTITY_TELEPORT;
+			Stream_SetU16_BE(data + 2, cur.x);
+			Stream_SetU16_BE(data + 4, cur.y);
+			Stream_SetU16_BE(data + 6, cur.z);
+			data[8] = yaw; data[9] = 0;
+			StandIn_Send(data, 10);
+		} else {
+			data[0] = OPCODE_RELPOS_AND_ORI_UPDATE;
+			data[2] = (cc_uint8)(cur.x - prev.x);
+			data[3] = (cc_uint8)(cur.y - prev.y);
+			data[4] = (cc_uint8)(cur.z - prev.z);
+			data[5] = yaw; data[6] = 0;
+			StandIn_Send(data, 7);
+		}
+	}
+}
+
+/* Places blocks at random positions on even ticks, then removes them again on odd ticks */
+static void StandIn_ChangeBlocks(RNGState* rnd, int tick) {
+	static const BlockRaw placed[] = { BLOCK_STONE, BLOCK_BRICK, BLOCK_GLASS, BLOCK_WOOD, BLOCK_LEAVES, BLOCK_LAVA };
+	static cc_uint32 indices[256 + STANDIN_SET_BLOCKS];
+	static BlockRaw blocks[256 + STANDIN_SET_BLOCKS];
+	cc_uint8 data[1282];
+	int i, x, y, z;
+
+	for (i = 0; i < Array_Elems(indices); i++) 
+	{
+		if (tick & 1) { blocks[i] = BLOCK_AIR; continue; }
+
+		x = Random_Next(rnd, STANDIN_WIDTH);
+		z = Random_Next(rnd, STANDIN_LENGTH);
+		y = StandIn_GetHeight(x, z) + 1 + Random_Next(rnd, 3);
+
+		indices[i] = (y * STANDIN_LENGTH + z) * STANDIN_WIDTH + x;
+		blocks[i]  = placed[Random_Next(rnd, Array_Elems(placed))];
+	}
+
+	data[0] = OPCODE_BULK_BLOCK_UPDATE;
+	data[1] = 256 - 1;
+	for (i = 0; i < 256; i++) 
+	{
+		Stream_SetU32_BE(data + 2 + i * 4, indices[i]);
+		data[2 + 256 * 4 + i] = blocks[i];
+	}
+	StandIn_Send(data, 1282);
+
+	for (i = 256; i < Array_Elems(indices); i++) 
+	{
+		x = indices[i] % STANDIN_WIDTH;
+		z = (indices[i] / STANDIN_WIDTH) % STANDIN_LENGTH;
+		y = (indices[i] / STANDIN_WIDTH) / STANDIN_LENGTH;
+
+		data[0] = OPCODE_SET_BLOCK;
+		Stream_SetU16_BE(data + 1, x);
+		Stream_SetU16_BE(data + 3, y);
+		Stream_SetU16_BE(data + 5, z);
+		data[7] = blocks[i];
+		StandIn_Send(data, 8);
+	}
+}
+
+static cc_result StandIn_MakeSession(void) {
+	static const cc_string self = String_FromConst("Stand-in");
+	cc_string name; char nameBuffer[STRING_SIZE];
+	RNGState rnd;
+	cc_uint8 yaw;
+	IVec3 pos;
+	int i, tick;
+
+	standin_result = 0;
+	Mem_Set(&standin_session, 0, sizeof(standin_session));
+	Mem_Set(&standin_map,     0, sizeof(standin_map));
+	StandIn_Append(&standin_session, NET_CAPTURE_MAGIC, NET_CAPTURE_MAGIC_SIZE);
+
+	if (!standin_result) standin_result = StandIn_CompressMap();
+	StandIn_BeginRecord(0);
+	{
+		StandIn_SendExtensions();
+		StandIn_SendHandshake();
+		StandIn_SendMap();
+
+		pos.x = STANDIN_WIDTH  / 2 * 32;
+		pos.z = STANDIN_LENGTH / 2 * 32;
+		pos.y = (StandIn_GetHeight(STANDIN_WIDTH / 2, STANDIN_LENGTH / 2) + 1) * 32 + 51;
+		StandIn_AddEntity(ENTITIES_SELF_ID, &self, &pos);
+
+		for (i = 0; i < STANDIN_BOTS; i++) 
+		{
+			String_InitArray(name, nameBuffer);
+			String_Format1(&name, "Bot%i", &i);
+			StandIn_GetBotPosition(i, 0, &pos, &yaw);
+			StandIn_AddEntity(i, &name, &pos);
+		}
+	}
+	StandIn_EndRecord();
+
+	Random_Seed(&rnd, 0x57A9D);
+	for (tick = 0; tick < STANDIN_TICKS; tick++) 
+	{
+		StandIn_BeginRecord(STANDIN_SCRIPT_BEG + tick * 50);
+		StandIn_ChangeBlocks(&rnd, tick);
+		StandIn_MoveBots(tick);
+		StandIn_EndRecord();
+	}
+
+	Mem_Free(standin_map.data);
+	if (standin_result) { Mem_Free(standin_session.data); return standin_result; }
+
+	replay_data = standin_session.data;
+	replay_size = standin_session.size;
+	return 0;
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Replay connection----------------------------------------------------*
+*#########################################################################################################################*/
+/* Replays the data received from a server in a capture through the protocol handlers, */
+/*  without using a socket (data sent to the 'server' is discarded) */
+static cc_uint32 replay_read;
+static cc_uint64 replay_beg;
+static cc_bool replay_realtime;
+
+static cc_result ReplayConnection_ReadCapture(struct Stream* s) {
+	cc_uint8 magic[NET_CAPTURE_MAGIC_SIZE];
+	cc_uint32 length;
+	cc_result res;
+
+	if ((res = s->Length(s, &length)))                  return res;
+	if ((res = Stream_Read(s, magic, sizeof(magic))))   return res;
+	if (!Mem_Equal(magic, NET_CAPTURE_MAGIC, sizeof(magic))) return NET_ERR_CAPTURE_SIG;
+
+	/* Keep the magic, so that data is laid out the same as for captures from the stand-in server */
+	replay_size = length;
+	replay_data = (cc_uint8*)Mem_TryAlloc(length, 1);
+	if (!replay_data) return ERR_OUT_OF_MEMORY;
+
+	Mem_Copy(replay_data, magic, sizeof(magic));
+	return Stream_Read(s, replay_data + sizeof(magic), length - sizeof(magic));
+}
+
+static cc_result ReplayConnection_Load(const cc_string* path) {
+	struct Stream stream;
+	cc_result res;
+
+	res = Stream_OpenFile(&stream, path);
+	if (res) return res;
+
+	res = ReplayConnection_ReadCapture(&stream);
+	stream.Close(&stream);
+	return res;
+}
+
+static void ReplayConnection_Free(void) {
+	Mem_Free(replay_data);
+	replay_data      = NULL;
+	net_timeHandlers = false;
+}
+
+static void ReplayConnection_BeginConnect(void) {
+	static const cc_string standIn = String_FromConst("standin");
+	static const cc_string title   = String_FromConst("Failed to replay");
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_string msg;  char msgBuffer[STRING_SIZE];
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	String_InitArray(msg,  msgBuffer);
+	Options_Get(OPT_NET_REPLAY, &path, "");
+	Server.Disconnected = false;
+
+	if (String_CaselessEquals(&path, &standIn)) {
+		res = StandIn_MakeSession();
+	} else {
+		res = ReplayConnection_Load(&path);
+	}
+
+	if (res) {
+		ReplayConnection_Free();
+		Logger_SysWarn2(res, "replaying", &path);
+		String_Format1(&msg, "Couldn't read capture %s", &path);
+		Game_Disconnect(&title, &msg);
+		OnClose(); return;
+	}
+
+	replay_read     = NET_CAPTURE_MAGIC_SIZE;
+	replay_realtime = Options_GetBool(OPT_NET_REPLAY_REALTIME, false);
+	net_readCurrent = net_readBuffer;
+	lastOpcode      = 0;
+
+	net_timeHandlers = true;
+	Mem_Set(net_handledCounts, 0, sizeof(net_handledCounts));
+	Mem_Set(net_handledTimes,  0, sizeof(net_handledTimes));
+
+	String_Format1(&msg, "Replaying %s..", &path);
+	LoadingScreen_Show(&msg, &String_Empty);
+	Event_RaiseVoid(&NetEvents.Connected);
+	Event_RaiseFloat(&WorldEvents.Loading, 0.0f);
+
+	Classic_SendLogin();
+	replay_beg = Stopwatch_Measure();
+}
+
+/* Handles all of the packets in the given data, as if it had just been read from a socket */
+static cc_bool ReplayConnection_Handle(const cc_uint8* data, cc_uint32 len) {
+	cc_uint8* readCur;
+	cc_uint8* readEnd;
+	cc_uint32 count, remaining;
+
+	while (len) {
+		count = min(len, 4096 * 4);
+		Mem_Copy(net_readCurrent, data, count);
+		data += count; len -= count;
+
+		readEnd = net_readCurrent + count;
+		readCur = MPConnection_HandlePackets(net_readBuffer, readEnd, 0, 0);
+		if (!readCur) return false;
+
+		remaining = (cc_uint32)(readEnd - readCur);
+		Mem_Move(net_readBuffer, readCur, remaining);
+		net_readCurrent = net_readBuffer + remaining;
+	}
+	return true;
+}
+
+static void ReplayConnection_Finish(void) {
+	cc_uint64 handledTime = 0;
+	int i, count, elapsedMS, handledMS, packets = 0, micros;
+
+	for (i = 0; i < 256; i++) 
+	{
+		packets     += net_handledCounts[i];
+		handledTime += net_handledTimes[i];
+	}
+	elapsedMS = Stopwatch_ElapsedMS(replay_beg, Stopwatch_Measure());
+	handledMS = (int)(Stopwatch_ElapsedMicroseconds(0, handledTime) / 1000);
+
+	Chat_Add3("&eReplay finished: %i packets in %i ms (%i ms handling them)", &packets, &elapsedMS, &handledMS);
+	Platform_Log3("Replay finished: %i packets in %i ms (%i ms handling them)", &packets, &elapsedMS, &handledMS);
+
+	for (i = 0; i < 256; i++) 
+	{
+		count = net_handledCounts[i];
+		if (!count) continue;
+
+		micros = (int)Stopwatch_ElapsedMicroseconds(0, net_handledTimes[i]);
+		Platform_Log3("  opcode %i: %i packets in %i us", &i, &count, &micros);
+	}
+	ReplayConnection_Free();
+}
+
+static void ReplayConnection_Tick(struct ScheduledTask* task) {
+	cc_uint32 now, time, len, left;
+	if (Server.Disconnected || !replay_data) return;
+	now = Stopwatch_ElapsedMS(replay_beg, Stopwatch_Measure());
+
+	while ((left = replay_size - replay_read) >= NET_RECORD_HEADER_SIZE) {
+		time = Stream_GetU32_BE(replay_data + replay_read + 0);
+		len  = Stream_GetU32_BE(replay_data + replay_read + 4);
+		if (replay_realtime && time > now) break;
+
+		/* Capture was cut off partway through a record */
+		if (len > left - NET_RECORD_HEADER_SIZE) { replay_read = replay_size; break; }
+		replay_read += NET_RECORD_HEADER_SIZE + len;
+
+		if (!ReplayConnection_Handle(replay_data + replay_read - len, len)) return;
+	}
+
+	if ((ticks++ % 3) == 0) Protocol_Tick();
+	if (replay_size - replay_read < NET_RECORD_HEADER_SIZE) ReplayConnection_Finish();
+}
+
+static void ReplayConnection_SendData(const cc_uint8* data, cc_uint32 len) { }
+
+static void ReplayConnection_Init(void) {
+	MPConnection_Init();
+	Server.BeginConnect = ReplayConnection_BeginConnect;
+	Server.Tick         = ReplayConnection_Tick;
+	Server.SendData     = ReplayConnection_SendData;
+}
+#else
+static void ReplayConnection_Init(void) { SPConnection_Init(); }
+static void ReplayConnection_Free(void) { }
 #endif
 
 
@@ -505,12 +1360,15 @@ static void OnNewMap(void) {
 }
 
 static void OnInit(void) {
+	cc_string replay;
 	String_InitArray(Server.Name,    nameBuffer);
 	String_InitArray(Server.MOTD,    motdBuffer);
 	String_InitArray(Server.AppName, appBuffer);
 
 	if (!Server.Address.length) {
 		SPConnection_Init();
+	} else if (Options_UNSAFE_Get(OPT_NET_REPLAY, &replay)) {
+		ReplayConnection_Init();
 	} else {
 		MPConnection_Init();
 	}
@@ -544,6 +1402,10 @@ static void OnClose(void) {
 		Ping_Reset();
 		if (Server.Disconnected) return;
 
+		MPConnection_StopReceiving();
+		MPConnection_StopSending();
+		NetCapture_End();
+		ReplayConnection_Free();
 		Socket_Close(net_socket);
 		Server.Disconnected = true;
 	}
@@ -19,6 +19,16 @@ void Ping_Update(int id);
 /* Calculates average ping time based on most recent ping entries */
 int Ping_AveragePingMS(void);
 
+struct ServerSendStats {
+	int queued;     /* Bytes currently waiting to be sent */
+	int peakQueued; /* Most bytes that have been waiting to be sent at once */
+	int stalls;     /* Number of times the socket couldn't accept all of the waiting data */
+	int writes;     /* Number of writes to the socket */
+	cc_uint64 bytesSent;
+};
+/* Retrieves statistics about data sent to the multiplayer server since connecting */
+void Server_GetSendStats(struct ServerSendStats* stats);
+
 /* Data for currently active connection to a server */
 CC_VAR extern struct _ServerConnectionData {
 	/* Begins connecting to the server */
@@ -5,6 +5,27 @@
 #include "Stream.h"
 #include "Errors.h"
 #include "Logger.h"
+/* CPU specific headers for the faster CRC32 implementations */
+/*  (must be included before Funcs.h, as C++ standard headers #undef min/max) */
+#if (defined __i386__ || defined __x86_64__) && (__GNUC__ >= 5 || defined __clang__)
+	#define CRC32_PCLMUL
+	#define CRC32_PCLMUL_FUNC __attribute__((target("sse4.1,pclmul")))
+	#include <cpuid.h>
+#elif (defined _M_IX86 || defined _M_X64) && defined _MSC_VER && _MSC_VER >= 1600
+	#define CRC32_PCLMUL
+	#define CRC32_PCLMUL_FUNC
+	#include <intrin.h>
+#endif
+#ifdef CRC32_PCLMUL
+	#include <smmintrin.h>
+	#include <wmmintrin.h>
+#endif
+
+#if defined __ARM_FEATURE_CRC32 && defined __GNUC__
+	#define CRC32_ARMV8
+	#include <arm_acle.h>
+#endif
+#include "Funcs.h"
 
 
 /*########################################################################################################################*
@@ -101,13 +122,7 @@ cc_uint8 Utils_CalcSkinType(const struct Bitmap* bmp) {
 }
 
 cc_uint32 Utils_CRC32(const cc_uint8* data, cc_uint32 length) {
-	cc_uint32 crc = 0xffffffffUL;
-	int i;
-
-	for (i = 0; i < length; i++) {
-		crc = Utils_Crc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
-	}
-	return crc ^ 0xffffffffUL;
+	return Utils_UpdateCRC32(0xffffffffUL, data, length) ^ 0xffffffffUL;
 }
 
 const cc_uint32 Utils_Crc32Table[256] = {
@@ -129,6 +144,7 @@ const cc_uint32 Utils_Crc32Table[256] = {
 	0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D,
 };
 
+
 void Utils_Resize(void** buffer, int* capacity, cc_uint32 elemSize, int defCapacity, int expandElems) {
 	/* We use a statically allocated buffer initially, so can't realloc first time */
 	int curCapacity = *capacity, newCapacity = curCapacity + expandElems;
@@ -228,6 +244,372 @@ int Convert_FromBase64(const char* src, int len, cc_uint8* dst) {
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------------Checksums--------------------------------------------------------*
+*#########################################################################################################################*/
+typedef cc_uint32 (*ChecksumFunc)(cc_uint32 value, const cc_uint8* data, cc_uint32 length);
+
+static cc_uint32 Crc32_Bytewise(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	for (; length; length--, data++) 
+	{
+		crc = Utils_Crc32Table[(crc ^ *data) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+/* Slicing by 8 needs 8 KB of lookup tables, which is too much for some consoles */
+#ifndef CC_BUILD_LOWMEM
+#define CRC32_SLICING
+/* crc32_slices[n][i] is the CRC32 of byte i followed by n zero bytes */
+static cc_uint32 crc32_slices[8][256];
+
+static void Crc32_InitSlices(void) {
+	cc_uint32 crc;
+	int i, n;
+
+	for (i = 0; i < 256; i++) 
+	{
+		crc = Utils_Crc32Table[i];
+		crc32_slices[0][i] = crc;
+
+		for (n = 1; n < 8; n++) 
+		{
+			crc = Utils_Crc32Table[crc & 0xFF] ^ (crc >> 8);
+			crc32_slices[n][i] = crc;
+		}
+	}
+}
+
+static cc_uint32 Crc32_Slicing8(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	cc_uint32 lo, hi;
+
+	/* Words are assembled from bytes, so this works the same on big endian CPUs */
+	for (; length >= 8; length -= 8, data += 8) 
+	{
+		lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((cc_uint32)data[3] << 24));
+		hi =        data[4] | (data[5] << 8) | (data[6] << 16) | ((cc_uint32)data[7] << 24);
+
+		crc = crc32_slices[7][lo & 0xFF] ^ crc32_slices[6][(lo >> 8) & 0xFF] 
+			^ crc32_slices[5][(lo >> 16) & 0xFF] ^ crc32_slices[4][lo >> 24]
+			^ crc32_slices[3][hi & 0xFF] ^ crc32_slices[2][(hi >> 8) & 0xFF] 
+			^ crc32_slices[1][(hi >> 16) & 0xFF] ^ crc32_slices[0][hi >> 24];
+	}
+	return Crc32_Bytewise(crc, data, length);
+}
+#endif
+
+/* NOTE: The SSE4.2 crc32 instruction calculates CRC32-C, which uses a different polynomial */
+/*  to the CRC32 used by PNG/ZIP/GZIP. So instead the CRC32 is calculated by folding 16 bytes */
+/*  at a time using carry-less multiplication, then reducing the result down to 32 bits */
+/*  (see Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction") */
+#ifdef CRC32_PCLMUL
+#define CRC32_PCLMUL_MIN_LENGTH 64
+
+static cc_bool Crc32_HasPclmul(void) {
+	unsigned int ecx;
+#ifdef _MSC_VER
+	int regs[4];
+	__cpuid(regs, 1);
+	ecx = (unsigned int)regs[2];
+#else
+	unsigned int eax, ebx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+	/* bit 1 = PCLMULQDQ, bit 19 = SSE4.1 */
+	return (ecx & (1u << 1)) && (ecx & (1u << 19));
+}
+
+/* Only handles multiples of 16 bytes, and at least 64 bytes */
+static CRC32_PCLMUL_FUNC cc_uint32 Crc32_PclmulBlocks(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	__m128i x1, x2, x3, x4, x5, x6, x7, x8;
+	const __m128i k1k2 = _mm_set_epi32(0x00000001, (int)0xC6E41596, 0x00000001, 0x54442BD4);
+	const __m128i k3k4 = _mm_set_epi32(0x00000000, (int)0xCCAA009E, 0x00000001, 0x751997D0);
+	const __m128i k5k0 = _mm_set_epi32(0x00000000, 0x00000000,      0x00000001, 0x63CD6124);
+	const __m128i poly = _mm_set_epi32(0x00000001, (int)0xF7011641, 0x00000001, (int)0xDB710641);
+	const __m128i mask = _mm_set_epi32(0, ~0, 0, ~0);
+
+	x1 = _mm_loadu_si128((const __m128i*)(data +  0));
+	x2 = _mm_loadu_si128((const __m128i*)(data + 16));
+	x3 = _mm_loadu_si128((const __m128i*)(data + 32));
+	x4 = _mm_loadu_si128((const __m128i*)(data + 48));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+	data += 64; length -= 64;
+
+	/* Fold 64 bytes at a time */
+	for (; length >= 64; length -= 64, data += 64) 
+	{
+		x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data +  0)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 16)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 32)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 48)));
+	}
+
+	/* Fold the 4 accumulators down into 1 */
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	/* Fold 16 bytes at a time */
+	for (; length >= 16; length -= 16, data += 16) 
+	{
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)data)), x5);
+	}
+
+	/* Fold 128 bits down to 64 bits */
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask);
+	x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	/* Barrett reduce 64 bits down to 32 bits */
+	x2 = _mm_and_si128(x1, mask);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return (cc_uint32)_mm_extract_epi32(x1, 1);
+}
+
+static cc_uint32 Crc32_Pclmul(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	cc_uint32 blocks;
+	if (length >= CRC32_PCLMUL_MIN_LENGTH) {
+		blocks = length & ~15u;
+		crc    = Crc32_PclmulBlocks(crc, data, blocks);
+		data += blocks; length -= blocks;
+	}
+
+#ifdef CRC32_SLICING
+	return Crc32_Slicing8(crc, data, length);
+#else
+	return Crc32_Bytewise(crc, data, length);
+#endif
+}
+#endif
+
+/* ARMv8 CPUs have instructions for the same CRC32 polynomial used by PNG/ZIP/GZIP */
+/* NOTE: Only used when the compiler targets CPUs which always have the CRC32 extension */
+#ifdef CRC32_ARMV8
+
+static cc_uint32 Crc32_Armv8(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	cc_uint64 word;
+
+	/* Words are assembled from bytes, so this works the same on big endian CPUs */
+	for (; length >= 8; length -= 8, data += 8) 
+	{
+		word = (cc_uint64)(data[0] | (data[1] << 8) | (data[2] << 16) | ((cc_uint32)data[3] << 24))
+			| ((cc_uint64)(data[4] | (data[5] << 8) | (data[6] << 16) | ((cc_uint32)data[7] << 24)) << 32);
+		crc  = __crc32d(crc, word);
+	}
+
+	for (; length; length--, data++) 
+	{
+		crc = __crc32b(crc, *data);
+	}
+	return crc;
+}
+#endif
+
+/* NOTE: Defaults to bytewise so CRC32 still works if called before Utils_Init */
+static ChecksumFunc crc32_update = Crc32_Bytewise;
+static void Crc32_Init(void) {
+	ChecksumFunc func = Crc32_Bytewise;
+#ifdef CRC32_SLICING
+	Crc32_InitSlices();
+	func = Crc32_Slicing8;
+#endif
+#ifdef CRC32_PCLMUL
+	if (Crc32_HasPclmul()) func = Crc32_Pclmul;
+#endif
+#ifdef CRC32_ARMV8
+	func = Crc32_Armv8;
+#endif
+	crc32_update = func;
+}
+
+void Utils_Init(void) {
+	/* Done once at startup, as the tables must be fully initialised before any threads use them */
+	Crc32_Init();
+}
+
+cc_uint32 Utils_UpdateCRC32(cc_uint32 crc, const cc_uint8* data, cc_uint32 length) {
+	return crc32_update(crc, data, length);
+}
+
+
+#define ADLER32_BASE 65521
+/* Largest n such that 255 * n * (n + 1) / 2 + (n + 1) * (ADLER32_BASE - 1) fits in 32 bits, */
+/*  i.e. how many bytes can be summed before the sums must be reduced modulo ADLER32_BASE */
+#define ADLER32_NMAX 5552
+
+static cc_uint32 Adler32_Bytewise(cc_uint32 adler, const cc_uint8* data, cc_uint32 length) {
+	cc_uint32 s1 = adler & 0xFFFF, s2 = (adler >> 16) & 0xFFFF;
+
+	for (; length; length--, data++) 
+	{
+		s1 = (s1 + *data) % ADLER32_BASE;
+		s2 = (s2 + s1)    % ADLER32_BASE;
+	}
+	return (s2 << 16) | s1;
+}
+
+#define ADLER32_STEP(i) s1 += data[i]; s2 += s1;
+cc_uint32 Utils_UpdateAdler32(cc_uint32 adler, const cc_uint8* data, cc_uint32 length) {
+	cc_uint32 s1 = adler & 0xFFFF, s2 = (adler >> 16) & 0xFFFF;
+	cc_uint32 n;
+
+	while (length) 
+	{
+		n = min(length, ADLER32_NMAX);
+		length -= n;
+
+		/* Sums can't overflow within a block, so only need to reduce them at the end */
+		for (; n >= 16; n -= 16, data += 16) 
+		{
+			ADLER32_STEP(0);  ADLER32_STEP(1);  ADLER32_STEP(2);  ADLER32_STEP(3);
+			ADLER32_STEP(4);  ADLER32_STEP(5);  ADLER32_STEP(6);  ADLER32_STEP(7);
+			ADLER32_STEP(8);  ADLER32_STEP(9);  ADLER32_STEP(10); ADLER32_STEP(11);
+			ADLER32_STEP(12); ADLER32_STEP(13); ADLER32_STEP(14); ADLER32_STEP(15);
+		}
+
+		for (; n; n--, data++) 
+		{
+			ADLER32_STEP(0);
+		}
+		s1 %= ADLER32_BASE;
+		s2 %= ADLER32_BASE;
+	}
+	return (s2 << 16) | s1;
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Checksum benchmarking-------------------------------------------------*
+*#########################################################################################################################*/
+/* check is the running checksum after calculating the checksum of "123456789" */
+struct ChecksumImpl { const char* name; ChecksumFunc func, reference; cc_uint32 initial, check; };
+#define CRC32_IMPL(name, func)   { name, func, Crc32_Bytewise,   0xFFFFFFFFUL, 0xCBF43926UL ^ 0xFFFFFFFFUL }
+#define ADLER32_IMPL(name, func) { name, func, Adler32_Bytewise, 1,            0x091E01DEUL }
+
+static const struct ChecksumImpl checksum_impls[] = {
+	CRC32_IMPL("CRC32 (byte at a time)", Crc32_Bytewise),
+#ifdef CRC32_SLICING
+	CRC32_IMPL("CRC32 (slicing by 8)",   Crc32_Slicing8),
+#endif
+#ifdef CRC32_PCLMUL
+	CRC32_IMPL("CRC32 (PCLMUL)",         Crc32_Pclmul),
+#endif
+#ifdef CRC32_ARMV8
+	CRC32_IMPL("CRC32 (ARMv8)",          Crc32_Armv8),
+#endif
+	ADLER32_IMPL("Adler32 (byte at a time)", Adler32_Bytewise),
+	ADLER32_IMPL("Adler32 (unrolled)",       Utils_UpdateAdler32)
+};
+
+/* Largest length that is checked at every alignment */
+#define CHECKSUM_MAX_SHORT 300
+#define CHECKSUM_MAX_ALIGN 16
+
+static cc_bool Checksum_Verify(const struct ChecksumImpl* impl, const cc_uint8* data, cc_uint32 size, 
+								const cc_uint8* ones, cc_uint32 onesSize) {
+	static const cc_uint8 checkData[9] = { '1','2','3','4','5','6','7','8','9' };
+	cc_uint32 value, i, len, offset;
+	int piece;
+
+	if (impl->func(impl->initial, checkData, 9) != impl->check) return false;
+
+	/* All 0xFF bytes is the worst case for Adler32 sums overflowing */
+	value = impl->reference(impl->initial, ones, onesSize);
+	if (impl->func(impl->initial, ones, onesSize) != value) return false;
+
+	/* Short data at different alignments */
+	for (offset = 0; offset < CHECKSUM_MAX_ALIGN; offset++) 
+	{
+		for (len = 0; len <= CHECKSUM_MAX_SHORT && offset + len <= size; len++) 
+		{
+			value = impl->reference(impl->initial, data + offset, len);
+			if (impl->func(impl->initial, data + offset, len) != value) return false;
+		}
+	}
+
+	/* All of the data at once, then again in pieces of varying sizes */
+	value = impl->reference(impl->initial, data, size);
+	if (impl->func(impl->initial, data, size) != value) return false;
+
+	value = impl->initial;
+	for (i = 0, piece = 0; i < size; i += len, piece++) 
+	{
+		len   = 1 + (piece * 977) % 8192;
+		len   = min(len, size - i);
+		value = impl->func(value, data + i, len);
+	}
+	return value == impl->reference(impl->initial, data, size);
+}
+
+int Utils_BenchmarkChecksums(const cc_uint8* data, cc_uint32 size, struct ChecksumBenchmark* results) {
+	cc_uint32 onesSize = ADLER32_NMAX * 3 + 100;
+	const struct ChecksumImpl* impl;
+	struct ChecksumBenchmark* r;
+	cc_uint32 expected, value;
+	cc_uint64 beg, elapsed;
+	cc_uint8* ones;
+	int i, run, count = 0;
+
+	ones = (cc_uint8*)Mem_TryAlloc(onesSize, 1);
+	if (!ones) return 0;
+	Mem_Set(ones, 0xFF, onesSize);
+
+	for (i = 0; i < Array_Elems(checksum_impls); i++) 
+	{
+		impl = &checksum_impls[i];
+#ifdef CRC32_PCLMUL
+		if (impl->func == Crc32_Pclmul && !Crc32_HasPclmul()) continue;
+#endif
+		r = &results[count++];
+		r->name     = impl->name;
+		r->verified = Checksum_Verify(impl, data, size, ones, onesSize);
+		r->time     = 0;
+		expected    = impl->reference(impl->initial, data, size);
+
+		/* Use the fastest of several runs, to reduce the effect of other processes */
+		for (run = 0; run < 3; run++) 
+		{
+			beg = Stopwatch_Measure();
+			value   = impl->func(impl->initial, data, size);
+			elapsed = Stopwatch_ElapsedMicroseconds(beg, Stopwatch_Measure());
+
+			if (!run || elapsed < r->time) r->time = elapsed;
+			if (value != expected) r->verified = false;
+		}
+	}
+
+	Mem_Free(ones);
+	return count;
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------------EntryList--------------------------------------------------------*
 *#########################################################################################################################*/
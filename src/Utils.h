@@ -42,10 +42,31 @@ int Utils_AccumulateWheelDelta(float* accumulator, float delta);
 #define Utils_AdjViewDist(value) ((int)(1.4142135f * (value)))
 
 cc_uint8 Utils_CalcSkinType(const struct Bitmap* bmp);
+/* Chooses the fastest checksum implementations supported by the CPU */
+/* NOTE: Must be called at startup, before any other threads are started */
+void Utils_Init(void);
 cc_uint32 Utils_CRC32(const cc_uint8* data, cc_uint32 length);
+/* Updates a running CRC32 with the given data, using the fastest method supported by the CPU. */
+/* NOTE: Running CRC32 must start as 0xFFFFFFFFUL, and be xor-ed with 0xFFFFFFFFUL at the end */
+cc_uint32 Utils_UpdateCRC32(cc_uint32 crc, const cc_uint8* data, cc_uint32 length);
+/* Updates a running Adler32 with the given data. (Running Adler32 must start as 1) */
+cc_uint32 Utils_UpdateAdler32(cc_uint32 adler, const cc_uint8* data, cc_uint32 length);
 /* CRC32 lookup table, for faster CRC32 calculations. */
-/* NOTE: This cannot be just indexed by byte value - see Utils_CRC32 implementation. */
+/* NOTE: This cannot be just indexed by byte value - see Crc32_Bytewise and Crc32_InitSlices. */
 extern const cc_uint32 Utils_Crc32Table[256];
+
+#define CHECKSUM_MAX_IMPLEMENTATIONS 6
+/* Time taken by a CRC32 or Adler32 implementation to calculate the checksum of some data */
+struct ChecksumBenchmark {
+	const char* name; /* Name of the implementation */
+	cc_uint64 time;   /* Time taken (in microseconds) to calculate the checksum of the data */
+	cc_bool verified; /* Whether it always calculated the same checksum as the reference implementation */
+};
+/* Calculates the checksum of the given data with every CRC32 and Adler32 implementation the CPU */
+/*  supports, and checks that each gives the same results as the simple byte at a time reference */
+/*  implementations (also for many short lengths and alignments, and when updated in pieces) */
+/* Returns number of implementations benchmarked, or 0 when not enough memory to benchmark */
+int Utils_BenchmarkChecksums(const cc_uint8* data, cc_uint32 size, struct ChecksumBenchmark* results);
 CC_NOINLINE void Utils_Resize(void** buffer, int* capacity, cc_uint32 elemSize, int defCapacity, int expandElems);
 void Utils_SwapEndian16(cc_int16* values, int numValues);
 
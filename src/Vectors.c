@@ -212,6 +212,34 @@ cc_bool FrustumCulling_SphereInFrustum(float x, float y, float z, float radius)
 	return true;
 }
 
+/* Returns -1 if box is fully behind the plane, 1 if fully in front of it, 0 if it straddles the plane */
+static int FrustumCulling_ClassifyBox(const struct Plane* p, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+	/* Corners of the box furthest along and furthest against the plane's normal */
+	float posX = p->a >= 0 ? maxX : minX, negX = p->a >= 0 ? minX : maxX;
+	float posY = p->b >= 0 ? maxY : minY, negY = p->b >= 0 ? minY : maxY;
+	float posZ = p->c >= 0 ? maxZ : minZ, negZ = p->c >= 0 ? minZ : maxZ;
+
+	if (p->a * posX + p->b * posY + p->c * posZ + p->d <= 0) return -1;
+	if (p->a * negX + p->b * negY + p->c * negZ + p->d <  0) return  0;
+	return 1;
+}
+
+int FrustumCulling_BoxInFrustum(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+	const struct Plane* planes[5];
+	int i, res, inside = true;
+	planes[0] = &frustumR; planes[1] = &frustumL; planes[2] = &frustumB;
+	planes[3] = &frustumT; planes[4] = &frustumF;
+	/* Don't test NEAR plane, it's pointless */
+
+	for (i = 0; i < 5; i++) 
+	{
+		res = FrustumCulling_ClassifyBox(planes[i], minX, minY, minZ, maxX, maxY, maxZ);
+		if (res < 0) return FRUSTUM_BOX_OUTSIDE;
+		if (res == 0) inside = false;
+	}
+	return inside ? FRUSTUM_BOX_INSIDE : FRUSTUM_BOX_INTERSECTS;
+}
+
 void FrustumCulling_CalcFrustumEquations(struct Matrix* clip) {
 	/* Extract the RIGHT plane */
 	frustumR.a = clip->row1.w - clip->row1.x;
@@ -135,6 +135,9 @@ CC_API void Matrix_Mul(struct Matrix* result, const struct Matrix* left, const s
 void Matrix_LookRot(struct Matrix* result, Vec3 pos, Vec2 rot);
 
 cc_bool FrustumCulling_SphereInFrustum(float x, float y, float z, float radius);
+enum FrustumBoxResult { FRUSTUM_BOX_OUTSIDE, FRUSTUM_BOX_INTERSECTS, FRUSTUM_BOX_INSIDE };
+/* Returns whether the given axis aligned box is fully outside, partially inside, or fully inside the frustum */
+int FrustumCulling_BoxInFrustum(float minX, float minY, float minZ, float maxX, float maxY, float maxZ);
 /* Calculates the clipping planes from the combined modelview and projection matrices */
 /* Matrix_Mul(&clip, modelView, projection); */
 void FrustumCulling_CalcFrustumEquations(struct Matrix* clip);
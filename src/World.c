@@ -10,6 +10,8 @@
 #include "Game.h"
 #include "TexturePack.h"
 #include "Window.h"
+#include "BlockPhysics.h"
+#include "Funcs.h"
 
 struct _WorldData World;
 static char nameBuffer[STRING_SIZE];
@@ -37,7 +39,11 @@ static void GenerateNewUuid(void) {
 	World.Uuid[8] |= 0x80; /* variant 2*/
 }
 
+static void FreeChunkCounts(void);
+static void InitChunkCounts(void);
+
 void World_Reset(void) {
+	FreeChunkCounts();
 #ifdef EXTENDED_BLOCKS
 	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
 	World.Blocks2 = NULL;
@@ -80,6 +86,7 @@ void World_SetNewMap(BlockRaw* blocks, int width, int height, int length) {
 	if (Env.CloudsHeight == -1) { Env.CloudsHeight = height + 2; }
 
 	GenerateNewUuid();
+	InitChunkCounts();
 	World.Loaded = true;
 	Event_RaiseVoid(&WorldEvents.MapLoaded);
 }
@@ -122,8 +129,11 @@ static CC_NOINLINE void LazyInitUpper(int i, BlockID block) {
 	World.Blocks2[i] = (BlockRaw)(block >> 8);
 }
 
+static void UpdateChunkCounts(int x, int y, int z, BlockID old, BlockID now);
+
 void World_SetBlock(int x, int y, int z, BlockID block) {
 	int i = World_Pack(x, y, z);
+	UpdateChunkCounts(x, y, z, World_GetRawBlock(i), block);
 	World.Blocks[i] = (BlockRaw)block;
 
 	/* defer allocation of second map array if possible */
@@ -135,8 +145,12 @@ void World_SetBlock(int x, int y, int z, BlockID block) {
 	World.Blocks2[i] = (BlockRaw)(block >> 8);
 }
 #else
+static void UpdateChunkCounts(int x, int y, int z, BlockID old, BlockID now);
+
 void World_SetBlock(int x, int y, int z, BlockID block) {
-	World.Blocks[World_Pack(x, y, z)] = block; 
+	int i = World_Pack(x, y, z);
+	UpdateChunkCounts(x, y, z, World.Blocks[i], block);
+	World.Blocks[i] = block; 
 }
 #endif
 
@@ -152,6 +166,105 @@ BlockID World_SafeGetBlock(int x, int y, int z) {
 }
 
 
+/*########################################################################################################################*
+*------------------------------------------------------Chunk counts-------------------------------------------------------*
+*#########################################################################################################################*/
+static struct WorldChunkCounts* chunkCounts;
+/* Whether fullOpaque counts are out of date, due to block definitions changing */
+static cc_bool opaqueStale;
+
+#define IsTickable(block) (Physics.OnRandomTick[(BlockRaw)(block)] != NULL)
+
+static void CountAllChunks(cc_bool opaqueOnly) {
+	struct WorldChunkCounts* counts;
+	int x, y, z, i, row;
+	BlockID block;
+
+	for (i = 0; i < World.ChunksCount; i++) 
+	{
+		chunkCounts[i].fullOpaque = 0;
+		if (opaqueOnly) continue;
+
+		chunkCounts[i].nonAir   = 0;
+		chunkCounts[i].tickable = 0;
+	}
+
+	for (y = 0, i = 0; y < World.Height; y++) {
+		for (z = 0; z < World.Length; z++) {
+			row = World_ChunkPack(0, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+
+			for (x = 0; x < World.Width; x++, i++) {
+				block  = World_GetRawBlock(i);
+				counts = &chunkCounts[row + (x >> CHUNK_SHIFT)];
+				counts->fullOpaque += Blocks.FullOpaque[block];
+				if (opaqueOnly) continue;
+
+				counts->nonAir   += block != BLOCK_AIR;
+				counts->tickable += IsTickable(block);
+			}
+		}
+	}
+	opaqueStale = false;
+}
+
+static void InitChunkCounts(void) {
+	if (!World.Blocks) return;
+	chunkCounts = (struct WorldChunkCounts*)Mem_TryAlloc(World.ChunksCount, sizeof(struct WorldChunkCounts));
+	/* Not a fatal error, chunks will just never be skipped */
+	if (!chunkCounts) return;
+
+	CountAllChunks(false);
+}
+
+static void FreeChunkCounts(void) {
+	Mem_Free(chunkCounts);
+	chunkCounts = NULL;
+}
+
+static void UpdateChunkCounts(int x, int y, int z, BlockID old, BlockID now) {
+	struct WorldChunkCounts* counts;
+	if (!chunkCounts) return;
+
+	counts = &chunkCounts[World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT)];
+	counts->nonAir     += (now != BLOCK_AIR)        - (old != BLOCK_AIR);
+	counts->tickable   += IsTickable(now)           - IsTickable(old);
+	counts->fullOpaque += Blocks.FullOpaque[now]    - Blocks.FullOpaque[old];
+}
+
+static void OnBlockDefChanged(void* obj) {
+	/* Recounting is deferred, since many blocks are usually defined at once */
+	opaqueStale = true;
+}
+
+void World_RefreshChunkCounts(void) {
+	if (chunkCounts && opaqueStale) CountAllChunks(true);
+}
+
+struct WorldChunkCounts* World_GetChunkCounts(int cx, int cy, int cz) {
+	if (!chunkCounts) return NULL;
+	World_RefreshChunkCounts();
+
+	return &chunkCounts[World_ChunkPack(cx, cy, cz)];
+}
+
+int World_ChunkVolume(int cx, int cy, int cz) {
+	int x1 = cx << CHUNK_SHIFT, x2 = min(World.Width,  x1 + CHUNK_SIZE);
+	int y1 = cy << CHUNK_SHIFT, y2 = min(World.Height, y1 + CHUNK_SIZE);
+	int z1 = cz << CHUNK_SHIFT, z2 = min(World.Length, z1 + CHUNK_SIZE);
+	return (x2 - x1) * (y2 - y1) * (z2 - z1);
+}
+
+cc_bool World_IsChunkAir(int cx, int cy, int cz) {
+	/* nonAir counts never go stale, so there's no need to recount (which isn't thread safe) */
+	return chunkCounts && chunkCounts[World_ChunkPack(cx, cy, cz)].nonAir == 0;
+}
+
+cc_bool World_IsChunkSolid(int cx, int cy, int cz) {
+	struct WorldChunkCounts* counts = World_GetChunkCounts(cx, cy, cz);
+	return counts && counts->fullOpaque == World_ChunkVolume(cx, cy, cz);
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------Environment-------------------------------------------------------*
 *#########################################################################################################################*/
@@ -320,7 +433,12 @@ Vec3 Respawn_FindSpawnPosition(float x, float z, Vec3 modelSize) {
 	return spawn;
 }
 
+static void OnInit(void) {
+	World_Reset();
+	Event_Register_(&BlockEvents.BlockDefChanged, NULL, OnBlockDefChanged);
+}
+
 struct IGameComponent World_Component = {
-	World_Reset, /* Init  */
-	World_Reset  /* Free  */
+	OnInit,     /* Init  */
+	World_Reset /* Free  */
 };
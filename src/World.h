@@ -103,6 +103,30 @@ void World_SetBlock(int x, int y, int z, BlockID block);
 /* Otherwise returns the block at the given coordinates. */
 BlockID World_SafeGetBlock(int x, int y, int z);
 
+/* Number of blocks of particular kinds in a 16x16x16 chunk of the world */
+/* NOTE: Only kept up to date when blocks are changed through World_SetBlock */
+struct WorldChunkCounts {
+	cc_uint16 nonAir;     /* Number of blocks that are not BLOCK_AIR */
+	cc_uint16 fullOpaque; /* Number of blocks that are fully opaque (see Blocks.FullOpaque) */
+	cc_uint16 tickable;   /* Number of blocks that can be randomly ticked by block physics */
+};
+/* Recounts fullOpaque counts that are out of date due to block definitions changing. */
+/* NOTE: Must only be called from the main thread. */
+void World_RefreshChunkCounts(void);
+/* Returns the block counts for the given chunk, or NULL if counts are unavailable. */
+/* NOTE: Must only be called from the main thread. (as may call World_RefreshChunkCounts) */
+/* NOTE: Does NOT check that the chunk coordinates are inside the map. */
+struct WorldChunkCounts* World_GetChunkCounts(int cx, int cy, int cz);
+/* Returns the number of blocks in the given chunk. */
+/* (chunks on the far edges of the map may be smaller than 16x16x16) */
+int World_ChunkVolume(int cx, int cy, int cz);
+/* Whether every block in the given chunk is known to be BLOCK_AIR. */
+/* NOTE: Only reads the block counts, so can be called from any thread. */
+cc_bool World_IsChunkAir(int cx, int cy, int cz);
+/* Whether every block in the given chunk is known to be fully opaque. */
+/* NOTE: Must only be called from the main thread. */
+cc_bool World_IsChunkSolid(int cx, int cy, int cz);
+
 /* Whether the given coordinates lie inside the map. */
 static CC_INLINE cc_bool World_Contains(int x, int y, int z) {
 	return (unsigned)x < (unsigned)World.Width
@@ -15,7 +15,7 @@ struct _GfxData Gfx;
 static GfxResourceID Gfx_quadVb, Gfx_texVb;
 const cc_string Gfx_LowPerfMessage = String_FromConst("&eRunning in reduced performance mode (game minimised or hidden)");
 
-static const int strideSizes[] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED };
+static const int strideSizes[] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED, SIZEOF_VERTEX_CHUNK };
 /* Whether mipmaps must be created for all dimensions down to 1x1 or not */
 static cc_bool customMipmapsLevels;
 /* Current format and size of vertices */
@@ -492,6 +492,24 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 }
 #endif
 
+#if (CC_GFX_BACKEND == CC_GFX_BACKEND_GL2) || (CC_GFX_BACKEND == CC_GFX_BACKEND_SOFTGPU)
+/* Ranged vertex buffers are implemented in the backends */
+#else
+GfxResourceID Gfx_CreateRangedVb(VertexFormat fmt, int count) { return 0; }
+
+void* Gfx_LockVbRange(GfxResourceID vb, VertexFormat fmt, int offset, int count) { return NULL; }
+
+void  Gfx_UnlockVbRange(GfxResourceID vb) { }
+#endif
+
+#if (CC_GFX_BACKEND == CC_GFX_BACKEND_GL2) || (CC_GFX_BACKEND == CC_GFX_BACKEND_SOFTGPU)
+/* Tile wrapping is implemented in the backends */
+#else
+void Gfx_EnableTileWrap(float tileSize) { }
+
+void Gfx_DisableTileWrap(void) { }
+#endif
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Graphics component---------------------------------------------------*
@@ -115,6 +115,7 @@ static void SetupProgram(int argc, char** argv) {
 	Logger_Hook();
 	Window_PreInit();
 	Platform_Init();
+	Utils_Init();
 	
 	res = Platform_SetDefaultCurrentDirectory(argc, argv);
 	Options_Load();